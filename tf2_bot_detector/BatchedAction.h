@@ -21,6 +21,12 @@ namespace tf2_bot_detector
 		BatchedAction(const TState& state) : m_State(state) {}
 		BatchedAction(TState&& state) : m_State(std::move(state)) {}
 
+		size_t GetQueuedCount() const
+		{
+			std::lock_guard lock(m_Mutex);
+			return m_Queued.size();
+		}
+
 		bool IsQueued(const TItem& item) const
 		{
 			std::lock_guard lock(m_Mutex);
@@ -38,7 +44,15 @@ namespace tf2_bot_detector
 			m_Queued.insert(item);
 		}
 
-		void Update()
+		// Leaves it out of any requests that haven't been sent yet
+		void Dequeue(const TItem& item)
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Queued.erase(item);
+		}
+
+		// now is whatever clock the owner paces its requests by, so replays can drive it too
+		void Update(time_point_t now)
 		{
 			std::invoke([&]
 				{
@@ -48,11 +62,10 @@ namespace tf2_bot_detector
 					if (m_ResponseFuture.valid())
 						return;
 
-					const auto curTime = clock_t::now();
-					if (curTime < (m_LastUpdate + MIN_INTERVAL))
+					if (now < (m_LastUpdate + MIN_INTERVAL))
 						return;
 
-					m_LastUpdate = curTime;
+					m_LastUpdate = now;
 
 					m_ResponseFuture = SendRequest(m_State, m_Queued);
 				});
@@ -89,7 +102,7 @@ namespace tf2_bot_detector
 	private:
 		static constexpr duration_t MIN_INTERVAL = std::chrono::seconds(5);
 		state_type m_State{};
-		std::recursive_mutex m_Mutex;
+		mutable std::recursive_mutex m_Mutex;
 		queue_collection_type m_Queued;
 		response_future_type m_ResponseFuture;
 		time_point_t m_LastUpdate{};
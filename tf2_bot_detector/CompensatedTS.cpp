@@ -6,12 +6,11 @@
 using namespace std::chrono_literals;
 using namespace tf2_bot_detector;
 
-void CompensatedTS::SetRecorded(time_point_t recorded)
+void CompensatedTS::SetRecorded(time_point_t recorded, time_point_t now)
 {
 	assert(recorded.time_since_epoch() > 0s);
 	m_Recorded = recorded;
 
-	const auto now = clock_t::now();
 	if (m_Snapshot && (now - *m_Snapshot) >= 1s)
 		m_Snapshot.reset();
 
@@ -21,9 +20,8 @@ void CompensatedTS::SetRecorded(time_point_t recorded)
 		m_Parsed = recorded;
 }
 
-void CompensatedTS::Snapshot()
+void CompensatedTS::Snapshot(time_point_t now)
 {
-	const auto now = clock_t::now();
 	const auto extra = now - m_Parsed;
 	[[maybe_unused]] const auto extraSeconds = to_seconds(extra);
 	const time_point_t adjustedTS = m_Recorded.value() + extra;
@@ -8,15 +8,16 @@ namespace tf2_bot_detector
 {
 	// A compensated timestamp. Allows time to appear to progress normally
 	// (with all the sub-second precision offered by clock_t) despite the uneven
-	// pacing of the output from the log file.
+	// pacing of the output from the log file. now is the wall clock time, passed in so journal
+	// replays can supply the time things happened live.
 	struct CompensatedTS
 	{
 	public:
 		void InvalidateRecorded() { m_Recorded.reset(); }
 		bool IsRecordedValid() const { return m_Recorded.has_value(); }
-		void SetRecorded(time_point_t recorded);
+		void SetRecorded(time_point_t recorded, time_point_t now);
 
-		void Snapshot();
+		void Snapshot(time_point_t now);
 		bool IsSnapshotValid() const { return m_Snapshot.has_value(); }
 		time_point_t GetSnapshot() const;
 
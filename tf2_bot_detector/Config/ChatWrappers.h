@@ -86,6 +86,8 @@ namespace tf2_bot_detector
 
 		struct WrapperPair
 		{
+			bool operator==(const WrapperPair&) const = default;
+
 			wrapper_t m_Start;
 			wrapper_t m_End;
 		};
@@ -93,6 +95,8 @@ namespace tf2_bot_detector
 
 		struct Type
 		{
+			bool operator==(const Type&) const = default;
+
 			wrapper_pair_t m_Full;
 			wrapper_pair_t m_Name;
 			wrapper_pair_t m_Message;
@@ -101,6 +105,8 @@ namespace tf2_bot_detector
 		};
 
 		std::array<Type, (size_t)ChatCategory::COUNT> m_Types;
+
+		bool operator==(const ChatWrappers&) const = default;
 	};
 
 	void to_json(nlohmann::json& j, const ChatWrappers::WrapperPair& d);
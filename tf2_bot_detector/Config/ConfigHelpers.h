@@ -149,6 +149,9 @@ namespace tf2_bot_detector
 		{
 			using namespace std::string_literals;
 
+			if (m_IsFixed)
+				return;
+
 			const auto paths = GetConfigFilePaths(GetBaseFileName());
 
 			if (!IsOfficial() && !paths.m_User.empty())
@@ -162,8 +165,21 @@ namespace tf2_bot_detector
 			m_ThirdPartyLists = LoadThirdPartyListsAsync(paths);
 		}
 
+		// Uses just this list, as if it were the user list. Nothing in cfg/ is read or written
+		// from then on, including by LoadFiles() and SaveFiles().
+		void SetFixedList(T list)
+		{
+			m_IsFixed = true;
+			m_UserList = std::move(list);
+			m_OfficialList = mh::make_ready_task<T>();
+			m_ThirdPartyLists = mh::make_ready_task<collection_type>();
+		}
+
 		void SaveFiles() const
 		{
+			if (m_IsFixed)
+				return;
+
 			const T* defaultMutableList = GetDefaultMutableList();
 			const T* localList = GetLocalList();
 			if (localList)
@@ -180,7 +196,7 @@ namespace tf2_bot_detector
 			}
 		}
 
-		bool IsOfficial() const { return m_Settings->GetLocalSteamID().IsPazer(); }
+		bool IsOfficial() const { return !m_IsFixed && m_Settings->GetLocalSteamID().IsPazer(); }
 
 		T& GetDefaultMutableList()
 		{
@@ -235,6 +251,8 @@ namespace tf2_bot_detector
 		mh::task<collection_type> m_ThirdPartyLists;
 
 	private:
+		bool m_IsFixed = false;
+
 		mh::task<collection_type> LoadThirdPartyListsAsync(ConfigFilePaths paths)
 		{
 			collection_type collection;
@@ -149,6 +149,15 @@ PlayerListJSON::PlayerListJSON(const Settings& settings) :
 	LoadFiles();
 }
 
+PlayerListJSON::PlayerListJSON(const Settings& settings, const nlohmann::json& fixedList) :
+	m_Settings(&settings),
+	m_CFGGroup(settings)
+{
+	PlayerListFile file;
+	file.Deserialize(fixedList);
+	m_CFGGroup.SetFixedList(std::move(file));
+}
+
 void PlayerListJSON::PlayerListFile::ValidateSchema(const ConfigSchemaInfo& schema) const
 {
 	if (schema.m_Type != "playerlist")
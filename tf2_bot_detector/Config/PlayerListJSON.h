@@ -160,6 +160,9 @@ namespace tf2_bot_detector
 	public:
 		PlayerListJSON(const Settings& settings);
 
+		// Just the players in fixedList (the same format as playerlist.json), without touching cfg/
+		PlayerListJSON(const Settings& settings, const nlohmann::json& fixedList);
+
 		bool LoadFiles();
 		void SaveFiles() const;
 
@@ -12,6 +12,10 @@
 #include <mh/utility.hpp>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
 #include <iomanip>
 #include <regex>
 #include <stdexcept>
@@ -200,12 +204,28 @@ ModerationRules::ModerationRules(const Settings& settings) :
 	LoadFiles();
 }
 
+ModerationRules::ModerationRules(const Settings& settings, const nlohmann::json& fixedRules) :
+	m_CFGGroup(settings)
+{
+	RuleFile file;
+	file.Deserialize(fixedRules);
+	m_CFGGroup.SetFixedList(std::move(file));
+	CompileRules();
+}
+
 bool ModerationRules::LoadFiles()
 {
 	m_CFGGroup.LoadFiles();
+	CompileRules();
 	return true;
 }
 
+void ModerationRules::Update()
+{
+	if (GetCompiledRulesKey() != m_CompiledRulesKey)
+		CompileRules();
+}
+
 bool ModerationRules::SaveFile() const
 {
 	m_CFGGroup.SaveFiles();
@@ -233,6 +253,28 @@ mh::generator<const ModerationRule&> tf2_bot_detector::ModerationRules::GetRules
 	}
 }
 
+auto ModerationRules::GetCompiledRulesKey() const -> CompiledRulesKey
+{
+	CompiledRulesKey key;
+	key.m_OfficialListLoaded = m_CFGGroup.m_OfficialList.is_ready();
+	key.m_ThirdPartyListsLoaded = m_CFGGroup.m_ThirdPartyLists.is_ready();
+	return key;
+}
+
+void ModerationRules::CompileRules()
+{
+	m_CompiledRulesKey = GetCompiledRulesKey();
+
+	std::vector<ModerationRule> rules;
+	rules.reserve(GetRuleCount());
+	for (const ModerationRule& rule : GetRules())
+		rules.push_back(rule);
+
+	// Anyone still matching against the old rules keeps their own reference to them
+	m_CompiledRules = std::make_shared<const CompiledRuleSet>(std::move(rules));
+	DebugLog("Compiled {} rules ({} invalid patterns)", m_CompiledRules->GetRules().size(), m_CompiledRules->GetInvalidPatternCount());
+}
+
 void ModerationRules::RuleFile::ValidateSchema(const ConfigSchemaInfo& schema) const
 {
 	if (schema.m_Type != "rules")
@@ -348,6 +390,37 @@ bool TextMatch::Match(const std::string_view& text) const
 	throw std::runtime_error(mh::format("{}: Unknown value {}", MH_SOURCE_LOCATION_CURRENT(), mh::enum_fmt(m_Mode)));
 }
 
+CompiledTextMatch::CompiledTextMatch(const TextMatch& match, const std::string_view& ruleDescription,
+	size_t& invalidPatternCount)
+{
+	assert(IsSupported(match.m_Mode));
+
+	std::regex_constants::syntax_option_type options = std::regex_constants::optimize;
+	if (!match.m_CaseSensitive)
+		options |= std::regex_constants::icase;
+
+	for (const std::string& pattern : match.m_Patterns)
+	{
+		try
+		{
+			m_Regexes.emplace_back(pattern, options);
+		}
+		catch (const std::regex_error& e)
+		{
+			LogError("Invalid regex {} in rule {}, ignoring it: {}", std::quoted(pattern), std::quoted(ruleDescription), e.what());
+			invalidPatternCount++;
+		}
+	}
+}
+
+bool CompiledTextMatch::Match(const std::string_view& text) const
+{
+	return std::any_of(m_Regexes.begin(), m_Regexes.end(), [&](const std::regex& r)
+		{
+			return std::regex_match(text.begin(), text.end(), r);
+		});
+}
+
 bool ModerationRule::Match(const IPlayer& player) const
 {
 	return Match(player, std::string_view{});
@@ -513,18 +586,22 @@ static constexpr void RunTests()
 	static_assert(!MatchRules(TriggerMatchMode::MatchAny, unset, unset, unset));
 }
 
-bool ModerationRule::Match(const IPlayer& player, const std::string_view& chatMsg) const
+// avatarMatch() is only called if there are avatar triggers, and returns true if one of them matches
+template<typename TTextMatch, typename TAvatarMatchFunc>
+static bool MatchTriggers(const ModerationRule::Triggers& triggers, const TTextMatch* usernameTextMatch,
+	const TTextMatch* chatMsgTextMatch, const TAvatarMatchFunc& avatarMatch, const IPlayer& player,
+	const std::string_view& chatMsg)
 {
 	const auto usernameMatch = [&]()
 	{
-		if (!m_Triggers.m_UsernameTextMatch)
+		if (!usernameTextMatch)
 			return MatchResult::Unset;
 
 		const auto name = player.GetNameUnsafe();
 		if (name.empty())
 			return MatchResult::NoMatch;
 
-		if (!m_Triggers.m_UsernameTextMatch->Match(name))
+		if (!usernameTextMatch->Match(name))
 			return MatchResult::NoMatch;
 
 		return MatchResult::Match;
@@ -532,40 +609,349 @@ bool ModerationRule::Match(const IPlayer& player, const std::string_view& chatMs
 
 	const auto chatMsgMatch = [&]()
 	{
-		if (!m_Triggers.m_ChatMsgTextMatch)
+		if (!chatMsgTextMatch)
 			return MatchResult::Unset;
 
 		if (chatMsg.empty())
 			return MatchResult::NoMatch;
 
-		if (!m_Triggers.m_ChatMsgTextMatch->Match(chatMsg))
+		if (!chatMsgTextMatch->Match(chatMsg))
 			return MatchResult::NoMatch;
 
 		return MatchResult::Match;
 	};
 
-	const auto avatarMatch = [&]()
+	const auto avatarMatchResult = [&]()
 	{
-		if (m_Triggers.m_AvatarMatches.empty())
+		if (triggers.m_AvatarMatches.empty())
 			return MatchResult::Unset;
 
+		return avatarMatch() ? MatchResult::Match : MatchResult::NoMatch;
+	};
+
+	return MatchRules(triggers.m_Mode, usernameMatch, chatMsgMatch, avatarMatchResult);
+}
+
+bool ModerationRule::Match(const IPlayer& player, const std::string_view& chatMsg) const
+{
+	const auto avatarMatch = [&]()
+	{
 		const auto& summary = player.GetPlayerSummary();
 		if (!summary)
-			return MatchResult::NoMatch;
+			return false;
+
+		return std::any_of(m_Triggers.m_AvatarMatches.begin(), m_Triggers.m_AvatarMatches.end(),
+			[&](const AvatarMatch& m) { return m.Match(summary->m_AvatarHash); });
+	};
+
+	return MatchTriggers(m_Triggers,
+		m_Triggers.m_UsernameTextMatch ? &*m_Triggers.m_UsernameTextMatch : nullptr,
+		m_Triggers.m_ChatMsgTextMatch ? &*m_Triggers.m_ChatMsgTextMatch : nullptr,
+		avatarMatch, player, chatMsg);
+}
+
+void CompiledRuleSet::LiteralMatcher::AddPatterns(rule_index_t rule, const TextMatch& match)
+{
+	for (const std::string& pattern : match.m_Patterns)
+	{
+		if (match.m_Mode == TextMatchMode::Word)
+		{
+			// Empty words never match anything
+			if (!pattern.empty())
+				m_Words[mh::tolower(pattern)].push_back({ rule, match.m_Mode, match.m_CaseSensitive, pattern });
+
+			continue;
+		}
+
+		if (pattern.empty())
+		{
+			// Everything contains/starts with/ends with nothing. Nothing is equal to nothing,
+			// because empty text never gets this far.
+			if (match.m_Mode != TextMatchMode::Equal)
+				m_AlwaysMatchRules.push_back(rule);
+
+			continue;
+		}
+
+		m_Patterns.push_back({ rule, match.m_Mode, match.m_CaseSensitive, pattern });
+		m_FoldedPatterns.push_back(mh::tolower(pattern));
+	}
+}
+
+void CompiledRuleSet::LiteralMatcher::Build()
+{
+	m_Automaton = AhoCorasick(std::vector<std::string_view>(m_FoldedPatterns.begin(), m_FoldedPatterns.end()));
+}
+
+void CompiledRuleSet::LiteralMatcher::FindRules(const std::string_view& text, TriggerBits triggerBit,
+	std::vector<std::pair<rule_index_t, uint8_t>>& results) const
+{
+	if (text.empty())
+		return;
+
+	for (rule_index_t rule : m_AlwaysMatchRules)
+		results.emplace_back(rule, triggerBit);
+
+	// Case sensitive patterns are in there folded too, so everything can be found in one
+	// pass. Folding doesn't change the length, so they're checked against the original text
+	// at the same position.
+	const std::string foldedText = mh::tolower(text);
+	m_Automaton.FindAll(foldedText, [&](AhoCorasick::pattern_index_t index, size_t end)
+		{
+			const Pattern& pattern = m_Patterns[index];
+			const size_t start = end - pattern.m_Text.size();
+
+			switch (pattern.m_Mode)
+			{
+			case TextMatchMode::Equal:
+				if (start != 0 || end != text.size())
+					return;
+				break;
+			case TextMatchMode::StartsWith:
+				if (start != 0)
+					return;
+				break;
+			case TextMatchMode::EndsWith:
+				if (end != text.size())
+					return;
+				break;
+			default:
+				break;
+			}
+
+			if (pattern.m_CaseSensitive && text.substr(start, pattern.m_Text.size()) != pattern.m_Text)
+				return;
+
+			results.emplace_back(pattern.m_Rule, triggerBit);
+		});
+
+	if (!m_Words.empty())
+	{
+		// Same as what (\w+) matches with std::regex
+		const auto IsWordChar = [](char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		};
+
+		for (size_t end = 0; end < foldedText.size(); )
+		{
+			const size_t start = end;
+			while (end < foldedText.size() && IsWordChar(foldedText[end]))
+				end++;
+
+			if (start == end)
+			{
+				end++;
+				continue;
+			}
+
+			const std::string_view word = std::string_view(foldedText).substr(start, end - start);
+			if (auto found = m_Words.find(word); found != m_Words.end())
+			{
+				for (const Pattern& pattern : found->second)
+				{
+					if (!pattern.m_CaseSensitive || text.substr(start, word.size()) == pattern.m_Text)
+						results.emplace_back(pattern.m_Rule, triggerBit);
+				}
+			}
+		}
+	}
+}
+
+size_t CompiledRuleSet::AvatarHashHash::operator()(const avatar_hash_t& hash) const
+{
+	// It's already a SHA1, so any part of it is as good a hash as any
+	size_t result;
+	static_assert(sizeof(result) <= sizeof(hash));
+	std::memcpy(&result, hash.data(), sizeof(result));
+	return result;
+}
+
+auto CompiledRuleSet::ParseAvatarHash(const std::string_view& hash) -> std::optional<avatar_hash_t>
+{
+	if (hash.size() != std::tuple_size_v<avatar_hash_t> * 2)
+		return std::nullopt;
+
+	const auto ParseNibble = [](char c) -> int
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+
+		return -1;
+	};
+
+	avatar_hash_t result;
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		const int high = ParseNibble(hash[i * 2]);
+		const int low = ParseNibble(hash[i * 2 + 1]);
+		if (high < 0 || low < 0)
+			return std::nullopt;
+
+		result[i] = uint8_t((high << 4) | low);
+	}
+
+	return result;
+}
+
+CompiledRuleSet::CompiledRuleSet(std::vector<ModerationRule> rules) :
+	m_Rules(std::move(rules))
+{
+	static std::atomic<uint64_t> s_LastGeneration = 0;
+	m_Generation = ++s_LastGeneration;
+
+	m_CompiledRules.reserve(m_Rules.size());
+	for (rule_index_t i = 0; i < m_Rules.size(); i++)
+	{
+		const ModerationRule& rule = m_Rules[i];
+		const auto& triggers = rule.m_Triggers;
+		auto& compiled = m_CompiledRules.emplace_back();
+		bool isNonLiteral = false;
+		m_HasAvatarTriggers |= !triggers.m_AvatarMatches.empty();
+
+		for (const AvatarMatch& avatarMatch : triggers.m_AvatarMatches)
+		{
+			if (const auto hash = ParseAvatarHash(avatarMatch.m_AvatarHash))
+			{
+				m_AvatarRules[*hash].push_back(i);
+			}
+			else
+			{
+				LogError("Invalid avatar hash {} in rule {}, ignoring it", std::quoted(avatarMatch.m_AvatarHash),
+					std::quoted(rule.m_Description));
+				m_InvalidPatternCount++;
+			}
+		}
+
+		const auto AddTextMatch = [&](const std::optional<TextMatch>& match, std::optional<CompiledTextMatch>& compiledMatch,
+			LiteralMatcher& literals)
+		{
+			if (!match)
+				return;
+
+			if (CompiledTextMatch::IsSupported(match->m_Mode))
+			{
+				compiledMatch.emplace(*match, rule.m_Description, m_InvalidPatternCount);
+				isNonLiteral = true;
+			}
+			else
+			{
+				literals.AddPatterns(i, *match);
+			}
+		};
+
+		AddTextMatch(triggers.m_UsernameTextMatch, compiled.m_UsernameTextMatch, m_UsernameLiterals);
+		AddTextMatch(triggers.m_ChatMsgTextMatch, compiled.m_ChatMsgTextMatch, m_ChatMsgLiterals);
+
+		if (isNonLiteral)
+			m_NonLiteralRules.push_back(i);
+	}
+
+	m_UsernameLiterals.Build();
+	m_ChatMsgLiterals.Build();
+}
 
-		for (const auto& m : m_Triggers.m_AvatarMatches)
+mh::generator<const ModerationRule&> CompiledRuleSet::FindMatches(const IPlayer& player, std::string_view chatMsg) const
+{
+	// Only rules that had a literal pattern or avatar hash match, or that could match some
+	// other way, are worth looking at, so how long this takes depends on the text rather
+	// than on how many rules there are.
+	std::vector<std::pair<rule_index_t, uint8_t>> candidates;
+	m_UsernameLiterals.FindRules(player.GetNameUnsafe(), TRIGGER_USERNAME, candidates);
+	m_ChatMsgLiterals.FindRules(chatMsg, TRIGGER_CHATMSG, candidates);
+	for (rule_index_t rule : m_NonLiteralRules)
+		candidates.emplace_back(rule, uint8_t(0));
+
+	if (m_HasAvatarTriggers)
+	{
+		if (const auto& summary = player.GetPlayerSummary())
 		{
-			if (m.Match(summary->m_AvatarHash))
-				return MatchResult::Match;
+			if (const auto hash = ParseAvatarHash(summary->m_AvatarHash))
+			{
+				if (auto found = m_AvatarRules.find(*hash); found != m_AvatarRules.end())
+				{
+					for (rule_index_t rule : found->second)
+						candidates.emplace_back(rule, TRIGGER_AVATAR);
+				}
+			}
 		}
+	}
+
+	// In rule order, with all the trigger bits for each rule combined
+	std::sort(candidates.begin(), candidates.end());
 
-		return MatchResult::NoMatch;
+	// Literal triggers were already matched above
+	struct TriggerMatch
+	{
+		const CompiledTextMatch* m_Compiled;
+		bool m_LiteralMatched;
+
+		bool Match(const std::string_view& text) const { return m_Compiled ? m_Compiled->Match(text) : m_LiteralMatched; }
 	};
 
-	return MatchRules(m_Triggers.m_Mode, usernameMatch, chatMsgMatch, avatarMatch);
+	for (size_t c = 0; c < candidates.size(); )
+	{
+		const rule_index_t i = candidates[c].first;
+		uint8_t triggerBits = 0;
+		for (; c < candidates.size() && candidates[c].first == i; c++)
+			triggerBits |= candidates[c].second;
+
+		const ModerationRule& rule = m_Rules[i];
+		const CompiledRule& compiled = m_CompiledRules[i];
+
+		const auto GetTriggerMatch = [&](const std::optional<TextMatch>& match,
+			const std::optional<CompiledTextMatch>& compiledMatch, TriggerBits bit) -> std::optional<TriggerMatch>
+		{
+			if (!match)
+				return std::nullopt;
+
+			return TriggerMatch{ compiledMatch ? &*compiledMatch : nullptr, (triggerBits & bit) != 0 };
+		};
+
+		const auto usernameMatch = GetTriggerMatch(rule.m_Triggers.m_UsernameTextMatch, compiled.m_UsernameTextMatch, TRIGGER_USERNAME);
+		const auto chatMsgMatch = GetTriggerMatch(rule.m_Triggers.m_ChatMsgTextMatch, compiled.m_ChatMsgTextMatch, TRIGGER_CHATMSG);
+
+		const bool isMatch = MatchTriggers(rule.m_Triggers,
+			usernameMatch ? &*usernameMatch : nullptr,
+			chatMsgMatch ? &*chatMsgMatch : nullptr,
+			[&] { return (triggerBits & TRIGGER_AVATAR) != 0; },
+			player, chatMsg);
+
+		if (isMatch)
+			co_yield rule;
+	}
+}
+
+bool PlayerRuleMatches::Update(const CompiledRuleSet& rules, const IPlayer& player)
+{
+	const auto name = player.GetNameUnsafe();
+	std::string_view avatarHash;
+	if (rules.HasAvatarTriggers())
+	{
+		if (const auto& summary = player.GetPlayerSummary())
+			avatarHash = summary->m_AvatarHash;
+	}
+
+	if (m_RulesGeneration == rules.GetGeneration() && m_Name == name && m_AvatarHash == avatarHash)
+		return true;
+
+	m_RulesGeneration = rules.GetGeneration();
+	m_Name = name;
+	m_AvatarHash = avatarHash;
+
+	m_MatchedRules.clear();
+	for (const ModerationRule& rule : rules.FindMatches(player))
+		m_MatchedRules.push_back(rules.GetRuleIndex(rule));
+
+	return false;
 }
 
 bool AvatarMatch::Match(const std::string_view& avatarHash) const
 {
-	return m_AvatarHash == avatarHash;
+	// Hex digits, so the case doesn't matter (and CompiledRuleSet doesn't care either)
+	return mh::case_insensitive_compare(m_AvatarHash, avatarHash);
 }
@@ -1,12 +1,19 @@
 #pragma once
 #include "ConfigHelpers.h"
+#include "Util/AhoCorasick.h"
 
 #include <mh/coroutine/generator.hpp>
 #include <mh/reflection/enum.hpp>
 #include <nlohmann/json_fwd.hpp>
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <regex>
+#include <unordered_map>
 #include <vector>
 
 namespace tf2_bot_detector
@@ -46,6 +53,22 @@ namespace tf2_bot_detector
 		bool Match(const std::string_view& text) const;
 	};
 
+	// A regex TextMatch with the regexes built ahead of time. The other modes are all
+	// literal, CompiledRuleSet matches those in bulk.
+	class CompiledTextMatch final
+	{
+	public:
+		// Patterns that aren't valid regexes are logged and left out
+		CompiledTextMatch(const TextMatch& match, const std::string_view& ruleDescription, size_t& invalidPatternCount);
+
+		static bool IsSupported(TextMatchMode mode) { return mode == TextMatchMode::Regex; }
+
+		bool Match(const std::string_view& text) const;
+
+	private:
+		std::vector<std::regex> m_Regexes;
+	};
+
 	struct AvatarMatch
 	{
 		std::string m_AvatarHash;
@@ -80,18 +103,162 @@ namespace tf2_bot_detector
 		} m_Actions;
 	};
 
+	// An immutable copy of a set of rules, prepared for matching
+	class CompiledRuleSet final
+	{
+	public:
+		explicit CompiledRuleSet(std::vector<ModerationRule> rules);
+
+		const std::vector<ModerationRule>& GetRules() const { return m_Rules; }
+		size_t GetRuleIndex(const ModerationRule& rule) const { return &rule - m_Rules.data(); }
+		size_t GetInvalidPatternCount() const { return m_InvalidPatternCount; }
+
+		// Different for every rule set ever compiled, so results can be remembered per generation
+		uint64_t GetGeneration() const { return m_Generation; }
+
+		// If false, nothing depends on the player's avatar, so don't bother fetching it
+		bool HasAvatarTriggers() const { return m_HasAvatarTriggers; }
+
+		mh::generator<const ModerationRule&> FindMatches(const IPlayer& player, std::string_view chatMsg = {}) const;
+
+	private:
+		using rule_index_t = uint32_t;
+
+		// Which of a rule's literal text/avatar triggers matched
+		enum TriggerBits : uint8_t
+		{
+			TRIGGER_USERNAME = 1 << 0,
+			TRIGGER_CHATMSG = 1 << 1,
+			TRIGGER_AVATAR = 1 << 2,
+		};
+
+		// An avatar hash is a hex SHA1, this is its 20 bytes
+		using avatar_hash_t = std::array<uint8_t, 20>;
+		struct AvatarHashHash
+		{
+			size_t operator()(const avatar_hash_t& hash) const;
+		};
+		static std::optional<avatar_hash_t> ParseAvatarHash(const std::string_view& hash);
+
+		// Every non-regex pattern for one field (username or chat message) of every rule, case
+		// folded. Equal/contains/starts_with/ends_with patterns go into one automaton, word
+		// patterns into one hash table, so one pass over the text (and one lookup per word)
+		// finds all the rules with a pattern that matches.
+		class LiteralMatcher final
+		{
+		public:
+			void AddPatterns(rule_index_t rule, const TextMatch& match);
+			void Build();
+
+			// Adds { rule, triggerBit } for every rule with a matching pattern, possibly more than once
+			void FindRules(const std::string_view& text, TriggerBits triggerBit,
+				std::vector<std::pair<rule_index_t, uint8_t>>& results) const;
+
+		private:
+			struct Pattern
+			{
+				rule_index_t m_Rule;
+				TextMatchMode m_Mode;
+				bool m_CaseSensitive;
+				std::string m_Text; // As written, only needed to check case sensitive matches
+			};
+
+			struct WordHash
+			{
+				using is_transparent = void;
+				size_t operator()(const std::string_view& word) const { return std::hash<std::string_view>{}(word); }
+			};
+
+			std::vector<Pattern> m_Patterns; // Indexed by AhoCorasick::pattern_index_t
+			std::vector<std::string> m_FoldedPatterns;
+			AhoCorasick m_Automaton;
+			std::vector<rule_index_t> m_AlwaysMatchRules; // Empty contains/starts_with/ends_with patterns
+
+			// Word patterns, by their folded text
+			std::unordered_map<std::string, std::vector<Pattern>, WordHash, std::equal_to<>> m_Words;
+		};
+
+		struct CompiledRule
+		{
+			std::optional<CompiledTextMatch> m_UsernameTextMatch; // Regex only
+			std::optional<CompiledTextMatch> m_ChatMsgTextMatch;  // Regex only
+		};
+
+		std::vector<ModerationRule> m_Rules;
+		std::vector<CompiledRule> m_CompiledRules; // Same order as m_Rules
+		LiteralMatcher m_UsernameLiterals;
+		LiteralMatcher m_ChatMsgLiterals;
+
+		// The rules with each avatar hash in their avatar triggers
+		std::unordered_map<avatar_hash_t, std::vector<rule_index_t>, AvatarHashHash> m_AvatarRules;
+
+		// Rules that could match without any of their literal patterns or avatar hashes
+		// matching (regex triggers). Everything else can be skipped unless LiteralMatcher or
+		// m_AvatarRules finds it.
+		std::vector<rule_index_t> m_NonLiteralRules;
+
+		size_t m_InvalidPatternCount = 0;
+		uint64_t m_Generation = 0;
+		bool m_HasAvatarTriggers = false;
+	};
+
+	// Which rules matched a player's name and avatar the last time they were checked. Without
+	// a chat message, those are the only things about a player that make any difference to
+	// which rules match, so the rules only need to run again if one of them (or the rules)
+	// changed.
+	class PlayerRuleMatches final
+	{
+	public:
+		// Returns true if the last matches still apply, false if the rules had to run again
+		bool Update(const CompiledRuleSet& rules, const IPlayer& player);
+
+		// Indices into CompiledRuleSet::GetRules()
+		const std::vector<size_t>& GetMatchedRules() const { return m_MatchedRules; }
+
+	private:
+		uint64_t m_RulesGeneration = 0; // 0 if they were never checked
+		std::string m_Name;
+		std::string m_AvatarHash;
+		std::vector<size_t> m_MatchedRules;
+	};
+
 	class ModerationRules
 	{
 	public:
 		ModerationRules(const Settings& settings);
 
+		// Just the rules in fixedRules (the same format as rules.json), without touching cfg/
+		ModerationRules(const Settings& settings, const nlohmann::json& fixedRules);
+
 		bool LoadFiles();
 		bool SaveFile() const;
 
 		mh::generator<const ModerationRule&> GetRules() const;
 		size_t GetRuleCount() const { return m_CFGGroup.size(); }
 
+		// Compiles the rules again once lists that were loading in the background finish.
+		// Call on the main thread.
+		void Update();
+
+		// Rebuilt by LoadFiles() and Update() whenever the loaded rules change. Call on the main
+		// thread, but the returned rules can be used anywhere, for as long as you hold on to them.
+		std::shared_ptr<const CompiledRuleSet> GetCompiledRules() const { return m_CompiledRules; }
+
 	private:
+		// Which lists had finished loading when m_CompiledRules was built
+		struct CompiledRulesKey
+		{
+			bool operator==(const CompiledRulesKey&) const = default;
+
+			bool m_OfficialListLoaded = false;
+			bool m_ThirdPartyListsLoaded = false;
+		};
+		CompiledRulesKey GetCompiledRulesKey() const;
+		void CompileRules();
+
+		CompiledRulesKey m_CompiledRulesKey;
+		std::shared_ptr<const CompiledRuleSet> m_CompiledRules;
+
 		using RuleList_t = std::vector<ModerationRule>;
 		struct RuleFile final : SharedConfigFileBase
 		{
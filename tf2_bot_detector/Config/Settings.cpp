@@ -16,6 +16,7 @@
 #include <nlohmann/json.hpp>
 #include <srcon/async_client.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -227,6 +228,11 @@ catch (...)
 	throw;
 }
 
+Settings::Settings(std::nullptr_t)
+{
+	PostLoad(false);
+}
+
 Settings::~Settings() = default;
 
 void Settings::LoadFile() try
@@ -299,6 +305,8 @@ void Settings::Deserialize(const nlohmann::json& json)
 		try_get_to_defaulted(*found, m_AutoVotekickDelay, "auto_votekick_delay", DEFAULTS.m_AutoVotekickDelay);
 		try_get_to_defaulted(*found, m_AutoMark, "auto_mark", DEFAULTS.m_AutoMark);
 		try_get_to_defaulted(*found, m_LazyLoadAPIData, "lazy_load_api_data", DEFAULTS.m_LazyLoadAPIData);
+		try_get_to_defaulted(*found, m_MaxCachedPlayers, "max_cached_players", DEFAULTS.m_MaxCachedPlayers);
+		m_MaxCachedPlayers = std::max(m_MaxCachedPlayers, MIN_MAX_CACHED_PLAYERS);
 
 		{
 			std::string apiKey;
@@ -345,6 +353,7 @@ void Settings::Serialize(nlohmann::json& json) const
 				{ "auto_votekick_delay", m_AutoVotekickDelay },
 				{ "auto_mark", m_AutoMark },
 				{ "lazy_load_api_data", m_LazyLoadAPIData },
+				{ "max_cached_players", m_MaxCachedPlayers },
 			}
 		},
 		{ "goto_profile_sites", m_GotoProfileSites },
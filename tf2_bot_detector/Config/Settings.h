@@ -69,6 +69,10 @@ namespace tf2_bot_detector
 
 		bool m_LazyLoadAPIData = true;
 
+		// Players that haven't been seen in a while are evicted once we're tracking more than this
+		unsigned m_MaxCachedPlayers = 128;
+		static constexpr unsigned MIN_MAX_CACHED_PLAYERS = 32; // A full server (us included), same as the schema
+
 		std::optional<ReleaseChannel> m_ReleaseChannel;
 
 		constexpr auto GetAutoVotekickDelay() const { return std::chrono::duration<float>(m_AutoVotekickDelay); }
@@ -84,6 +88,7 @@ namespace tf2_bot_detector
 	{
 	public:
 		Settings();
+		explicit Settings(std::nullptr_t); // Defaults only, doesn't read or write cfg/settings.json
 		~Settings();
 
 		void LoadFile();
@@ -105,6 +110,7 @@ namespace tf2_bot_detector
 
 		std::optional<bool> m_AllowInternetUsage;
 		std::shared_ptr<const IHTTPClient> GetHTTPClient() const;
+		void SetHTTPClient(std::shared_ptr<IHTTPClient> client) { m_HTTPClient = std::move(client); }
 
 		std::vector<GotoProfileSite> m_GotoProfileSites;
 
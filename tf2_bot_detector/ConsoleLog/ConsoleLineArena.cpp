@@ -0,0 +1,181 @@
+#include "ConsoleLineArena.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+using namespace tf2_bot_detector;
+
+namespace
+{
+	// A new arena is created for every batch of lines, so hang on to their blocks
+	// instead of going back to the heap every time.
+	class BlockPool final
+	{
+	public:
+		static constexpr size_t MAX_FREE_BLOCKS = 256;
+
+		std::byte* Acquire(bool& fromHeap)
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				if (!m_FreeBlocks.empty())
+				{
+					auto block = m_FreeBlocks.back();
+					m_FreeBlocks.pop_back();
+					fromHeap = false;
+					return block;
+				}
+			}
+
+			fromHeap = true;
+			return new std::byte[ConsoleLineArena::DEFAULT_BLOCK_SIZE];
+		}
+
+		void Release(std::byte* block)
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				if (m_FreeBlocks.size() < MAX_FREE_BLOCKS)
+				{
+					m_FreeBlocks.push_back(block);
+					return;
+				}
+			}
+
+			delete[] block;
+		}
+
+	private:
+		std::mutex m_Mutex;
+		std::vector<std::byte*> m_FreeBlocks;
+	};
+
+	BlockPool& GetBlockPool()
+	{
+		// Intentionally leaked, line objects (and their arenas) may outlive static destruction
+		static BlockPool* s_Pool = new BlockPool();
+		return *s_Pool;
+	}
+
+	thread_local std::shared_ptr<ConsoleLineArena> s_CurrentArena;
+}
+
+ConsoleLineArena::ConsoleLineArena(std::shared_ptr<const std::string> text, size_t blockSize) :
+	m_Text(std::move(text)),
+	m_BlockSize(blockSize)
+{
+	m_PooledBlocks.reserve(8);
+}
+
+ConsoleLineArena::~ConsoleLineArena()
+{
+	auto& pool = GetBlockPool();
+	for (auto block : m_PooledBlocks)
+		pool.Release(block);
+}
+
+void ConsoleLineArena::AddBlock(size_t minSize)
+{
+	std::byte* block;
+	if (minSize > m_BlockSize)
+	{
+		// Doesn't fit in a regular block, give it one of its own
+		block = m_OwnedBlocks.emplace_back(OwnedBlock{ std::make_unique<std::byte[]>(minSize), minSize }).m_Data.get();
+		m_HeapBlockCount++;
+		m_Cursor = block;
+		m_Remaining = minSize;
+		return;
+	}
+
+	if (m_BlockSize == DEFAULT_BLOCK_SIZE)
+	{
+		bool fromHeap;
+		block = m_PooledBlocks.emplace_back(GetBlockPool().Acquire(fromHeap));
+		m_HeapBlockCount += fromHeap;
+	}
+	else
+	{
+		block = m_OwnedBlocks.emplace_back(OwnedBlock{ std::make_unique<std::byte[]>(m_BlockSize), m_BlockSize }).m_Data.get();
+		m_HeapBlockCount++;
+	}
+
+	m_Cursor = block;
+	m_Remaining = m_BlockSize;
+}
+
+bool ConsoleLineArena::Owns(const void* ptr) const
+{
+	const auto IsInBlock = [&](const std::byte* block, size_t size)
+	{
+		return uintptr_t(ptr) >= uintptr_t(block) && uintptr_t(ptr) < (uintptr_t(block) + size);
+	};
+
+	for (const std::byte* block : m_PooledBlocks)
+	{
+		if (IsInBlock(block, DEFAULT_BLOCK_SIZE))
+			return true;
+	}
+	for (const OwnedBlock& block : m_OwnedBlocks)
+	{
+		if (IsInBlock(block.m_Data.get(), block.m_Size))
+			return true;
+	}
+
+	return false;
+}
+
+void* ConsoleLineArena::Allocate(size_t size, size_t alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	const auto GetPadding = [&] { return (alignment - (uintptr_t(m_Cursor) & (alignment - 1))) & (alignment - 1); };
+
+	size_t padding = GetPadding();
+	if (!m_Cursor || (padding + size) > m_Remaining)
+	{
+		AddBlock(size + alignment - 1);
+		padding = GetPadding();
+	}
+
+	std::byte* result = m_Cursor + padding;
+	m_Cursor += padding + size;
+	m_Remaining -= padding + size;
+	m_AllocatedSize += size;
+	return result;
+}
+
+std::string_view ConsoleLineArena::Store(const std::string_view& text)
+{
+	if (text.empty())
+		return {};
+
+	if (const auto ownText = GetText(); !ownText.empty())
+	{
+		const auto ownBegin = uintptr_t(ownText.data());
+		const auto textBegin = uintptr_t(text.data());
+		if (textBegin >= ownBegin && (textBegin + text.size()) <= (ownBegin + ownText.size()))
+			return text;
+	}
+
+	auto copy = static_cast<char*>(Allocate(text.size(), 1));
+	std::memcpy(copy, text.data(), text.size());
+	return std::string_view(copy, text.size());
+}
+
+ConsoleLineArena::Scope::Scope(std::shared_ptr<ConsoleLineArena> arena) :
+	m_Previous(std::exchange(s_CurrentArena, std::move(arena)))
+{
+}
+
+ConsoleLineArena::Scope::~Scope()
+{
+	s_CurrentArena = std::move(m_Previous);
+}
+
+const std::shared_ptr<ConsoleLineArena>& ConsoleLineArena::GetCurrent()
+{
+	return s_CurrentArena;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace tf2_bot_detector
+{
+	// Bump allocator for the console line objects parsed out of one batch of console output.
+	// It keeps a reference to the text the lines were parsed from, so line objects can hold
+	// std::string_views into it rather than their own copies. Objects allocated through
+	// ConsoleLineArena::Allocator hold a reference to the arena, so the arena (and the text)
+	// stays alive until the last of them is released.
+	//
+	// Not thread safe. A batch is only ever worked on by one thread at a time.
+	class ConsoleLineArena final
+	{
+	public:
+		static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+		explicit ConsoleLineArena(std::shared_ptr<const std::string> text = nullptr, size_t blockSize = DEFAULT_BLOCK_SIZE);
+		~ConsoleLineArena();
+
+		ConsoleLineArena(const ConsoleLineArena&) = delete;
+		ConsoleLineArena& operator=(const ConsoleLineArena&) = delete;
+
+		std::string_view GetText() const { return m_Text ? std::string_view(*m_Text) : std::string_view{}; }
+
+		void* Allocate(size_t size, size_t alignment);
+
+		// Returns a view of text that lives as long as the arena does. Free if text already
+		// points into GetText(), otherwise it gets copied into the arena.
+		std::string_view Store(const std::string_view& text);
+
+		// Total bytes handed out by Allocate()
+		size_t GetAllocatedSize() const { return m_AllocatedSize; }
+		// Blocks that had to come from the heap, rather than from ones released by earlier arenas
+		size_t GetHeapBlockCount() const { return m_HeapBlockCount; }
+
+		// True if ptr points into memory handed out by Allocate()
+		bool Owns(const void* ptr) const;
+
+		template<typename T>
+		class Allocator
+		{
+		public:
+			using value_type = T;
+
+			Allocator(std::shared_ptr<ConsoleLineArena> arena) : m_Arena(std::move(arena)) {}
+			template<typename U>
+			Allocator(const Allocator<U>& other) : m_Arena(other.m_Arena) {}
+
+			T* allocate(size_t count) { return static_cast<T*>(m_Arena->Allocate(sizeof(T) * count, alignof(T))); }
+			void deallocate(T*, size_t) {} // Everything is released at once with the arena
+
+			template<typename U>
+			bool operator==(const Allocator<U>& other) const { return m_Arena == other.m_Arena; }
+
+		private:
+			template<typename U> friend class Allocator;
+			std::shared_ptr<ConsoleLineArena> m_Arena;
+		};
+
+		// Makes arena the current thread's arena (see GetCurrent()) until destroyed.
+		class Scope final
+		{
+		public:
+			explicit Scope(std::shared_ptr<ConsoleLineArena> arena);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			std::shared_ptr<ConsoleLineArena> m_Previous;
+		};
+
+		// The arena console lines created on this thread should be allocated from, if any.
+		static const std::shared_ptr<ConsoleLineArena>& GetCurrent();
+
+	private:
+		std::shared_ptr<const std::string> m_Text;
+
+		void AddBlock(size_t minSize);
+		size_t m_BlockSize;
+		std::vector<std::byte*> m_PooledBlocks;
+		struct OwnedBlock
+		{
+			std::unique_ptr<std::byte[]> m_Data;
+			size_t m_Size;
+		};
+		std::vector<OwnedBlock> m_OwnedBlocks; // Non-default sized blocks, not pooled
+		std::byte* m_Cursor = nullptr;
+		size_t m_Remaining = 0;
+		size_t m_AllocatedSize = 0;
+		size_t m_HeapBlockCount = 0;
+	};
+}
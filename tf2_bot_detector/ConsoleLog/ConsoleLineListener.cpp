@@ -1,39 +1,100 @@
 #include "ConsoleLineListener.h"
 #include "WorldState.h"
 
+#include <algorithm>
+
 using namespace tf2_bot_detector;
 
-AutoConsoleLineListener::AutoConsoleLineListener(IWorldState& world) :
-	m_World(&world)
+void ConsoleLineBatch::Add(IConsoleLine& line)
+{
+	const auto type = line.GetType();
+	m_Lines.push_back(&line);
+	m_Types.push_back(type);
+	m_PresentTypes.Add(type);
+	m_PartitionsValid = false;
+}
+
+void ConsoleLineBatch::Clear()
+{
+	m_Lines.clear();
+	m_Types.clear();
+	m_PresentTypes = {};
+	m_PartitionsValid = false;
+}
+
+ConsoleLineSpan ConsoleLineBatch::GetLines(const ConsoleLineTypeMask& mask) const
+{
+	return ConsoleLineSpan(*this, mask);
+}
+
+void ConsoleLineBatch::UpdatePartitions() const
+{
+	if (m_PartitionsValid)
+		return;
+
+	// Counting sort, stable so each partition stays in the original order
+	m_PartitionOffsets.fill(0);
+	for (ConsoleLineType type : m_Types)
+		m_PartitionOffsets[size_t(type) + 1]++;
+
+	for (size_t i = 1; i < m_PartitionOffsets.size(); i++)
+		m_PartitionOffsets[i] += m_PartitionOffsets[i - 1];
+
+	std::array<uint32_t, size_t(ConsoleLineType::COUNT)> cursors;
+	std::copy_n(m_PartitionOffsets.begin(), cursors.size(), cursors.begin());
+
+	m_Partitioned.resize(m_Lines.size());
+	for (size_t i = 0; i < m_Lines.size(); i++)
+		m_Partitioned[cursors[size_t(m_Types[i])]++] = m_Lines[i];
+
+	m_PartitionsValid = true;
+}
+
+std::span<IConsoleLine* const> ConsoleLineSpan::GetLines(ConsoleLineType type) const
+{
+	if (!m_Mask.Contains(type) || !m_Batch->m_PresentTypes.Contains(type))
+		return {};
+
+	m_Batch->UpdatePartitions();
+
+	const auto begin = m_Batch->m_PartitionOffsets[size_t(type)];
+	const auto end = m_Batch->m_PartitionOffsets[size_t(type) + 1];
+	return std::span<IConsoleLine* const>(m_Batch->m_Partitioned.data() + begin, end - begin);
+}
+
+AutoConsoleLineListener::AutoConsoleLineListener(IWorldState& world, const ConsoleLineTypeMask& interests) :
+	m_World(&world), m_Interests(interests)
 {
-	m_World->AddConsoleLineListener(this);
+	m_World->AddConsoleLineListener(this, m_Interests);
 }
 
 AutoConsoleLineListener::AutoConsoleLineListener(const AutoConsoleLineListener& other) :
-	m_World(other.m_World)
+	m_World(other.m_World), m_Interests(other.m_Interests)
 {
-	m_World->AddConsoleLineListener(this);
+	m_World->AddConsoleLineListener(this, m_Interests);
 }
 
 AutoConsoleLineListener& AutoConsoleLineListener::operator=(const AutoConsoleLineListener& other)
 {
 	m_World->RemoveConsoleLineListener(this);
 	m_World = other.m_World;
-	m_World->AddConsoleLineListener(this);
+	m_Interests = other.m_Interests;
+	m_World->AddConsoleLineListener(this, m_Interests);
 	return *this;
 }
 
 AutoConsoleLineListener::AutoConsoleLineListener(AutoConsoleLineListener&& other) :
-	m_World(other.m_World)
+	m_World(other.m_World), m_Interests(other.m_Interests)
 {
-	m_World->AddConsoleLineListener(this);
+	m_World->AddConsoleLineListener(this, m_Interests);
 }
 
 AutoConsoleLineListener& AutoConsoleLineListener::operator=(AutoConsoleLineListener&& other)
 {
 	m_World->RemoveConsoleLineListener(this);
 	m_World = other.m_World;
-	m_World->AddConsoleLineListener(this);
+	m_Interests = other.m_Interests;
+	m_World->AddConsoleLineListener(this, m_Interests);
 	return *this;
 }
 
@@ -1,20 +1,127 @@
 #pragma once
 
 #include "Clock.h"
+#include "IConsoleLine.h"
 
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <span>
 #include <string_view>
+#include <vector>
 
 namespace tf2_bot_detector
 {
-	class IConsoleLine;
 	class IWorldState;
+	class ConsoleLineSpan;
+
+	// A run of parsed console lines, in the order they were logged. The lines themselves
+	// are owned by whoever filled in the batch and must outlive it.
+	class ConsoleLineBatch final
+	{
+	public:
+		void Add(IConsoleLine& line);
+		void Clear();
+		bool empty() const { return m_Lines.empty(); }
+		size_t size() const { return m_Lines.size(); }
+
+		ConsoleLineSpan GetLines(const ConsoleLineTypeMask& mask = ConsoleLineTypeMask::All()) const;
+
+	private:
+		friend class ConsoleLineSpan;
+
+		std::vector<IConsoleLine*> m_Lines;
+		std::vector<ConsoleLineType> m_Types; // Parallel to m_Lines, so filtering doesn't have to touch the lines
+		ConsoleLineTypeMask m_PresentTypes;
+
+		// The same lines grouped by type (still in order within each type), built on first use
+		void UpdatePartitions() const;
+		mutable std::vector<IConsoleLine*> m_Partitioned;
+		mutable std::array<uint32_t, size_t(ConsoleLineType::COUNT) + 1> m_PartitionOffsets{};
+		mutable bool m_PartitionsValid = false;
+	};
+
+	// The lines of a ConsoleLineBatch that match a ConsoleLineTypeMask
+	class ConsoleLineSpan final
+	{
+	public:
+		ConsoleLineSpan(const ConsoleLineBatch& batch, const ConsoleLineTypeMask& mask) :
+			m_Batch(&batch), m_Mask(mask)
+		{
+		}
+
+		class iterator final
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = IConsoleLine;
+			using difference_type = ptrdiff_t;
+			using pointer = IConsoleLine*;
+			using reference = IConsoleLine&;
+
+			iterator() = default;
+			iterator(const ConsoleLineSpan& span, size_t index) :
+				m_Batch(span.m_Batch), m_Mask(span.m_Mask), m_Index(index)
+			{
+				SkipFiltered();
+			}
+
+			IConsoleLine& operator*() const { return *m_Batch->m_Lines[m_Index]; }
+			IConsoleLine* operator->() const { return m_Batch->m_Lines[m_Index]; }
+
+			iterator& operator++() { m_Index++; SkipFiltered(); return *this; }
+			iterator operator++(int) { auto retVal = *this; ++*this; return retVal; }
+
+			bool operator==(const iterator& other) const { return m_Index == other.m_Index; }
+
+		private:
+			void SkipFiltered()
+			{
+				const auto& types = m_Batch->m_Types;
+				while (m_Index < types.size() && !m_Mask.Contains(types[m_Index]))
+					m_Index++;
+			}
+
+			const ConsoleLineBatch* m_Batch = nullptr;
+			ConsoleLineTypeMask m_Mask;
+			size_t m_Index = 0;
+		};
+
+		iterator begin() const { return iterator(*this, 0); }
+		iterator end() const { return iterator(*this, m_Batch->m_Lines.size()); }
+
+		bool empty() const { return GetTypes().empty(); }
+
+		// The types of the lines in this span
+		ConsoleLineTypeMask GetTypes() const { return m_Batch->m_PresentTypes & m_Mask; }
+
+		// All lines of the given type, in order
+		std::span<IConsoleLine* const> GetLines(ConsoleLineType type) const;
+
+		ConsoleLineSpan Filter(const ConsoleLineTypeMask& mask) const { return ConsoleLineSpan(*m_Batch, m_Mask & mask); }
+
+	private:
+		const ConsoleLineBatch* m_Batch;
+		ConsoleLineTypeMask m_Mask;
+	};
 
 	class IConsoleLineListener
 	{
 	public:
 		virtual ~IConsoleLineListener() = default;
 
-		virtual void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) = 0;
+		/// <summary>
+		/// Called with runs of parsed lines, in the order they were logged. Only includes
+		/// the types this listener was registered for.
+		///
+		/// Each listener (in the order they were added) gets the whole run before the next
+		/// one sees any of it. So anything a listener reads from state that an earlier
+		/// listener keeps (the world state is always first) already reflects the end of
+		/// the run. Runs never span a change in world time, an unparsed line or a chat
+		/// line, so that state is never ahead of the line being looked at by more than
+		/// other lines with the same timestamp.
+		/// </summary>
+		virtual void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) = 0;
 		virtual void OnConsoleLineUnparsed(IWorldState& world, const std::string_view& text) = 0;
 
 		/// <summary>
@@ -29,7 +136,7 @@ namespace tf2_bot_detector
 	class BaseConsoleLineListener : public IConsoleLineListener
 	{
 	public:
-		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) override {}
+		void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override {}
 		void OnConsoleLineUnparsed(IWorldState& world, const std::string_view& text) override {}
 
 		void OnConsoleLogChunkParsed(IWorldState& world, bool consoleLinesParsed) override {}
@@ -38,7 +145,7 @@ namespace tf2_bot_detector
 	class AutoConsoleLineListener : public BaseConsoleLineListener
 	{
 	public:
-		AutoConsoleLineListener(IWorldState& world);
+		AutoConsoleLineListener(IWorldState& world, const ConsoleLineTypeMask& interests = ConsoleLineTypeMask::All());
 		AutoConsoleLineListener(const AutoConsoleLineListener& other);
 		AutoConsoleLineListener& operator=(const AutoConsoleLineListener& other);
 		AutoConsoleLineListener(AutoConsoleLineListener&& other);
@@ -47,5 +154,6 @@ namespace tf2_bot_detector
 
 	private:
 		IWorldState* m_World = nullptr;
+		ConsoleLineTypeMask m_Interests;
 	};
 }
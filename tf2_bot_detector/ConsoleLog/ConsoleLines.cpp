@@ -14,9 +14,17 @@
 #include <mh/text/string_insertion.hpp>
 #include <imgui_desktop/ScopeGuards.h>
 
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #undef GetMessage
 
@@ -25,15 +33,14 @@ using namespace std::chrono_literals;
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 
-GenericConsoleLine::GenericConsoleLine(time_point_t timestamp, std::string text) :
-	BaseClass(timestamp), m_Text(std::move(text))
+GenericConsoleLine::GenericConsoleLine(time_point_t timestamp, std::string_view text) :
+	BaseClass(timestamp), m_Text(text)
 {
-	m_Text.shrink_to_fit();
 }
 
 std::shared_ptr<IConsoleLine> GenericConsoleLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	return std::make_shared<GenericConsoleLine>(timestamp, std::string(text));
+	return GenericConsoleLine::Create(timestamp, text);
 }
 
 void GenericConsoleLine::Print(const PrintArgs& args) const
@@ -41,13 +48,11 @@ void GenericConsoleLine::Print(const PrintArgs& args) const
 	ImGui::TextFmt(m_Text);
 }
 
-ChatConsoleLine::ChatConsoleLine(time_point_t timestamp, std::string playerName, std::string message,
+ChatConsoleLine::ChatConsoleLine(time_point_t timestamp, std::string_view playerName, std::string_view message,
 	bool isDead, bool isTeam, bool isSelf, TeamShareResult teamShareResult) :
-	ConsoleLineBase(timestamp), m_PlayerName(std::move(playerName)), m_Message(std::move(message)),
+	ConsoleLineBase(timestamp), m_PlayerName(playerName), m_Message(message),
 	m_IsDead(isDead), m_IsTeam(isTeam), m_IsSelf(isSelf), m_TeamShareResult(teamShareResult)
 {
-	m_PlayerName.shrink_to_fit();
-	m_Message.shrink_to_fit();
 }
 
 std::shared_ptr<IConsoleLine> ChatConsoleLine::TryParse(const std::string_view& text, time_point_t timestamp)
@@ -195,17 +200,17 @@ LobbyHeaderLine::LobbyHeaderLine(time_point_t timestamp, unsigned memberCount, u
 
 std::shared_ptr<IConsoleLine> LobbyHeaderLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(CTFLobbyShared: ID:([0-9a-f]*)\s+(\d+) member\(s\), (\d+) pending)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(CTFLobbyShared: ID:([0-9a-f]*)\s+(\d+) member\(s\), (\d+) pending)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		unsigned memberCount, pendingCount;
-		if (!mh::from_chars(std::string_view(&*result[2].first, result[2].length()), memberCount))
+		if (!mh::from_chars(to_string_view(result[2]), memberCount))
 			throw std::runtime_error("Failed to parse lobby member count");
-		if (!mh::from_chars(std::string_view(&*result[3].first, result[3].length()), pendingCount))
+		if (!mh::from_chars(to_string_view(result[3]), pendingCount))
 			throw std::runtime_error("Failed to parse lobby pending member count");
 
-		return std::make_shared<LobbyHeaderLine>(timestamp, memberCount, pendingCount);
+		return LobbyHeaderLine::Create(timestamp, memberCount, pendingCount);
 	}
 
 	return nullptr;
@@ -224,19 +229,19 @@ LobbyMemberLine::LobbyMemberLine(time_point_t timestamp, const LobbyMember& lobb
 
 std::shared_ptr<IConsoleLine> LobbyMemberLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(\s+(?:(?:Member)|(Pending))\[(\d+)\] (\[.*\])\s+team = (\w+)\s+type = (\w+))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(\s+(?:(?:Member)|(Pending))\[(\d+)\] (\[.*\])\s+team = (\w+)\s+type = (\w+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		LobbyMember member{};
 		member.m_Pending = result[1].matched;
 
-		if (!mh::from_chars(std::string_view(&*result[2].first, result[2].length()), member.m_Index))
+		if (!mh::from_chars(to_string_view(result[2]), member.m_Index))
 			throw std::runtime_error("Failed to parse lobby member regex");
 
-		member.m_SteamID = SteamID(std::string_view(&*result[3].first, result[3].length()));
+		member.m_SteamID = SteamID(to_string_view(result[3]));
 
-		std::string_view teamStr(&*result[4].first, result[4].length());
+		std::string_view teamStr = to_string_view(result[4]);
 
 		if (teamStr == "TF_GC_TEAM_DEFENDERS"sv)
 			member.m_Team = LobbyMemberTeam::Defenders;
@@ -245,7 +250,7 @@ std::shared_ptr<IConsoleLine> LobbyMemberLine::TryParse(const std::string_view&
 		else
 			throw std::runtime_error("Unknown lobby member team");
 
-		std::string_view typeStr(&*result[5].first, result[5].length());
+		std::string_view typeStr = to_string_view(result[5]);
 		if (typeStr == "MATCH_PLAYER"sv)
 			member.m_Type = LobbyMemberType::Player;
 		else if (typeStr == "INVALID_PLAYER"sv)
@@ -253,7 +258,7 @@ std::shared_ptr<IConsoleLine> LobbyMemberLine::TryParse(const std::string_view&
 		else
 			throw std::runtime_error("Unknown lobby member type");
 
-		return std::make_shared<LobbyMemberLine>(timestamp, member);
+		return LobbyMemberLine::Create(timestamp, member);
 	}
 
 	return nullptr;
@@ -281,42 +286,165 @@ IConsoleLine::IConsoleLine(time_point_t timestamp) :
 {
 }
 
-auto IConsoleLine::GetTypeData() -> std::list<ConsoleLineTypeData>&
-{
-	static std::list<ConsoleLineTypeData> s_List;
-	return s_List;
-}
-
-std::shared_ptr<IConsoleLine> IConsoleLine::ParseConsoleLine(const std::string_view& text, time_point_t timestamp)
+namespace
 {
-	auto& list = GetTypeData();
+	// Byte-wise trie over the literal prefixes declared by the console line types. The first
+	// byte goes through a jump table, everything after that through (tiny) per-node edge lists.
+	// Walking a line never looks at more than min(line length, longest prefix) characters, so
+	// the bulk of the console spam gets rejected without a single TryParse call.
+	template<typename T, typename TLess>
+	void InsertSorted(std::vector<T>& values, T value, const TLess& less)
+	{
+		values.insert(std::upper_bound(values.begin(), values.end(), value, less), std::move(value));
+	}
 
-	if ((s_TotalParseCount % 1024) == 0)
+	template<typename T, typename TLess = std::less<T>>
+	class PrefixTrie final
 	{
-		// Periodically re-sort the line types for best performance
-		list.sort([](ConsoleLineTypeData& lhs, ConsoleLineTypeData& rhs)
+	public:
+		void Insert(const std::string_view& prefix, T value)
+		{
+			assert(!prefix.empty());
+
+			uint32_t node = ROOT_NODE;
+			for (char c : prefix)
+				node = FindOrAddChild(node, c);
+
+			InsertSorted(m_Nodes[node].m_Values, std::move(value), TLess{});
+		}
+
+		// Invokes func for the values of every inserted prefix that text starts with, shortest
+		// prefix first (and in TLess order for the same prefix), until func returns true.
+		template<typename TFunc>
+		bool FindMatches(const std::string_view& text, TFunc&& func) const
+		{
+			uint32_t node = ROOT_NODE;
+			for (char c : text)
 			{
-				if (rhs.m_AutoParse != lhs.m_AutoParse)
-					return rhs.m_AutoParse < lhs.m_AutoParse;
+				if (node = FindChild(node, c); node == ROOT_NODE)
+					break;
 
-				// Intentionally reversed, we want descending order
-				return rhs.m_AutoParseSuccessCount < lhs.m_AutoParseSuccessCount;
-			});
+				for (const T& value : m_Nodes[node].m_Values)
+				{
+					if (func(value))
+						return true;
+				}
+			}
+
+			return false;
+		}
+
+	private:
+		// The root is never anyone's child, so it doubles as "no such edge"
+		static constexpr uint32_t ROOT_NODE = 0;
+
+		struct Node
+		{
+			std::vector<std::pair<char, uint32_t>> m_Children;
+			std::vector<T> m_Values;
+		};
+
+		uint32_t FindChild(uint32_t node, char c) const
+		{
+			if (node == ROOT_NODE)
+				return m_RootJumpTable[uint8_t(c)];
+
+			for (const auto& [edge, child] : m_Nodes[node].m_Children)
+			{
+				if (edge == c)
+					return child;
+			}
+
+			return ROOT_NODE;
+		}
+
+		uint32_t FindOrAddChild(uint32_t node, char c)
+		{
+			if (auto child = FindChild(node, c); child != ROOT_NODE)
+				return child;
+
+			const auto child = uint32_t(m_Nodes.size());
+			m_Nodes.emplace_back();
+
+			if (node == ROOT_NODE)
+				m_RootJumpTable[uint8_t(c)] = child;
+			else
+				m_Nodes[node].m_Children.emplace_back(c, child);
+
+			return child;
+		}
+
+		std::array<uint32_t, 256> m_RootJumpTable{};
+		std::vector<Node> m_Nodes = std::vector<Node>(1);
+	};
+
+	// Line types register themselves during static initialization, in no particular order,
+	// so anything that decides which type gets first shot at a line goes by ConsoleLineType
+	struct TypeDataLess
+	{
+		template<typename T>
+		bool operator()(const T* lhs, const T* rhs) const { return lhs->m_Type < rhs->m_Type; }
+	};
+
+	bool ContainsAny(const std::string_view& text, const std::span<const std::string_view>& anchors)
+	{
+		return std::any_of(anchors.begin(), anchors.end(),
+			[&](const std::string_view& anchor) { return text.find(anchor) != text.npos; });
 	}
+}
+
+struct IConsoleLine::TypeRegistry
+{
+	std::shared_mutex m_Mutex;
+
+	std::list<ConsoleLineTypeData> m_Types; // Owns the data, never reallocates
+	PrefixTrie<ConsoleLineTypeData*, TypeDataLess> m_PrefixTrie;
+	std::vector<ConsoleLineTypeData*> m_AnchoredTypes;
+	std::vector<ConsoleLineTypeData*> m_UnroutedTypes;
+};
+
+auto IConsoleLine::GetTypeRegistry() -> TypeRegistry&
+{
+	static TypeRegistry s_Registry;
+	return s_Registry;
+}
+
+std::shared_ptr<IConsoleLine> IConsoleLine::ParseConsoleLine(const std::string_view& text, time_point_t timestamp,
+	const ConsoleLineTypeMask& types)
+{
+	if (types.empty())
+		return nullptr;
 
-	s_TotalParseCount++;
+	auto& registry = GetTypeRegistry();
 
-	for (auto& data : list)
+	// Lines may be parsed from several threads at once
+	std::shared_lock lock(registry.m_Mutex);
+
+	std::shared_ptr<IConsoleLine> parsed;
+	const auto TryParse = [&](ConsoleLineTypeData* data)
 	{
-		if (!data.m_AutoParse)
-			continue;
+		if (!types.Contains(data->m_Type))
+			return false;
 
-		auto parsed = data.m_TryParseFunc(text, timestamp);
-		if (!parsed)
-			continue;
+		const auto startTime = std::chrono::steady_clock::now();
+		parsed = data->m_TryParseFunc(text, timestamp);
+		RecordParseStats(*data, text.size(), std::chrono::steady_clock::now() - startTime, !!parsed);
+		return !!parsed;
+	};
 
-		data.m_AutoParseSuccessCount++;
+	if (registry.m_PrefixTrie.FindMatches(text, TryParse))
 		return parsed;
+
+	for (ConsoleLineTypeData* data : registry.m_AnchoredTypes)
+	{
+		if (types.Contains(data->m_Type) && ContainsAny(text, data->m_Anchors) && TryParse(data))
+			return parsed;
+	}
+
+	for (ConsoleLineTypeData* data : registry.m_UnroutedTypes)
+	{
+		if (TryParse(data))
+			return parsed;
 	}
 
 	//if (auto chatLine = ChatConsoleLine::TryParse(text, timestamp))
@@ -326,27 +454,124 @@ std::shared_ptr<IConsoleLine> IConsoleLine::ParseConsoleLine(const std::string_v
 	//return std::make_shared<GenericConsoleLine>(timestamp, std::string(text));
 }
 
-void IConsoleLine::AddTypeData(ConsoleLineTypeData data)
+auto IConsoleLine::AddTypeData(ConsoleLineTypeData data) -> ConsoleLineTypeData*
+{
+	auto& registry = GetTypeRegistry();
+	std::unique_lock lock(registry.m_Mutex);
+
+	ConsoleLineTypeData* added = &registry.m_Types.emplace_back(std::move(data));
+
+	// "class tf2_bot_detector::PingLine" -> "PingLine"
+	std::string_view typeName = added->m_TypeInfo->name();
+	if (auto lastSeparator = typeName.find_last_of(": "); lastSeparator != typeName.npos)
+		typeName.remove_prefix(lastSeparator + 1);
+
+	added->m_Stats.m_TypeName = typeName;
+
+	if (!added->m_AutoParse)
+		return added;
+
+	if (!added->m_Prefixes.empty())
+	{
+		for (const auto& prefix : added->m_Prefixes)
+			registry.m_PrefixTrie.Insert(prefix, added);
+	}
+	else if (!added->m_Anchors.empty())
+	{
+		InsertSorted(registry.m_AnchoredTypes, added, TypeDataLess{});
+	}
+	else
+	{
+		InsertSorted(registry.m_UnroutedTypes, added, TypeDataLess{});
+	}
+
+	return added;
+}
+
+void IConsoleLine::RecordParseStats(ConsoleLineTypeData& data, size_t bytesExamined,
+	std::chrono::nanoseconds elapsed, bool hit)
+{
+	auto& stats = data.m_Stats;
+	const auto ns = uint64_t(elapsed.count());
+
+	std::atomic_ref(stats.m_Attempts).fetch_add(1, std::memory_order_relaxed);
+	if (hit)
+		std::atomic_ref(stats.m_Hits).fetch_add(1, std::memory_order_relaxed);
+
+	std::atomic_ref(stats.m_TotalNanoseconds).fetch_add(ns, std::memory_order_relaxed);
+	std::atomic_ref(stats.m_BytesExamined).fetch_add(bytesExamined, std::memory_order_relaxed);
+
+	std::atomic_ref maxNanoseconds(stats.m_MaxNanoseconds);
+	auto prevMax = maxNanoseconds.load(std::memory_order_relaxed);
+	while (prevMax < ns && !maxNanoseconds.compare_exchange_weak(prevMax, ns, std::memory_order_relaxed))
+		;
+}
+
+std::vector<ConsoleLineParserStats> IConsoleLine::GetParserStats()
 {
-	GetTypeData().push_back(std::move(data));
+	auto& registry = GetTypeRegistry();
+	std::shared_lock lock(registry.m_Mutex);
+
+	std::vector<ConsoleLineParserStats> retVal;
+	retVal.reserve(registry.m_Types.size());
+
+	for (ConsoleLineTypeData& data : registry.m_Types)
+	{
+		auto& stats = data.m_Stats;
+		retVal.push_back(ConsoleLineParserStats
+			{
+				.m_TypeName = stats.m_TypeName,
+				.m_Attempts = std::atomic_ref(stats.m_Attempts).load(std::memory_order_relaxed),
+				.m_Hits = std::atomic_ref(stats.m_Hits).load(std::memory_order_relaxed),
+				.m_TotalNanoseconds = std::atomic_ref(stats.m_TotalNanoseconds).load(std::memory_order_relaxed),
+				.m_MaxNanoseconds = std::atomic_ref(stats.m_MaxNanoseconds).load(std::memory_order_relaxed),
+				.m_BytesExamined = std::atomic_ref(stats.m_BytesExamined).load(std::memory_order_relaxed),
+			});
+	}
+
+	return retVal;
 }
 
-ServerStatusPlayerLine::ServerStatusPlayerLine(time_point_t timestamp, PlayerStatus playerStatus) :
-	BaseClass(timestamp), m_PlayerStatus(std::move(playerStatus))
+void IConsoleLine::ResetParserStats()
 {
+	auto& registry = GetTypeRegistry();
+	std::shared_lock lock(registry.m_Mutex);
+
+	for (ConsoleLineTypeData& data : registry.m_Types)
+	{
+		auto& stats = data.m_Stats;
+		std::atomic_ref(stats.m_Attempts).store(0, std::memory_order_relaxed);
+		std::atomic_ref(stats.m_Hits).store(0, std::memory_order_relaxed);
+		std::atomic_ref(stats.m_TotalNanoseconds).store(0, std::memory_order_relaxed);
+		std::atomic_ref(stats.m_MaxNanoseconds).store(0, std::memory_order_relaxed);
+		std::atomic_ref(stats.m_BytesExamined).store(0, std::memory_order_relaxed);
+	}
+}
+
+ServerStatusPlayerLine::ServerStatusPlayerLine(time_point_t timestamp, std::string_view name,
+	std::string_view address, PlayerStatus playerStatus) :
+	BaseClass(timestamp), m_Name(name), m_Address(address), m_PlayerStatus(std::move(playerStatus))
+{
+}
+
+PlayerStatus ServerStatusPlayerLine::GetPlayerStatus() const
+{
+	PlayerStatus status = m_PlayerStatus;
+	status.m_Name = m_Name;
+	status.m_Address = m_Address;
+	return status;
 }
 
 std::shared_ptr<IConsoleLine> ServerStatusPlayerLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(#\s+(\d+)\s+"((?:.|[\r\n])+)"\s+(\[.*\])\s+(?:(\d+):)?(\d+):(\d+)\s+(\d+)\s+(\d+)\s+(\w+)(?:\s+(\S+))?)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(#\s+(\d+)\s+"((?:.|[\r\n])+)"\s+(\[.*\])\s+(?:(\d+):)?(\d+):(\d+)\s+(\d+)\s+(\d+)\s+(\w+)(?:\s+(\S+))?)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		PlayerStatus status{};
 
 		from_chars_throw(result[1], status.m_UserID);
-		status.m_Name = result[2].str();
-		status.m_SteamID = SteamID(std::string_view(&*result[3].first, result[3].length()));
+		status.m_SteamID = SteamID(to_string_view(result[3]));
 
 		// Connected time
 		{
@@ -368,7 +593,7 @@ std::shared_ptr<IConsoleLine> ServerStatusPlayerLine::TryParse(const std::string
 
 		// State
 		{
-			const auto state = std::string_view(&*result[9].first, result[9].length());
+			const auto state = to_string_view(result[9]);
 			if (state == "active"sv)
 				status.m_State = PlayerStatusState::Active;
 			else if (state == "spawning"sv)
@@ -381,9 +606,7 @@ std::shared_ptr<IConsoleLine> ServerStatusPlayerLine::TryParse(const std::string
 				throw std::runtime_error("Unknown player status state "s << std::quoted(state));
 		}
 
-		status.m_Address = result[10].str();
-
-		return std::make_shared<ServerStatusPlayerLine>(timestamp, std::move(status));
+		return ServerStatusPlayerLine::Create(timestamp, result[2].view(), result[10].view(), std::move(status));
 	}
 
 	return nullptr;
@@ -392,18 +615,18 @@ std::shared_ptr<IConsoleLine> ServerStatusPlayerLine::TryParse(const std::string
 void ServerStatusPlayerLine::Print(const PrintArgs& args) const
 {
 	const PlayerStatus& s = m_PlayerStatus;
-	ImGui::Text("# %6u \"%-19s\" %-19s %4u %4u",
+	ImGui::TextFmt("# {:6} \"{:<19}\" {:<19} {:4} {:4}",
 		s.m_UserID,
-		s.m_Name.c_str(),
-		s.m_SteamID.str().c_str(),
+		m_Name,
+		s.m_SteamID.str(),
 		s.m_Ping,
-		s.m_Loss);
+		+s.m_Loss);
 }
 
 std::shared_ptr<IConsoleLine> ClientReachedServerSpawnLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "Client reached server_spawn."sv)
-		return std::make_shared<ClientReachedServerSpawnLine>(timestamp);
+		return ClientReachedServerSpawnLine::Create(timestamp);
 
 	return nullptr;
 }
@@ -413,21 +636,21 @@ void ClientReachedServerSpawnLine::Print(const PrintArgs& args) const
 	ImGui::TextFmt("Client reached server_spawn.");
 }
 
-KillNotificationLine::KillNotificationLine(time_point_t timestamp, std::string attackerName,
-	std::string victimName, std::string weaponName, bool wasCrit) :
-	BaseClass(timestamp), m_AttackerName(std::move(attackerName)), m_VictimName(std::move(victimName)),
-	m_WeaponName(std::move(weaponName)), m_WasCrit(wasCrit)
+KillNotificationLine::KillNotificationLine(time_point_t timestamp, std::string_view attackerName,
+	std::string_view victimName, std::string_view weaponName, bool wasCrit) :
+	BaseClass(timestamp), m_AttackerName(attackerName), m_VictimName(victimName),
+	m_WeaponName(weaponName), m_WasCrit(wasCrit)
 {
 }
 
 std::shared_ptr<IConsoleLine> KillNotificationLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex((.*) killed (.*) with (.*)\.( \(crit\))?)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex((.*) killed (.*) with (.*)\.( \(crit\))?)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
-		return std::make_shared<KillNotificationLine>(timestamp, result[1].str(),
-			result[2].str(), result[3].str(), result[4].matched);
+		return KillNotificationLine::Create(timestamp, result[1],
+			result[2], result[3], result[4].matched);
 	}
 
 	return nullptr;
@@ -435,8 +658,8 @@ std::shared_ptr<IConsoleLine> KillNotificationLine::TryParse(const std::string_v
 
 void KillNotificationLine::Print(const PrintArgs& args) const
 {
-	ImGui::TextFmt("{} killed {} with {}.{}", m_AttackerName.c_str(),
-		m_VictimName.c_str(), m_WeaponName.c_str(), m_WasCrit ? " (crit)" : "");
+	ImGui::TextFmt("{} killed {} with {}.{}", m_AttackerName,
+		m_VictimName, m_WeaponName, m_WasCrit ? " (crit)" : "");
 }
 
 LobbyChangedLine::LobbyChangedLine(time_point_t timestamp, LobbyChangeType type) :
@@ -447,11 +670,11 @@ LobbyChangedLine::LobbyChangedLine(time_point_t timestamp, LobbyChangeType type)
 std::shared_ptr<IConsoleLine> LobbyChangedLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "Lobby created"sv)
-		return std::make_shared<LobbyChangedLine>(timestamp, LobbyChangeType::Created);
+		return LobbyChangedLine::Create(timestamp, LobbyChangeType::Created);
 	else if (text == "Lobby updated"sv)
-		return std::make_shared<LobbyChangedLine>(timestamp, LobbyChangeType::Updated);
+		return LobbyChangedLine::Create(timestamp, LobbyChangeType::Updated);
 	else if (text == "Lobby destroyed"sv)
-		return std::make_shared<LobbyChangedLine>(timestamp, LobbyChangeType::Destroyed);
+		return LobbyChangedLine::Create(timestamp, LobbyChangeType::Destroyed);
 
 	return nullptr;
 }
@@ -467,21 +690,31 @@ void LobbyChangedLine::Print(const PrintArgs& args) const
 		ImGui::Separator();
 }
 
-CvarlistConvarLine::CvarlistConvarLine(time_point_t timestamp, std::string name, float value,
-	std::string flagsList, std::string helpText) :
-	BaseClass(timestamp), m_Name(std::move(name)), m_Value(value),
-	m_FlagsList(std::move(flagsList)), m_HelpText(std::move(helpText))
+CvarlistConvarLine::CvarlistConvarLine(time_point_t timestamp, std::string_view name, float value,
+	std::string_view flagsList, std::string_view helpText) :
+	BaseClass(timestamp), m_Name(name), m_Value(value),
+	m_FlagsList(flagsList), m_HelpText(helpText)
 {
 }
 
 std::shared_ptr<IConsoleLine> CvarlistConvarLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex((\S+)\s+:\s+([-\d.]+)\s+:\s+(.+)?\s+:[\t ]+(.+)?)regex", std::regex::optimize);
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	// Plenty of lines have a colon in them, but only cvarlist pads its columns on both sides.
+	// Checking for that is a lot cheaper than running the regex on every one of them.
+	const auto IsPadding = [](char c) { return c == ' ' || c == '\t'; };
+	const auto colon = text.find(':');
+	if (colon == 0 || colon == text.npos || colon + 1 == text.size() ||
+		!IsPadding(text[colon - 1]) || !IsPadding(text[colon + 1]))
+	{
+		return nullptr;
+	}
+
+	static constexpr ct_regex<R"regex((\S+)\s+:\s+([-\d.]+)\s+:\s+(.+)?\s+:[\t ]+(.+)?)regex"> s_Regex;
+	if (auto result = s_Regex.match(text))
 	{
 		float value;
 		from_chars_throw(result[2], value);
-		return std::make_shared<CvarlistConvarLine>(timestamp, result[1].str(), value, result[3].str(), result[4].str());
+		return CvarlistConvarLine::Create(timestamp, result[1], value, result[3], result[4]);
 	}
 
 	return nullptr;
@@ -493,24 +726,23 @@ void CvarlistConvarLine::Print(const PrintArgs& args) const
 	//ImGui::Text("\"%s\" = \"%s\"", m_Name.c_str(), m_ConvarValue.c_str());
 }
 
-ServerStatusShortPlayerLine::ServerStatusShortPlayerLine(time_point_t timestamp, PlayerStatusShort playerStatus) :
-	BaseClass(timestamp), m_PlayerStatus(std::move(playerStatus))
+ServerStatusShortPlayerLine::ServerStatusShortPlayerLine(time_point_t timestamp, uint8_t clientIndex,
+	std::string_view name) :
+	BaseClass(timestamp), m_Name(name), m_ClientIndex(clientIndex)
 {
 }
 
 std::shared_ptr<IConsoleLine> ServerStatusShortPlayerLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(#(\d+) - (.+))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(#(\d+) - (.+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
-		PlayerStatusShort status{};
-
-		from_chars_throw(result[1], status.m_ClientIndex);
-		assert(status.m_ClientIndex >= 1);
-		status.m_Name = result[2].str();
+		uint8_t clientIndex;
+		from_chars_throw(result[1], clientIndex);
+		assert(clientIndex >= 1);
 
-		return std::make_shared<ServerStatusShortPlayerLine>(timestamp, std::move(status));
+		return ServerStatusShortPlayerLine::Create(timestamp, clientIndex, result[2].view());
 	}
 
 	return nullptr;
@@ -518,7 +750,7 @@ std::shared_ptr<IConsoleLine> ServerStatusShortPlayerLine::TryParse(const std::s
 
 void ServerStatusShortPlayerLine::Print(const PrintArgs& args) const
 {
-	ImGui::Text("#%u - %s", m_PlayerStatus.m_ClientIndex, m_PlayerStatus.m_Name.c_str());
+	ImGui::TextFmt("#{} - {}", +m_ClientIndex, m_Name);
 }
 
 VoiceReceiveLine::VoiceReceiveLine(time_point_t timestamp, uint8_t channel,
@@ -529,9 +761,9 @@ VoiceReceiveLine::VoiceReceiveLine(time_point_t timestamp, uint8_t channel,
 
 std::shared_ptr<IConsoleLine> VoiceReceiveLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(Voice - chan (\d+), ent (\d+), bufsize: (\d+))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(Voice - chan (\d+), ent (\d+), bufsize: (\d+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint8_t channel;
 		from_chars_throw(result[1], channel);
@@ -542,7 +774,7 @@ std::shared_ptr<IConsoleLine> VoiceReceiveLine::TryParse(const std::string_view&
 		uint16_t bufSize;
 		from_chars_throw(result[3], bufSize);
 
-		return std::make_shared<VoiceReceiveLine>(timestamp, channel, entindex, bufSize);
+		return VoiceReceiveLine::Create(timestamp, channel, entindex, bufSize);
 	}
 
 	return nullptr;
@@ -561,15 +793,15 @@ ServerStatusPlayerCountLine::ServerStatusPlayerCountLine(time_point_t timestamp,
 
 std::shared_ptr<IConsoleLine> ServerStatusPlayerCountLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(players : (\d+) humans, (\d+) bots \((\d+) max\))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(players : (\d+) humans, (\d+) bots \((\d+) max\))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint8_t playerCount, botCount, maxPlayers;
 		from_chars_throw(result[1], playerCount);
 		from_chars_throw(result[2], botCount);
 		from_chars_throw(result[3], maxPlayers);
-		return std::make_shared<ServerStatusPlayerCountLine>(timestamp, playerCount, botCount, maxPlayers);
+		return ServerStatusPlayerCountLine::Create(timestamp, playerCount, botCount, maxPlayers);
 	}
 
 	return nullptr;
@@ -587,14 +819,14 @@ EdictUsageLine::EdictUsageLine(time_point_t timestamp, uint16_t usedEdicts, uint
 
 std::shared_ptr<IConsoleLine> EdictUsageLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(edicts  : (\d+) used of (\d+) max)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(edicts  : (\d+) used of (\d+) max)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint16_t usedEdicts, totalEdicts;
 		from_chars_throw(result[1], usedEdicts);
 		from_chars_throw(result[2], totalEdicts);
-		return std::make_shared<EdictUsageLine>(timestamp, usedEdicts, totalEdicts);
+		return EdictUsageLine::Create(timestamp, usedEdicts, totalEdicts);
 	}
 
 	return nullptr;
@@ -605,20 +837,20 @@ void EdictUsageLine::Print(const PrintArgs& args) const
 	ImGui::TextFmt("edicts  : {} used of {} max", m_UsedEdicts, m_TotalEdicts);
 }
 
-PingLine::PingLine(time_point_t timestamp, uint16_t ping, std::string playerName) :
-	BaseClass(timestamp), m_Ping(ping), m_PlayerName(std::move(playerName))
+PingLine::PingLine(time_point_t timestamp, uint16_t ping, std::string_view playerName) :
+	BaseClass(timestamp), m_Ping(ping), m_PlayerName(playerName)
 {
 }
 
 std::shared_ptr<IConsoleLine> PingLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex( *(\d+) ms : (.{1,32}))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex( *(\d+) ms : (.{1,32}))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint16_t ping;
 		from_chars_throw(result[1], ping);
-		return std::make_shared<PingLine>(timestamp, ping, result[2].str());
+		return PingLine::Create(timestamp, ping, result[2]);
 	}
 
 	return nullptr;
@@ -626,26 +858,26 @@ std::shared_ptr<IConsoleLine> PingLine::TryParse(const std::string_view& text, t
 
 void PingLine::Print(const PrintArgs& args) const
 {
-	ImGui::Text("%4u : %s", m_Ping, m_PlayerName.c_str());
+	ImGui::TextFmt("{:4} : {}", m_Ping, m_PlayerName);
 }
 
-SVCUserMessageLine::SVCUserMessageLine(time_point_t timestamp, std::string address, UserMessageType type, uint16_t bytes) :
-	BaseClass(timestamp), m_Address(std::move(address)), m_MsgType(type), m_MsgBytes(bytes)
+SVCUserMessageLine::SVCUserMessageLine(time_point_t timestamp, std::string_view address, UserMessageType type, uint16_t bytes) :
+	BaseClass(timestamp), m_Address(address), m_MsgType(type), m_MsgBytes(bytes)
 {
 }
 
 std::shared_ptr<IConsoleLine> SVCUserMessageLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(Msg from ((?:\d+\.\d+\.\d+\.\d+:\d+)|loopback): svc_UserMessage: type (\d+), bytes (\d+))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(Msg from ((?:\d+\.\d+\.\d+\.\d+:\d+)|loopback): svc_UserMessage: type (\d+), bytes (\d+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint16_t type, bytes;
 		from_chars_throw(result[2], type);
 
 		from_chars_throw(result[3], bytes);
 
-		return std::make_shared<SVCUserMessageLine>(timestamp, result[1].str(), UserMessageType(type), bytes);
+		return SVCUserMessageLine::Create(timestamp, result[1], UserMessageType(type), bytes);
 	}
 
 	return nullptr;
@@ -681,7 +913,7 @@ void SVCUserMessageLine::Print(const PrintArgs& args) const
 std::shared_ptr<IConsoleLine> LobbyStatusFailedLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "Failed to find lobby shared object"sv)
-		return std::make_shared<LobbyStatusFailedLine>(timestamp);
+		return LobbyStatusFailedLine::Create(timestamp);
 
 	return nullptr;
 }
@@ -691,8 +923,8 @@ void LobbyStatusFailedLine::Print(const PrintArgs& args) const
 	ImGui::Text("Failed to find lobby shared object");
 }
 
-ConfigExecLine::ConfigExecLine(time_point_t timestamp, std::string configFileName, bool success) :
-	BaseClass(timestamp), m_ConfigFileName(std::move(configFileName)), m_Success(success)
+ConfigExecLine::ConfigExecLine(time_point_t timestamp, std::string_view configFileName, bool success) :
+	BaseClass(timestamp), m_ConfigFileName(configFileName), m_Success(success)
 {
 }
 
@@ -701,12 +933,12 @@ std::shared_ptr<IConsoleLine> ConfigExecLine::TryParse(const std::string_view& t
 	// Success
 	constexpr auto prefix = "execing "sv;
 	if (text.starts_with(prefix))
-		return std::make_shared<ConfigExecLine>(timestamp, std::string(text.substr(prefix.size())), true);
+		return ConfigExecLine::Create(timestamp, text.substr(prefix.size()), true);
 
 	// Failure
-	static const std::regex s_Regex(R"regex('(.*)' not present; not executing\.)regex", std::regex::optimize);
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
-		return std::make_shared<ConfigExecLine>(timestamp, result[1].str(), false);
+	static constexpr ct_regex<R"regex('(.*)' not present; not executing\.)regex"> s_Regex;
+	if (auto result = s_Regex.match(text))
+		return ConfigExecLine::Create(timestamp, result[1], false);
 
 	return nullptr;
 }
@@ -714,29 +946,29 @@ std::shared_ptr<IConsoleLine> ConfigExecLine::TryParse(const std::string_view& t
 void ConfigExecLine::Print(const PrintArgs& args) const
 {
 	if (m_Success)
-		ImGui::Text("execing %s", m_ConfigFileName.c_str());
+		ImGui::TextFmt("execing {}", m_ConfigFileName);
 	else
-		ImGui::Text("'%s' not present; not executing.", m_ConfigFileName.c_str());
+		ImGui::TextFmt("'{}' not present; not executing.", m_ConfigFileName);
 }
 
-ServerStatusMapLine::ServerStatusMapLine(time_point_t timestamp, std::string mapName,
+ServerStatusMapLine::ServerStatusMapLine(time_point_t timestamp, std::string_view mapName,
 	const std::array<float, 3>& position) :
-	BaseClass(timestamp), m_MapName(std::move(mapName)), m_Position(position)
+	BaseClass(timestamp), m_MapName(mapName), m_Position(position)
 {
 }
 
 std::shared_ptr<IConsoleLine> ServerStatusMapLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(map     : (.*) at: ((?:-|\d)+) x, ((?:-|\d)+) y, ((?:-|\d)+) z)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(map     : (.*) at: ((?:-|\d)+) x, ((?:-|\d)+) y, ((?:-|\d)+) z)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		std::array<float, 3> pos{};
 		from_chars_throw(result[2], pos[0]);
 		from_chars_throw(result[3], pos[1]);
 		from_chars_throw(result[4], pos[2]);
 
-		return std::make_shared<ServerStatusMapLine>(timestamp, result[1].str(), pos);
+		return ServerStatusMapLine::Create(timestamp, result[1], pos);
 	}
 
 	return nullptr;
@@ -744,14 +976,14 @@ std::shared_ptr<IConsoleLine> ServerStatusMapLine::TryParse(const std::string_vi
 
 void ServerStatusMapLine::Print(const PrintArgs& args) const
 {
-	ImGui::Text("map     : %s at: %1.0f x, %1.0f y, %1.0f z", m_MapName.c_str(),
+	ImGui::TextFmt("map     : {} at: {:1.0f} x, {:1.0f} y, {:1.0f} z", m_MapName,
 		m_Position[0], m_Position[1], m_Position[2]);
 }
 
 std::shared_ptr<IConsoleLine> TeamsSwitchedLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "Teams have been switched."sv)
-		return std::make_unique<TeamsSwitchedLine>(timestamp);
+		return TeamsSwitchedLine::Create(timestamp);
 
 	return nullptr;
 }
@@ -770,23 +1002,23 @@ void TeamsSwitchedLine::Print(const PrintArgs& args) const
 	ImGui::TextFmt({ 0.98f, 0.73f, 0.01f, 1 }, "Teams have been switched.");
 }
 
-ConnectingLine::ConnectingLine(time_point_t timestamp, std::string address, bool isMatchmaking, bool isRetrying) :
-	BaseClass(timestamp), m_Address(std::move(address)), m_IsMatchmaking(isMatchmaking), m_IsRetrying(isRetrying)
+ConnectingLine::ConnectingLine(time_point_t timestamp, std::string_view address, bool isMatchmaking, bool isRetrying) :
+	BaseClass(timestamp), m_Address(address), m_IsMatchmaking(isMatchmaking), m_IsRetrying(isRetrying)
 {
 }
 
 std::shared_ptr<IConsoleLine> ConnectingLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	{
-		static const std::regex s_ConnectingRegex(R"regex(Connecting to( matchmaking server)? (.*?)(\.\.\.)?)regex", std::regex::optimize);
-		if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_ConnectingRegex))
-			return std::make_shared<ConnectingLine>(timestamp, result[2].str(), result[1].matched, false);
+		static constexpr ct_regex<R"regex(Connecting to( matchmaking server)? (.*?)(\.\.\.)?)regex"> s_ConnectingRegex;
+		if (auto result = s_ConnectingRegex.match(text))
+			return ConnectingLine::Create(timestamp, result[2], result[1].matched, false);
 	}
 
 	{
-		static const std::regex s_RetryingRegex(R"regex(Retrying (.*)\.\.\.)regex", std::regex::optimize);
-		if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_RetryingRegex))
-			return std::make_shared<ConnectingLine>(timestamp, result[1].str(), false, true);
+		static constexpr ct_regex<R"regex(Retrying (.*)\.\.\.)regex"> s_RetryingRegex;
+		if (auto result = s_RetryingRegex.match(text))
+			return ConnectingLine::Create(timestamp, result[1], false, true);
 	}
 
 	return nullptr;
@@ -805,7 +1037,7 @@ void ConnectingLine::Print(const PrintArgs& args) const
 std::shared_ptr<IConsoleLine> HostNewGameLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "---- Host_NewGame ----"sv)
-		return std::make_shared<HostNewGameLine>(timestamp);
+		return HostNewGameLine::Create(timestamp);
 
 	return nullptr;
 }
@@ -822,8 +1054,8 @@ PartyHeaderLine::PartyHeaderLine(time_point_t timestamp, TFParty party) :
 
 std::shared_ptr<IConsoleLine> PartyHeaderLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(TFParty:\s+ID:([0-9a-f]+)\s+(\d+) member\(s\)\s+LeaderID: (\[.*\]))regex", std::regex::optimize);
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	static constexpr ct_regex<R"regex(TFParty:\s+ID:([0-9a-f]+)\s+(\d+) member\(s\)\s+LeaderID: (\[.*\]))regex"> s_Regex;
+	if (auto result = s_Regex.match(text))
 	{
 		TFParty party{};
 
@@ -837,7 +1069,7 @@ std::shared_ptr<IConsoleLine> PartyHeaderLine::TryParse(const std::string_view&
 
 		party.m_LeaderID = SteamID(result[3].str());
 
-		return std::make_shared<PartyHeaderLine>(timestamp, std::move(party));
+		return PartyHeaderLine::Create(timestamp, std::move(party));
 	}
 
 	return nullptr;
@@ -852,7 +1084,7 @@ void PartyHeaderLine::Print(const PrintArgs& args) const
 std::shared_ptr<IConsoleLine> GameQuitLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
 	if (text == "CTFGCClientSystem::ShutdownGC"sv)
-		return std::make_shared<GameQuitLine>(timestamp);
+		return GameQuitLine::Create(timestamp);
 
 	return nullptr;
 }
@@ -896,7 +1128,7 @@ std::shared_ptr<IConsoleLine> QueueStateChangeLine::TryParse(const std::string_v
 	for (const auto& match : QUEUE_STATE_CHANGE_TYPES)
 	{
 		if (text == match.m_String)
-			return std::make_shared<QueueStateChangeLine>(timestamp, match.m_QueueType, match.m_StateChange);
+			return QueueStateChangeLine::Create(timestamp, match.m_QueueType, match.m_StateChange);
 	}
 
 	return nullptr;
@@ -922,11 +1154,10 @@ InQueueLine::InQueueLine(time_point_t timestamp, TFMatchGroup queueType, time_po
 
 std::shared_ptr<IConsoleLine> InQueueLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(
-		R"regex(    MatchGroup: (\d+)\s+Started matchmaking:\s+(.*)\s+\(\d+ seconds ago, now is (.*)\))regex",
-		std::regex::optimize);
+	static constexpr ct_regex<
+		R"regex(    MatchGroup: (\d+)\s+Started matchmaking:\s+(.*)\s+\(\d+ seconds ago, now is (.*)\))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		TFMatchGroup matchGroup = TFMatchGroup::Invalid;
 		{
@@ -952,7 +1183,7 @@ std::shared_ptr<IConsoleLine> InQueueLine::TryParse(const std::string_view& text
 			}
 		}
 
-		return std::make_shared<InQueueLine>(timestamp, matchGroup, startTime);
+		return InQueueLine::Create(timestamp, matchGroup, startTime);
 	}
 
 	return nullptr;
@@ -974,20 +1205,19 @@ void InQueueLine::Print(const PrintArgs& args) const
 		uint32_t(m_QueueType), timeBufThen, seconds, timeBufNow);
 }
 
-ServerJoinLine::ServerJoinLine(time_point_t timestamp, std::string hostName, std::string mapName,
+ServerJoinLine::ServerJoinLine(time_point_t timestamp, std::string_view hostName, std::string_view mapName,
 	uint8_t playerCount, uint8_t playerMaxCount, uint32_t buildNumber, uint32_t serverNumber) :
-	BaseClass(timestamp), m_HostName(std::move(hostName)), m_MapName(std::move(mapName)), m_PlayerCount(playerCount),
+	BaseClass(timestamp), m_HostName(hostName), m_MapName(mapName), m_PlayerCount(playerCount),
 	m_PlayerMaxCount(playerMaxCount), m_BuildNumber(buildNumber), m_ServerNumber(serverNumber)
 {
 }
 
 std::shared_ptr<IConsoleLine> ServerJoinLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(
-		R"regex(\n(.*)\nMap: (.*)\nPlayers: (\d+) \/ (\d+)\nBuild: (\d+)\nServer Number: (\d+)\s+)regex",
-		std::regex::optimize);
+	static constexpr ct_regex<
+		R"regex(\n(.*)\nMap: (.*)\nPlayers: (\d+) \/ (\d+)\nBuild: (\d+)\nServer Number: (\d+)\s+)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		uint32_t buildNumber, serverNumber;
 		from_chars_throw(result[5], buildNumber);
@@ -997,7 +1227,7 @@ std::shared_ptr<IConsoleLine> ServerJoinLine::TryParse(const std::string_view& t
 		from_chars_throw(result[3], playerCount);
 		from_chars_throw(result[4], playerMaxCount);
 
-		return std::make_shared<ServerJoinLine>(timestamp, result[1].str(), result[2].str(),
+		return ServerJoinLine::Create(timestamp, result[1], result[2],
 			playerCount, playerMaxCount, buildNumber, serverNumber);
 	}
 
@@ -1010,18 +1240,18 @@ void ServerJoinLine::Print(const PrintArgs& args) const
 		m_HostName, m_MapName, m_PlayerCount, m_PlayerMaxCount, m_BuildNumber, m_ServerNumber);
 }
 
-ServerDroppedPlayerLine::ServerDroppedPlayerLine(time_point_t timestamp, std::string playerName, std::string reason) :
-	BaseClass(timestamp), m_PlayerName(std::move(playerName)), m_Reason(std::move(reason))
+ServerDroppedPlayerLine::ServerDroppedPlayerLine(time_point_t timestamp, std::string_view playerName, std::string_view reason) :
+	BaseClass(timestamp), m_PlayerName(playerName), m_Reason(reason)
 {
 }
 
 std::shared_ptr<IConsoleLine> ServerDroppedPlayerLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(Dropped (.*) from server \((.*)\))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(Dropped (.*) from server \((.*)\))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
-		return std::make_shared<ServerDroppedPlayerLine>(timestamp, result[1].str(), result[2].str());
+		return ServerDroppedPlayerLine::Create(timestamp, result[1], result[2]);
 	}
 
 	return nullptr;
@@ -1032,17 +1262,17 @@ void ServerDroppedPlayerLine::Print(const PrintArgs& args) const
 	ImGui::TextFmt("Dropped {} from server ({})", m_PlayerName, m_Reason);
 }
 
-ServerStatusPlayerIPLine::ServerStatusPlayerIPLine(time_point_t timestamp, std::string localIP, std::string publicIP) :
-	BaseClass(timestamp), m_LocalIP(std::move(localIP)), m_PublicIP(std::move(publicIP))
+ServerStatusPlayerIPLine::ServerStatusPlayerIPLine(time_point_t timestamp, std::string_view localIP, std::string_view publicIP) :
+	BaseClass(timestamp), m_LocalIP(localIP), m_PublicIP(publicIP)
 {
 }
 
 std::shared_ptr<IConsoleLine> ServerStatusPlayerIPLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(udp\/ip  : (.*)  \(public ip: (.*)\))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(udp\/ip  : (.*)  \(public ip: (.*)\))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
-		return std::make_shared<ServerStatusPlayerIPLine>(timestamp, result[1].str(), result[2].str());
+	if (auto result = s_Regex.match(text))
+		return ServerStatusPlayerIPLine::Create(timestamp, result[1], result[2]);
 
 	return nullptr;
 }
@@ -1062,11 +1292,10 @@ DifferingLobbyReceivedLine::DifferingLobbyReceivedLine(time_point_t timestamp, c
 std::shared_ptr<IConsoleLine> DifferingLobbyReceivedLine::TryParse(
 	const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(
-		R"regex(Differing lobby received\. Lobby: (.*)\/Match(\d+)\/Lobby(\d+) CurrentlyAssigned: (.*)\/Match(\d+)\/Lobby(\d+) ConnectedToMatchServer: (\d+) HasLobby: (\d+) AssignedMatchEnded: (\d+))regex",
-		std::regex::optimize);
+	static constexpr ct_regex<
+		R"regex(Differing lobby received\. Lobby: (.*)\/Match(\d+)\/Lobby(\d+) CurrentlyAssigned: (.*)\/Match(\d+)\/Lobby(\d+) ConnectedToMatchServer: (\d+) HasLobby: (\d+) AssignedMatchEnded: (\d+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		Lobby newLobby;
 		newLobby.m_LobbyID = SteamID(result[1].str());
@@ -1083,7 +1312,7 @@ std::shared_ptr<IConsoleLine> DifferingLobbyReceivedLine::TryParse(
 		from_chars_throw(result[8], hasLobby);
 		from_chars_throw(result[9], assignedMatchEnded);
 
-		return std::make_shared<DifferingLobbyReceivedLine>(timestamp, newLobby, currentLobby,
+		return DifferingLobbyReceivedLine::Create(timestamp, newLobby, currentLobby,
 			connectedToMatchServer, hasLobby, assignedMatchEnded);
 	}
 
@@ -23,15 +23,15 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		GenericConsoleLine(time_point_t timestamp, std::string text);
+		GenericConsoleLine(time_point_t timestamp, std::string_view text);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::Generic; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::Generic;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
-		std::string m_Text;
+		std::string_view m_Text;
 	};
 
 	class ChatConsoleLine final : public ConsoleLineBase<ChatConsoleLine, false>
@@ -39,16 +39,16 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ChatConsoleLine(time_point_t timestamp, std::string playerName, std::string message, bool isDead,
+		ChatConsoleLine(time_point_t timestamp, std::string_view playerName, std::string_view message, bool isDead,
 			bool isTeam, bool isSelf, TeamShareResult teamShare);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
 		//static std::shared_ptr<ChatConsoleLine> TryParseFlexible(const std::string_view& text, time_point_t timestamp);
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::Chat; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::Chat;
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetPlayerName() const { return m_PlayerName; }
-		const std::string& GetMessage() const { return m_Message; }
+		std::string_view GetPlayerName() const { return m_PlayerName; }
+		std::string_view GetMessage() const { return m_Message; }
 		bool IsDead() const { return m_IsDead; }
 		bool IsTeam() const { return m_IsTeam; }
 		bool IsSelf() const { return m_IsSelf; }
@@ -57,8 +57,8 @@ namespace tf2_bot_detector
 	private:
 		//static std::shared_ptr<ChatConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp, bool flexible);
 
-		std::string m_PlayerName;
-		std::string m_Message;
+		std::string_view m_PlayerName;
+		std::string_view m_Message;
 		TeamShareResult m_TeamShareResult;
 		bool m_IsDead : 1;
 		bool m_IsTeam : 1;
@@ -72,8 +72,9 @@ namespace tf2_bot_detector
 	public:
 		using ConsoleLineBase::ConsoleLineBase;
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Failed to find lobby shared object" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::LobbyStatusFailed; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::LobbyStatusFailed;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 	};
@@ -85,10 +86,11 @@ namespace tf2_bot_detector
 	public:
 		PartyHeaderLine(time_point_t timestamp, TFParty party);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "TFParty:" };
 
 		const TFParty& GetParty() const { return m_Party; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PartyHeader; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PartyHeader;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -103,11 +105,12 @@ namespace tf2_bot_detector
 	public:
 		LobbyHeaderLine(time_point_t timestamp, unsigned memberCount, unsigned pendingCount);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "CTFLobbyShared: ID:" };
 
 		auto GetMemberCount() const { return m_MemberCount; }
 		auto GetPendingCount() const { return m_PendingCount; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::LobbyHeader; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::LobbyHeader;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -123,10 +126,11 @@ namespace tf2_bot_detector
 	public:
 		LobbyMemberLine(time_point_t timestamp, const LobbyMember& lobbyMember);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_ANCHORS[] = { "team = " };
 
 		const LobbyMember& GetLobbyMember() const { return m_LobbyMember; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::LobbyMember; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::LobbyMember;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -148,8 +152,9 @@ namespace tf2_bot_detector
 	public:
 		LobbyChangedLine(time_point_t timestamp, LobbyChangeType type);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Lobby created", "Lobby updated", "Lobby destroyed" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::LobbyChanged; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::LobbyChanged;
 		LobbyChangeType GetChangeType() const { return m_ChangeType; }
 		bool ShouldPrint() const override;
 		void Print(const PrintArgs& args) const override;
@@ -173,8 +178,9 @@ namespace tf2_bot_detector
 		DifferingLobbyReceivedLine(time_point_t timestamp, const Lobby& newLobby, const Lobby& currentLobby,
 			bool connectedToMatchServer, bool hasLobby, bool assignedMatchEnded);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Differing lobby received. Lobby: " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::DifferingLobbyReceived; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::DifferingLobbyReceived;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -197,16 +203,22 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerStatusPlayerLine(time_point_t timestamp, PlayerStatus playerStatus);
+		// The name and address in playerStatus are ignored, they're kept in the arena instead.
+		ServerStatusPlayerLine(time_point_t timestamp, std::string_view name, std::string_view address,
+			PlayerStatus playerStatus);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "#" };
 
-		const PlayerStatus& GetPlayerStatus() const { return m_PlayerStatus; }
+		PlayerStatus GetPlayerStatus() const;
+		std::string_view GetPlayerName() const { return m_Name; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PlayerStatus; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PlayerStatus;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
+		std::string_view m_Name;
+		std::string_view m_Address;
 		PlayerStatus m_PlayerStatus;
 	};
 
@@ -215,19 +227,20 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerStatusPlayerIPLine(time_point_t timestamp, std::string localIP, std::string publicIP);
+		ServerStatusPlayerIPLine(time_point_t timestamp, std::string_view localIP, std::string_view publicIP);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "udp/ip  : " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PlayerStatusIP; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PlayerStatusIP;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetLocalIP() const { return m_LocalIP; }
-		const std::string& GetPublicIP() const { return m_PublicIP; }
+		std::string_view GetLocalIP() const { return m_LocalIP; }
+		std::string_view GetPublicIP() const { return m_PublicIP; }
 
 	private:
-		std::string m_LocalIP;
-		std::string m_PublicIP;
+		std::string_view m_LocalIP;
+		std::string_view m_PublicIP;
 	};
 
 	class ServerStatusShortPlayerLine final : public ConsoleLineBase<ServerStatusShortPlayerLine>
@@ -235,17 +248,20 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerStatusShortPlayerLine(time_point_t timestamp, PlayerStatusShort playerStatus);
+		ServerStatusShortPlayerLine(time_point_t timestamp, uint8_t clientIndex, std::string_view name);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "#" };
 
-		const PlayerStatusShort& GetPlayerStatus() const { return m_PlayerStatus; }
+		uint8_t GetClientIndex() const { return m_ClientIndex; }
+		std::string_view GetPlayerName() const { return m_Name; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PlayerStatusShort; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PlayerStatusShort;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
-		PlayerStatusShort m_PlayerStatus;
+		std::string_view m_Name;
+		uint8_t m_ClientIndex;
 	};
 
 	class ServerStatusPlayerCountLine final : public ConsoleLineBase<ServerStatusPlayerCountLine>
@@ -256,12 +272,13 @@ namespace tf2_bot_detector
 		ServerStatusPlayerCountLine(time_point_t timestamp, uint8_t playerCount,
 			uint8_t botCount, uint8_t maxPlayers);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "players : " };
 
 		uint8_t GetPlayerCount() const { return m_PlayerCount; }
 		uint8_t GetBotCount() const { return m_BotCount; }
 		uint8_t GetMaxPlayerCount() const { return m_MaxPlayers; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PlayerStatusCount; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PlayerStatusCount;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -276,18 +293,19 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerStatusMapLine(time_point_t timestamp, std::string mapName, const std::array<float, 3>& position);
+		ServerStatusMapLine(time_point_t timestamp, std::string_view mapName, const std::array<float, 3>& position);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "map     : " };
 
-		const std::string& GetMapName() const { return m_MapName; }
+		std::string_view GetMapName() const { return m_MapName; }
 		const std::array<float, 3>& GetPosition() const { return m_Position; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::PlayerStatusMapPosition; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::PlayerStatusMapPosition;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
-		std::string m_MapName;
+		std::string_view m_MapName;
 		std::array<float, 3> m_Position{};
 	};
 
@@ -298,11 +316,12 @@ namespace tf2_bot_detector
 	public:
 		EdictUsageLine(time_point_t timestamp, uint16_t usedEdicts, uint16_t totalEdicts);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "edicts  : " };
 
 		uint16_t GetUsedEdicts() const { return m_UsedEdicts; }
 		uint16_t GetTotalEdicts() const { return m_TotalEdicts; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::EdictUsage; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::EdictUsage;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -318,8 +337,9 @@ namespace tf2_bot_detector
 	public:
 		using ConsoleLineBase::ConsoleLineBase;
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Client reached server_spawn." };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::ClientReachedServerSpawn; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::ClientReachedServerSpawn;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 	};
@@ -329,23 +349,24 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		KillNotificationLine(time_point_t timestamp, std::string attackerName,
-			std::string victimName, std::string weaponName, bool wasCrit);
+		KillNotificationLine(time_point_t timestamp, std::string_view attackerName,
+			std::string_view victimName, std::string_view weaponName, bool wasCrit);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_ANCHORS[] = { " killed " };
 
-		const std::string& GetVictimName() const { return m_VictimName; }
-		const std::string& GetAttackerName() const { return m_AttackerName; }
-		const std::string& GetWeaponName() const { return m_WeaponName; }
+		std::string_view GetVictimName() const { return m_VictimName; }
+		std::string_view GetAttackerName() const { return m_AttackerName; }
+		std::string_view GetWeaponName() const { return m_WeaponName; }
 		bool WasCrit() const { return m_WasCrit; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::KillNotification; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::KillNotification;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
-		std::string m_AttackerName;
-		std::string m_VictimName;
-		std::string m_WeaponName;
+		std::string_view m_AttackerName;
+		std::string_view m_VictimName;
+		std::string_view m_WeaponName;
 		bool m_WasCrit;
 	};
 
@@ -354,23 +375,24 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		CvarlistConvarLine(time_point_t timestamp, std::string name, float value, std::string flagsList, std::string helpText);
+		CvarlistConvarLine(time_point_t timestamp, std::string_view name, float value, std::string_view flagsList, std::string_view helpText);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_ANCHORS[] = { " : ", "\t:", ":\t" }; // A colon padded on both sides
 
-		const std::string& GetConvarName() const { return m_Name; }
+		std::string_view GetConvarName() const { return m_Name; }
 		float GetConvarValue() const { return m_Value; }
-		const std::string& GetFlagsListString() const { return m_FlagsList; }
-		const std::string& GetHelpText() const { return m_HelpText; }
+		std::string_view GetFlagsListString() const { return m_FlagsList; }
+		std::string_view GetHelpText() const { return m_HelpText; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::CvarlistConvar; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::CvarlistConvar;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 	private:
-		std::string m_Name;
+		std::string_view m_Name;
 		float m_Value;
-		std::string m_FlagsList;
-		std::string m_HelpText;
+		std::string_view m_FlagsList;
+		std::string_view m_HelpText;
 	};
 
 	class VoiceReceiveLine final : public ConsoleLineBase<VoiceReceiveLine>
@@ -380,10 +402,11 @@ namespace tf2_bot_detector
 	public:
 		VoiceReceiveLine(time_point_t timestamp, uint8_t channel, uint8_t entindex, uint16_t bufSize);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Voice - chan " };
 
 		uint8_t GetEntIndex() const { return m_Entindex; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::VoiceReceive; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::VoiceReceive;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -398,19 +421,20 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		PingLine(time_point_t timestamp, uint16_t ping, std::string playerName);
+		PingLine(time_point_t timestamp, uint16_t ping, std::string_view playerName);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_ANCHORS[] = { " ms : " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::Ping; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::Ping;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
 		uint16_t GetPing() const { return m_Ping; }
-		const std::string& GetPlayerName() const { return m_PlayerName; }
+		std::string_view GetPlayerName() const { return m_PlayerName; }
 
 	private:
 		uint16_t m_Ping{};
-		std::string m_PlayerName;
+		std::string_view m_PlayerName;
 	};
 
 	class SVCUserMessageLine final : public ConsoleLineBase<SVCUserMessageLine>
@@ -418,21 +442,22 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		SVCUserMessageLine(time_point_t timestamp, std::string address, UserMessageType type, uint16_t bytes);
+		SVCUserMessageLine(time_point_t timestamp, std::string_view address, UserMessageType type, uint16_t bytes);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Msg from " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::SVC_UserMessage; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::SVC_UserMessage;
 		bool ShouldPrint() const override;
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetAddress() const { return m_Address; }
+		std::string_view GetAddress() const { return m_Address; }
 		UserMessageType GetUserMessageType() const { return m_MsgType; }
 		uint16_t GetUserMessageBytes() const { return m_MsgBytes; }
 
 	private:
 		static bool IsSpecial(UserMessageType type);
 
-		std::string m_Address{};
+		std::string_view m_Address{};
 		UserMessageType m_MsgType{};
 		uint16_t m_MsgBytes{};
 	};
@@ -442,18 +467,19 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ConfigExecLine(time_point_t timestamp, std::string configFileName, bool success);
+		ConfigExecLine(time_point_t timestamp, std::string_view configFileName, bool success);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "execing ", "'" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::ConfigExec; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::ConfigExec;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetConfigFileName() const { return m_ConfigFileName; }
+		std::string_view GetConfigFileName() const { return m_ConfigFileName; }
 		bool IsSuccessful() const { return m_Success; }
 
 	private:
-		std::string m_ConfigFileName;
+		std::string_view m_ConfigFileName;
 		bool m_Success = false;
 	};
 
@@ -464,16 +490,17 @@ namespace tf2_bot_detector
 	public:
 		TeamsSwitchedLine(time_point_t timestamp) : BaseClass(timestamp) {}
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Teams have been switched." };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::TeamsSwitched; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::TeamsSwitched;
 		bool ShouldPrint() const override;
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetConfigFileName() const { return m_ConfigFileName; }
+		std::string_view GetConfigFileName() const { return m_ConfigFileName; }
 		bool IsSuccessful() const { return m_Success; }
 
 	private:
-		std::string m_ConfigFileName;
+		std::string_view m_ConfigFileName;
 		bool m_Success = false;
 	};
 
@@ -482,17 +509,18 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ConnectingLine(time_point_t timestamp, std::string address, bool isMatchmaking, bool isRetrying);
+		ConnectingLine(time_point_t timestamp, std::string_view address, bool isMatchmaking, bool isRetrying);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Connecting to", "Retrying " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::Connecting; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::Connecting;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetAddress() const { return m_Address; }
+		std::string_view GetAddress() const { return m_Address; }
 
 	private:
-		std::string m_Address;
+		std::string_view m_Address;
 		bool m_IsMatchmaking : 1;
 		bool m_IsRetrying : 1;
 	};
@@ -504,8 +532,9 @@ namespace tf2_bot_detector
 	public:
 		HostNewGameLine(time_point_t timestamp) : BaseClass(timestamp) {}
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "---- Host_NewGame ----" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::HostNewGame; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::HostNewGame;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 	};
@@ -517,8 +546,9 @@ namespace tf2_bot_detector
 	public:
 		GameQuitLine(time_point_t timestamp) : BaseClass(timestamp) {}
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "CTFGCClientSystem::ShutdownGC" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::GameQuit; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::GameQuit;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 	};
@@ -530,8 +560,9 @@ namespace tf2_bot_detector
 	public:
 		QueueStateChangeLine(time_point_t timestamp, TFMatchGroup queueType, TFQueueStateChange stateChange);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "[PartyClient] " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::QueueStateChange; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::QueueStateChange;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -550,8 +581,9 @@ namespace tf2_bot_detector
 	public:
 		InQueueLine(time_point_t timestamp, TFMatchGroup queueType, time_point_t queueStartTime);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "    MatchGroup: " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::InQueue; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::InQueue;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -568,24 +600,25 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerJoinLine(time_point_t timestamp, std::string hostName, std::string mapName,
+		ServerJoinLine(time_point_t timestamp, std::string_view hostName, std::string_view mapName,
 			uint8_t playerCount, uint8_t playerMaxCount, uint32_t buildNumber, uint32_t serverNumber);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "\n" };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::ServerJoin; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::ServerJoin;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetHostName() const { return m_HostName; }
-		const std::string& GetMapName() const { return m_MapName; }
+		std::string_view GetHostName() const { return m_HostName; }
+		std::string_view GetMapName() const { return m_MapName; }
 		uint32_t GetBuildNumber() const { return m_BuildNumber; }
 		uint32_t GetServerNumber() const { return m_ServerNumber; }
 		uint8_t GetPlayerCount() const { return m_PlayerCount; }
 		uint8_t GetPlayerMaxCount() const { return m_PlayerMaxCount; }
 
 	private:
-		std::string m_HostName;
-		std::string m_MapName;
+		std::string_view m_HostName;
+		std::string_view m_MapName;
 		uint32_t m_BuildNumber{};
 		uint32_t m_ServerNumber{};
 		uint8_t m_PlayerCount{};
@@ -597,18 +630,19 @@ namespace tf2_bot_detector
 		using BaseClass = ConsoleLineBase;
 
 	public:
-		ServerDroppedPlayerLine(time_point_t timestamp, std::string playerName, std::string reason);
+		ServerDroppedPlayerLine(time_point_t timestamp, std::string_view playerName, std::string_view reason);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "Dropped " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::ServerDroppedPlayer; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::ServerDroppedPlayer;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
-		const std::string& GetPlayerName() const { return m_PlayerName; }
-		const std::string& GetReason() const { return m_Reason; }
+		std::string_view GetPlayerName() const { return m_PlayerName; }
+		std::string_view GetReason() const { return m_Reason; }
 
 	private:
-		std::string m_PlayerName;
-		std::string m_Reason;
+		std::string_view m_PlayerName;
+		std::string_view m_Reason;
 	};
 }
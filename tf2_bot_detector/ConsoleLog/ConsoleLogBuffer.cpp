@@ -0,0 +1,59 @@
+#include "ConsoleLogBuffer.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace tf2_bot_detector;
+
+ConsoleLogBuffer::ConsoleLogBuffer(size_t capacity) :
+	m_Data(std::make_unique<char[]>(capacity)),
+	m_Capacity(capacity)
+{
+}
+
+void ConsoleLogBuffer::Consume(size_t count)
+{
+	assert(count <= size());
+	m_Begin += count;
+
+	// Rewind for free whenever everything has been consumed
+	if (m_Begin == m_End)
+		m_Begin = m_End = 0;
+}
+
+std::span<char> ConsoleLogBuffer::PrepareWrite(size_t minSize)
+{
+	if ((m_Capacity - m_End) < minSize)
+	{
+		const size_t unconsumed = size();
+		if ((m_Capacity - unconsumed) >= minSize)
+		{
+			// Enough space if we move the tail back to the start
+			std::memmove(m_Data.get(), m_Data.get() + m_Begin, unconsumed);
+		}
+		else
+		{
+			// A single line is bigger than our entire buffer
+			const size_t newCapacity = std::max(m_Capacity * 2, unconsumed + minSize);
+			DebugLog("Growing console log buffer from {} to {} bytes", m_Capacity, newCapacity);
+
+			auto newData = std::make_unique<char[]>(newCapacity);
+			std::memcpy(newData.get(), m_Data.get() + m_Begin, unconsumed);
+			m_Data = std::move(newData);
+			m_Capacity = newCapacity;
+		}
+
+		m_Begin = 0;
+		m_End = unconsumed;
+	}
+
+	return std::span<char>(m_Data.get() + m_End, m_Capacity - m_End);
+}
+
+void ConsoleLogBuffer::CommitWrite(size_t count)
+{
+	assert(count <= (m_Capacity - m_End));
+	m_End += count;
+}
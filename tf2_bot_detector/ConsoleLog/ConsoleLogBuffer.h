@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace tf2_bot_detector
+{
+	// Fixed capacity buffer for console log text that hasn't been parsed yet. Consuming
+	// from the front only moves an offset. The (small) unconsumed tail is only shifted back
+	// to the start when there isn't enough room left at the end for the next write, and the
+	// storage only grows if a single unterminated line doesn't fit in it.
+	class ConsoleLogBuffer final
+	{
+	public:
+		static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+
+		explicit ConsoleLogBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+		// Unconsumed data. Invalidated by PrepareWrite().
+		std::string_view GetView() const { return std::string_view(m_Data.get() + m_Begin, m_End - m_Begin); }
+		size_t size() const { return m_End - m_Begin; }
+		size_t capacity() const { return m_Capacity; }
+		bool empty() const { return m_Begin == m_End; }
+
+		void Consume(size_t count);
+
+		// Returns writable space directly after the unconsumed data, at least minSize bytes long.
+		std::span<char> PrepareWrite(size_t minSize);
+		void CommitWrite(size_t count);
+
+	private:
+		std::unique_ptr<char[]> m_Data;
+		size_t m_Capacity = 0;
+		size_t m_Begin = 0;
+		size_t m_End = 0;
+	};
+}
@@ -1,128 +1,367 @@
 #include "ConsoleLogParser.h"
 #include "Config/ChatWrappers.h"
 #include "ConsoleLog/ConsoleLineListener.h"
+#include "ConsoleLineArena.h"
 #include "ConsoleLines.h"
+#include "ConsoleLogTimestamp.h"
+#include "GlobalDispatcher.h"
 #include "Log.h"
-#include "Util/RegexUtils.h"
 #include "Config/Settings.h"
 #include "WorldState.h"
 #include "Platform/Platform.h"
+#include "WorldJournal.h"
 
 #include <mh/text/format.hpp>
 #include <mh/text/formatters/error_code.hpp>
 #include <mh/future.hpp>
+#include <nlohmann/json.hpp>
 
-#include <regex>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace std::chrono_literals;
 using namespace std::string_literals;
 using namespace tf2_bot_detector;
 
-void ConsoleLogParser::TrySnapshot(bool& snapshotUpdated)
+struct ConsoleLogParser::TextRange
+{
+	size_t m_Offset = 0;
+	size_t m_Length = 0;
+
+	static TextRange FromView(const std::string_view& buffer, const std::string_view& view)
+	{
+		return TextRange{ size_t(view.data() - buffer.data()), view.size() };
+	}
+
+	std::string_view GetView(const std::string_view& buffer) const { return buffer.substr(m_Offset, m_Length); }
+};
+
+struct ConsoleLogParser::ChatMessageRecord
+{
+	ChatCategory m_Category{};
+	TextRange m_Name;
+	TextRange m_Message;
+};
+
+struct ConsoleLogParser::LineRecord
+{
+	CompensatedTS m_Timestamp;
+	bool m_PublishTimestamp = false;
+
+	TextRange m_Text;
+	std::optional<ChatMessageRecord> m_ChatMsg;
+
+	std::shared_ptr<IConsoleLine> m_Parsed; // Filled in by the classifier pool
+};
+
+struct ConsoleLogParser::ParseBatch
+{
+	// Owns the text (shared between all batches split from the same chunk) and the line
+	// objects parsed out of it, which just point back into the text
+	std::shared_ptr<ConsoleLineArena> m_Arena;
+	std::vector<LineRecord> m_Lines;
+	ConsoleLineTypeMask m_Interests; // Line types anyone was listening for when the batch was submitted
+	std::atomic<bool> m_Classified = false; // Set by the classifier pool
+
+	std::string_view GetView(const TextRange& range) const { return range.GetView(m_Arena->GetText()); }
+};
+
+struct ConsoleLogParser::LifetimeToken
+{
+	ConsoleLogParser* m_Parser = nullptr; // Only touched on the main thread, cleared when the parser goes away
+	std::atomic<bool> m_UpdateQueued = false;
+};
+
+bool ConsoleLogParser::TrySnapshot(bool& snapshotUpdated)
 {
 	if ((!snapshotUpdated || !m_CurrentTimestamp.IsSnapshotValid()) && m_CurrentTimestamp.IsRecordedValid())
 	{
-		m_CurrentTimestamp.Snapshot();
+		m_CurrentTimestamp.Snapshot(m_WallClock());
 		snapshotUpdated = true;
-		m_WorldState->UpdateTimestamp(*this);
+		return true;
+	}
+
+	return false;
+}
+
+void ConsoleLogParser::PublishTimestamp(const CompensatedTS& timestamp)
+{
+	m_DeliveredTimestamp = timestamp;
+	m_WorldState->UpdateTimestamp(*this);
+}
+
+ConsoleLogParser::ConsoleLogParser(IWorldState& world, const Settings& settings, std::filesystem::path conLogFile,
+	WallClockFunc wallClock) :
+	ConsoleLogParser(world, settings, std::move(wallClock))
+{
+	m_Reader.emplace(std::move(conLogFile), [token = std::weak_ptr(m_LifetimeToken)] { QueueUpdate(token); });
+}
+
+ConsoleLogParser::ConsoleLogParser(IWorldState& world, const Settings& settings, WallClockFunc wallClock) :
+	m_Settings(&settings), m_WorldState(&world), m_WallClock(std::move(wallClock)),
+	m_ClassifierPool(std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u)),
+	m_LifetimeToken(std::make_shared<LifetimeToken>())
+{
+	m_LifetimeToken->m_Parser = this;
+}
+
+ConsoleLogParser::~ConsoleLogParser()
+{
+	// Classifier tasks may still be holding on to the token
+	m_LifetimeToken->m_Parser = nullptr;
+}
+
+void ConsoleLogParser::QueueUpdate(const std::weak_ptr<LifetimeToken>& token)
+{
+	// Don't flood the dispatcher if the main thread is falling behind
+	if (auto locked = token.lock(); locked && !locked->m_UpdateQueued.exchange(true))
+	{
+		DispatchUpdateAsync(token);
+		WakeMainThread();
 	}
 }
 
-ConsoleLogParser::ConsoleLogParser(IWorldState& world, const Settings& settings, std::filesystem::path conLogFile) :
-	m_Settings(&settings), m_WorldState(&world), m_FileName(std::move(conLogFile))
+mh::task<> ConsoleLogParser::DispatchUpdateAsync(std::weak_ptr<LifetimeToken> token)
 {
+	co_await GetDispatcher().co_dispatch();
+
+	if (auto locked = token.lock(); locked && locked->m_Parser)
+	{
+		locked->m_UpdateQueued = false;
+		locked->m_Parser->Update();
+	}
+}
+
+void ConsoleLogParser::RecordChatWrappers(IJournalRecorder& recorder)
+{
+	// Chat messages can't be told apart without these, so every journal needs the ones that were
+	// in use before any of the text they were used on. Checked before each bit of text is
+	// recorded, since recording may start (or the wrappers may be regenerated) at any time.
+	const auto& wrappers = m_Settings->m_Unsaved.m_ChatMsgWrappers;
+	if (!wrappers)
+		return;
+
+	const auto sessionID = recorder.GetSessionID();
+	if (sessionID == m_RecordedChatWrappersSession && m_RecordedChatWrappers == wrappers)
+		return;
+
+	recorder.Record(JournalRecordType::ChatWrappers, nlohmann::json(*wrappers).dump());
+	m_RecordedChatWrappersSession = sessionID;
+	m_RecordedChatWrappers = wrappers;
 }
 
 void ConsoleLogParser::Update()
 {
-	const auto now = clock_t::now();
-	if (!m_File && (now - m_LastFileLoadAttempt) > 1s)
+	DeliverReadyBatches();
+
+	if (m_Reader)
+	{
+		if (m_Reader->HasPendingData())
+			Parse();
+
+		// Parse progress: how much of the file has made it to us, not just how much has been read
+		if (const auto length = m_Reader->GetFileSize(); length > 0)
+			m_ParseProgress = float(std::min(double(m_Reader->GetConsumedSize()) / length, 1.0));
+		else
+			m_ParseProgress = 1;
+	}
+
+	// Keep time moving forward while the log is quiet. If there are lines in flight,
+	// delivering them will take care of this instead.
+	if (m_InFlightBatches.empty())
 	{
-		m_LastFileLoadAttempt = now;
+		bool snapshotUpdated = false;
+		if (TrySnapshot(snapshotUpdated))
+			PublishTimestamp(m_CurrentTimestamp);
+	}
+}
 
-		// Try to truncate
+void ConsoleLogParser::Parse()
+{
+	using clock = std::chrono::steady_clock;
+	const auto startTime = clock::now();
+	bool snapshotUpdated = false;
+	while (m_InFlightBatches.size() < MAX_IN_FLIGHT_BATCHES)
+	{
+		const auto writeSpan = m_LineBuffer.PrepareWrite(PARSE_SLICE_SIZE);
+		const size_t readCount = m_Reader->Consume(writeSpan.first(PARSE_SLICE_SIZE));
+		if (readCount == 0)
+			break;
+
+		if (auto& recorder = IJournalRecorder::GetInstance(); recorder.IsRecording())
 		{
-			std::error_code ec;
-			const auto filesize = std::filesystem::file_size(m_FileName, ec);
-			if (ec)
-				LogWarning("Failed to get size of {}: {}", m_FileName, ec);
-			else if (std::filesystem::resize_file(m_FileName, 0, ec); ec)
-				Log("Unable to truncate {}, current size is {}", m_FileName, filesize);
-			else
-				Log("Truncated console log file");
+			RecordChatWrappers(recorder);
+			recorder.Record(JournalRecordType::ConsoleLogText, std::string_view(writeSpan.data(), readCount));
 		}
 
-		std::error_code ec;
+		m_LineBuffer.CommitWrite(readCount);
+		ParseBuffer(snapshotUpdated);
+
+		if (auto elapsed = clock::now() - startTime; elapsed >= 50ms)
+			break;
+	}
+}
+
+void ConsoleLogParser::AddText(const std::string_view& text)
+{
+	bool snapshotUpdated = false;
+	for (size_t offset = 0; offset < text.size(); )
+	{
+		const auto writeSpan = m_LineBuffer.PrepareWrite(std::min(text.size() - offset, PARSE_SLICE_SIZE));
+		const size_t count = text.copy(writeSpan.data(), std::min(writeSpan.size(), PARSE_SLICE_SIZE), offset);
+		m_LineBuffer.CommitWrite(count);
+		offset += count;
+
+		ParseBuffer(snapshotUpdated);
+	}
+}
+
+void ConsoleLogParser::ParseBuffer(bool& snapshotUpdated)
+{
+	const std::string_view buffer = m_LineBuffer.GetView();
+	size_t parseEnd = 0;
+	std::vector<LineRecord> lines;
+	ParseChunk(buffer, parseEnd, lines, snapshotUpdated);
+
+	if (!lines.empty())
+		SubmitLines(buffer.substr(0, parseEnd), std::move(lines));
+
+	m_LineBuffer.Consume(parseEnd);
+}
+
+void ConsoleLogParser::SubmitLines(const std::string_view& text, std::vector<LineRecord> lines)
+{
+	// The line buffer gets reused as soon as we return, so the batches need their own copy of the text
+	const auto sharedText = std::make_shared<const std::string>(text);
+	const auto interests = m_WorldState->GetConsoleLineInterests();
+
+	for (size_t i = 0; i < lines.size(); i += MAX_BATCH_LINES)
+	{
+		const auto begin = lines.begin() + i;
+		const auto end = lines.begin() + std::min(i + MAX_BATCH_LINES, lines.size());
+
+		auto batch = std::make_shared<ParseBatch>();
+		batch->m_Arena = std::make_shared<ConsoleLineArena>(sharedText);
+		batch->m_Lines.assign(std::make_move_iterator(begin), std::make_move_iterator(end));
+		batch->m_Interests = interests;
+
+		m_InFlightBatches.push_back(batch);
+		ClassifyBatchAsync(m_LifetimeToken, std::move(batch), m_ClassifierPool);
+	}
+}
+
+mh::task<> ConsoleLogParser::ClassifyBatchAsync(std::weak_ptr<LifetimeToken> token,
+	std::shared_ptr<ParseBatch> batch, mh::thread_pool& pool)
+{
+	co_await pool.co_add_task();
+
+	{
+		ConsoleLineArena::Scope arenaScope(batch->m_Arena);
+		for (LineRecord& line : batch->m_Lines)
 		{
-			FILE* temp = _wfsopen(m_FileName.c_str(), L"r", _SH_DENYNO);
-			if (!temp)
+			if (!line.m_ChatMsg)
 			{
-				auto e = errno;
-				ec = std::error_code(e, std::generic_category());
+				line.m_Parsed = IConsoleLine::ParseConsoleLine(batch->GetView(line.m_Text),
+					line.m_Timestamp.GetSnapshot(), batch->m_Interests);
 			}
-			m_File.reset(temp);
 		}
-
-		if (!m_File)
-			DebugLog("Failed to open {}: {}", m_FileName, ec);
-		else
-			Log("Successfully opened {}", m_FileName);
 	}
 
-	bool snapshotUpdated = false;
+	// Delivered by the next Update(), along with anything else that's ready by then
+	batch->m_Classified = true;
+	QueueUpdate(token);
+}
 
+void ConsoleLogParser::DeliverReadyBatches()
+{
 	bool linesProcessed = false;
 	bool consoleLinesUpdated = false;
-	if (m_File)
+
+	// Batches may finish classification out of order, but they must be delivered in order
+	while (!m_InFlightBatches.empty() && m_InFlightBatches.front()->m_Classified)
 	{
-		Parse(linesProcessed, snapshotUpdated, consoleLinesUpdated);
+		const auto batch = std::move(m_InFlightBatches.front());
+		m_InFlightBatches.pop_front();
 
-		// Parse progress
-		{
-			const auto pos = ftell(m_File.get());
-			const auto length = std::filesystem::file_size(m_FileName);
-			m_ParseProgress = float(double(pos) / length);
-		}
+		DeliverBatch(*batch, consoleLinesUpdated);
+		linesProcessed = true;
 	}
 
-	TrySnapshot(snapshotUpdated);
-
 	if (linesProcessed)
 		m_WorldState->GetConsoleLineListenerBroadcaster().OnConsoleLogChunkParsed(*m_WorldState, consoleLinesUpdated);
 }
 
-void ConsoleLogParser::CustomDeleters::operator()(FILE* f) const
+void ConsoleLogParser::DeliverBatch(ParseBatch& batch, bool& consoleLinesUpdated)
 {
-	fclose(f);
-}
+	auto& broadcaster = m_WorldState->GetConsoleLineListenerBroadcaster();
 
-void ConsoleLogParser::Parse(bool& linesProcessed, bool& snapshotUpdated, bool& consoleLinesUpdated)
-{
-	char buf[4096];
-	size_t readCount;
-	using clock = std::chrono::steady_clock;
-	const auto startTime = clock::now();
-	do
+	// Parsed lines are handed to listeners in runs that share the same world timestamp
+	const auto FlushParsedLines = [&]
+	{
+		if (m_DeliveryLines.empty())
+			return;
+
+		broadcaster.OnConsoleLinesParsed(*m_WorldState, m_DeliveryLines.GetLines());
+		m_DeliveryLines.Clear();
+		consoleLinesUpdated = true;
+	};
+
+	for (LineRecord& line : batch.m_Lines)
 	{
-		readCount = fread(buf, sizeof(buf[0]), std::size(buf), m_File.get());
-		if (readCount > 0)
+		if (line.m_PublishTimestamp)
 		{
-			m_FileLineBuf.append(buf, readCount);
-			ILogManager::GetInstance().LogConsoleOutput(std::string_view(buf, readCount));
+			FlushParsedLines();
+			PublishTimestamp(line.m_Timestamp);
+		}
 
-			auto parseEnd = m_FileLineBuf.cbegin();
-			ParseChunk(parseEnd, linesProcessed, snapshotUpdated, consoleLinesUpdated);
+		if (line.m_ChatMsg)
+		{
+			// Player lookups for chat lines have to see everything before them
+			FlushParsedLines();
+			line.m_Parsed = CreateChatLine(batch, *line.m_ChatMsg);
+		}
 
-			m_FileLineBuf.erase(m_FileLineBuf.begin(), parseEnd);
+		if (line.m_Parsed)
+		{
+			if (line.m_Parsed->GetType() == ConsoleLineType::Chat && !line.m_ChatMsg)
+				LogError("Line was parsed as a chat message via old code path, this should never happen!");
+
+			m_DeliveryLines.Add(*line.m_Parsed);
+		}
+		else
+		{
+			// Keep listeners seeing lines in the order they were written
+			FlushParsedLines();
+			broadcaster.OnConsoleLineUnparsed(*m_WorldState, batch.GetView(line.m_Text));
 		}
+	}
 
-		if (auto elapsed = clock::now() - startTime; elapsed >= 50ms)
-			break;
+	FlushParsedLines();
+	m_DeliveredLineCount += batch.m_Lines.size();
+}
 
-	} while (readCount > 0);
+std::shared_ptr<IConsoleLine> ConsoleLogParser::CreateChatLine(const ParseBatch& batch, const ChatMessageRecord& chatMsg) const
+{
+	const auto name = batch.GetView(chatMsg.m_Name);
+	const auto msg = batch.GetView(chatMsg.m_Message);
+
+	TeamShareResult teamShareResult = TeamShareResult::Neither;
+	bool isSelf = false;
+	if (auto player = m_WorldState->FindSteamIDForName(name))
+	{
+		teamShareResult = m_WorldState->GetTeamShareResult(*player);
+		isSelf = (player == m_Settings->GetLocalSteamID());
+	}
+
+	ConsoleLineArena::Scope arenaScope(batch.m_Arena);
+	return ChatConsoleLine::Create(m_WorldState->GetCurrentTime(),
+		name, msg, IsDead(chatMsg.m_Category), IsTeam(chatMsg.m_Category), isSelf, teamShareResult);
 }
 
-bool ConsoleLogParser::ParseChatMessage(const std::string_view& lineStr, striter& parseEnd, std::shared_ptr<IConsoleLine>& parsed)
+bool ConsoleLogParser::ParseChatMessage(const std::string_view& buffer, const std::string_view& lineStr,
+	size_t& parseEnd, std::optional<ChatMessageRecord>& chatMsg)
 {
 	for (int i = 0; i < (int)ChatCategory::COUNT; i++)
 	{
@@ -131,8 +370,8 @@ bool ConsoleLogParser::ParseChatMessage(const std::string_view& lineStr, striter
 		auto& type = m_Settings->m_Unsaved.m_ChatMsgWrappers.value().m_Types[i];
 		if (lineStr.starts_with(type.m_Full.m_Start.m_Narrow))
 		{
-			auto searchBuf = std::string_view(m_FileLineBuf).substr(
-				&*lineStr.begin() - m_FileLineBuf.data() + type.m_Full.m_Start.m_Narrow.size());
+			auto searchBuf = buffer.substr(
+				lineStr.data() - buffer.data() + type.m_Full.m_Start.m_Narrow.size());
 
 			if (auto found = searchBuf.find(type.m_Full.m_End.m_Narrow); found != lineStr.npos)
 			{
@@ -158,16 +397,13 @@ bool ConsoleLogParser::ParseChatMessage(const std::string_view& lineStr, striter
 						msgBegin + type.m_Message.m_Start.m_Narrow.size(),
 						msgEnd - msgBegin - type.m_Message.m_Start.m_Narrow.size());
 
-					TeamShareResult teamShareResult = TeamShareResult::Neither;
-					bool isSelf = false;
-					if (auto player = m_WorldState->FindSteamIDForName(name))
-					{
-						teamShareResult = m_WorldState->GetTeamShareResult(*player);
-						isSelf = (player == m_Settings->GetLocalSteamID());
-					}
-
-					parsed = std::make_unique<ChatConsoleLine>(m_WorldState->GetCurrentTime(),
-						std::string(name), std::string(msg), IsDead(category), IsTeam(category), isSelf, teamShareResult);
+					// Player lookups depend on world state, so they have to wait until this line is delivered
+					chatMsg.emplace(ChatMessageRecord
+						{
+							.m_Category = category,
+							.m_Name = TextRange::FromView(buffer, name),
+							.m_Message = TextRange::FromView(buffer, msg),
+						});
 				}
 				else
 				{
@@ -187,7 +423,7 @@ bool ConsoleLogParser::ParseChatMessage(const std::string_view& lineStr, striter
 			else
 			{
 				LogError("Failed to locate chat message wrapper end");
-				return false; // Not enough characters in m_FileLineBuf. Try again later.
+				return false; // Not enough characters in buffer. Try again later.
 			}
 		}
 	}
@@ -195,88 +431,51 @@ bool ConsoleLogParser::ParseChatMessage(const std::string_view& lineStr, striter
 	return true;
 }
 
-void ConsoleLogParser::ParseChunk(striter& parseEnd, bool& linesProcessed, bool& snapshotUpdated, bool& consoleLinesUpdated)
+void ConsoleLogParser::ParseChunk(const std::string_view& buffer, size_t& parseEnd,
+	std::vector<LineRecord>& lines, bool& snapshotUpdated)
 {
-	static const std::regex s_TimestampRegex(R"regex(\n(\d\d)\/(\d\d)\/(\d\d\d\d) - (\d\d):(\d\d):(\d\d):[ \n])regex", std::regex::optimize);
-
-	std::smatch match;
-	while (std::regex_search(parseEnd, m_FileLineBuf.cend(), match, s_TimestampRegex))
+	while (auto match = FindConsoleLogTimestamp(buffer, parseEnd))
 	{
-		auto regexBegin = parseEnd;
+		auto nextLineBegin = parseEnd;
 
-		ParseLineResult result = ParseLineResult::Unparsed;
-		bool skipTimestampParse = false;
+		bool isChatMsg = false;
 		if (m_CurrentTimestamp.IsRecordedValid())
 		{
 			// If we have a valid snapshot, that means that there was a previously parsed
 			// timestamp. The contents of that line is the current timestamp match's prefix
-			// (the previous timestamp match was erased from the string)
-
-			TrySnapshot(snapshotUpdated);
-			linesProcessed = true;
+			// (the previous timestamp match was already consumed)
 
-			std::shared_ptr<IConsoleLine> parsed;
+			const bool publishTimestamp = TrySnapshot(snapshotUpdated);
 
-			const auto prefix = match.prefix();
-			//const auto suffix = match.suffix();
-			const std::string_view lineStr(&*prefix.first, prefix.length());
+			const auto lineStr = buffer.substr(parseEnd, match->m_Offset - parseEnd);
 
-			if (ParseChatMessage(lineStr, regexBegin, parsed))
-			{
-				if (parsed)
-					result = ParseLineResult::Modified;
-			}
-			else
-			{
+			std::optional<ChatMessageRecord> chatMsg;
+			const auto chatStartTime = std::chrono::steady_clock::now();
+			if (!ParseChatMessage(buffer, lineStr, nextLineBegin, chatMsg))
 				return; // Try again later (not enough chars in buffer)
-			}
 
-			if (!parsed && result == ParseLineResult::Unparsed)
-			{
-				parsed = IConsoleLine::ParseConsoleLine(lineStr, m_CurrentTimestamp.GetSnapshot());
-				if (parsed && parsed->GetType() == ConsoleLineType::Chat)
-					LogError("Line was parsed as a chat message via old code path, this should never happen!");
+			ChatConsoleLine::RecordParseAttempt(std::max(lineStr.size(), nextLineBegin - parseEnd),
+				std::chrono::steady_clock::now() - chatStartTime, chatMsg.has_value());
 
-				result = ParseLineResult::Success;
-			}
+			isChatMsg = chatMsg.has_value();
 
-			if (parsed)
-			{
-				if (result == ParseLineResult::Success || result == ParseLineResult::Modified)
-				{
-					m_WorldState->GetConsoleLineListenerBroadcaster().OnConsoleLineParsed(*m_WorldState, *parsed);
-					consoleLinesUpdated = true;
-				}
-			}
-			else
-			{
-				m_WorldState->GetConsoleLineListenerBroadcaster().OnConsoleLineUnparsed(*m_WorldState, lineStr);
-			}
+			LineRecord& line = lines.emplace_back();
+			line.m_Timestamp = m_CurrentTimestamp;
+			line.m_PublishTimestamp = publishTimestamp;
+			line.m_Text = TextRange::FromView(buffer, lineStr);
+			line.m_ChatMsg = std::move(chatMsg);
 		}
 
-		if (result != ParseLineResult::Modified)
+		if (!isChatMsg)
 		{
-			std::tm time{};
-			time.tm_isdst = -1;
-			from_chars_throw(match[1], time.tm_mon);
-			time.tm_mon -= 1;
-
-			from_chars_throw(match[2], time.tm_mday);
-			from_chars_throw(match[3], time.tm_year);
-			time.tm_year -= 1900;
-
-			from_chars_throw(match[4], time.tm_hour);
-			from_chars_throw(match[5], time.tm_min);
-			from_chars_throw(match[6], time.tm_sec);
-
-			m_CurrentTimestamp.SetRecorded(clock_t::from_time_t(std::mktime(&time)));
-			regexBegin = match[0].second;
+			m_CurrentTimestamp.SetRecorded(m_TimestampConverter.ToTimePoint(*match), m_WallClock());
+			nextLineBegin = match->GetEnd();
 		}
 		else
 		{
 			m_CurrentTimestamp.InvalidateRecorded();
 		}
 
-		parseEnd = regexBegin;
+		parseEnd = nextLineBegin;
 	}
 }
@@ -1,57 +1,124 @@
 #pragma once
 
 #include "CompensatedTS.h"
+#include "Config/ChatWrappers.h"
+#include "ConsoleLineListener.h"
+#include "ConsoleLogBuffer.h"
+#include "ConsoleLogReader.h"
+#include "ConsoleLogTimestamp.h"
 
+#include <mh/concurrency/thread_pool.hpp>
+#include <mh/coroutine/task.hpp>
+
+#include <atomic>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <unordered_set>
+#include <vector>
 
 namespace tf2_bot_detector
 {
 	class IConsoleLine;
-	class IConsoleLineListener;
+	class IJournalRecorder;
 	class Settings;
 	class IWorldState;
 
+	// Console log parsing is split into stages:
+	//  1. ConsoleLogReader tails the file on its own thread
+	//  2. Update() splits the new data into timestamped lines on the main thread (cheap)
+	//  3. Batches of lines are classified by IConsoleLine::ParseConsoleLine on a worker pool,
+	//     skipping line types no console line listener is registered for
+	//  4. Classified batches are handed to listeners on the main thread, in their original order
+	// The reader and the classifier pool share a single hop to the main thread to get there.
 	class ConsoleLogParser final
 	{
 	public:
-		ConsoleLogParser(IWorldState& world, const Settings& settings, std::filesystem::path conLogFile);
+		// wallClock only feeds timestamp compensation, world time comes from the log itself
+		using WallClockFunc = std::function<time_point_t()>;
+		ConsoleLogParser(IWorldState& world, const Settings& settings, std::filesystem::path conLogFile,
+			WallClockFunc wallClock = &tfbd_clock_t::now);
+
+		// No console.log file, text only comes in through AddText(). Used for journal replay.
+		ConsoleLogParser(IWorldState& world, const Settings& settings, WallClockFunc wallClock = &tfbd_clock_t::now);
+		~ConsoleLogParser();
+		ConsoleLogParser(const ConsoleLogParser&) = delete;
+		ConsoleLogParser& operator=(const ConsoleLogParser&) = delete;
 
 		void Update();
+		void AddText(const std::string_view& text);
+
+		// Nothing waiting to be classified or delivered to listeners
+		bool IsIdle() const { return m_InFlightBatches.empty(); }
 
 		float GetParseProgress() const { return m_ParseProgress; }
 
-		const CompensatedTS& GetCurrentTimestamp() const { return m_CurrentTimestamp; }
+		// Lines handed to listeners so far, whether they were parsed or not
+		size_t GetDeliveredLineCount() const { return m_DeliveredLineCount; }
+
+		// The timestamp of the most recent line delivered to listeners
+		const CompensatedTS& GetCurrentTimestamp() const { return m_DeliveredTimestamp; }
 
 	private:
 		const Settings* m_Settings = nullptr;
 		IWorldState* m_WorldState = nullptr;
+		WallClockFunc m_WallClock;
+
+		bool TrySnapshot(bool& snapshotUpdated);
+		void PublishTimestamp(const CompensatedTS& timestamp);
+		CompensatedTS m_CurrentTimestamp;   // Timestamp as of the most recently split line
+		CompensatedTS m_DeliveredTimestamp; // Timestamp as of the most recently delivered line
+		ConsoleLogTimestampConverter m_TimestampConverter;
+
+		struct TextRange;
+		struct ChatMessageRecord;
+		struct LineRecord;
+		struct ParseBatch;
+		struct LifetimeToken;
 
-		void TrySnapshot(bool& snapshotUpdated);
-		CompensatedTS m_CurrentTimestamp;
-
-		enum class ParseLineResult
-		{
-			Unparsed,
-			Defer,
-			Success,
-			Modified,
-		};
-
-		using striter = std::string::const_iterator;
-		void Parse(bool& linesProcessed, bool& snapshotUpdated, bool& consoleLinesUpdated);
-		void ParseChunk(striter& parseEnd, bool& linesProcessed, bool& snapshotUpdated, bool& consoleLinesUpdated);
-		bool ParseChatMessage(const std::string_view& lineStr, striter& parseEnd, std::shared_ptr<IConsoleLine>& parsed);
-
-		struct CustomDeleters
-		{
-			void operator()(FILE*) const;
-		};
-		std::filesystem::path m_FileName;
-		std::unique_ptr<FILE, CustomDeleters> m_File;
-		time_point_t m_LastFileLoadAttempt{};
-		std::string m_FileLineBuf;
+		// Stage 2. Data is handed over to the parser in slices so we can stay within our time
+		// budget when the reader thread has buffered a large amount of output.
+		static constexpr size_t PARSE_SLICE_SIZE = 64 * 1024;
+		void Parse();
+		void ParseBuffer(bool& snapshotUpdated);
+		void ParseChunk(const std::string_view& buffer, size_t& parseEnd, std::vector<LineRecord>& lines, bool& snapshotUpdated);
+		bool ParseChatMessage(const std::string_view& buffer, const std::string_view& lineStr,
+			size_t& parseEnd, std::optional<ChatMessageRecord>& chatMsg);
+		void SubmitLines(const std::string_view& text, std::vector<LineRecord> lines);
+
+		// Stage 3
+		static constexpr size_t MAX_BATCH_LINES = 256;
+		mh::thread_pool m_ClassifierPool;
+		static mh::task<> ClassifyBatchAsync(std::weak_ptr<LifetimeToken> token,
+			std::shared_ptr<ParseBatch> batch, mh::thread_pool& pool);
+
+		// Stage 4. We stop taking data from the reader while this many batches are waiting, so
+		// a game writing faster than we can deliver backs up into the file instead of memory.
+		static constexpr size_t MAX_IN_FLIGHT_BATCHES = 64;
+		std::deque<std::shared_ptr<ParseBatch>> m_InFlightBatches;
+		void DeliverReadyBatches();
+		void DeliverBatch(ParseBatch& batch, bool& consoleLinesUpdated);
+		ConsoleLineBatch m_DeliveryLines; // Reused between deliveries
+		size_t m_DeliveredLineCount = 0;
+		std::shared_ptr<IConsoleLine> CreateChatLine(const ParseBatch& batch, const ChatMessageRecord& chatMsg) const;
+
+		// The chat wrappers written to the journal, and which recording they went to
+		void RecordChatWrappers(IJournalRecorder& recorder);
+		std::optional<ChatWrappers> m_RecordedChatWrappers;
+		uint32_t m_RecordedChatWrappersSession = 0;
+
+		ConsoleLogBuffer m_LineBuffer;
 		float m_ParseProgress = 0;
+
+		// Lets the reader thread and the classifier pool call back into us through the
+		// dispatcher without outliving us
+		std::shared_ptr<LifetimeToken> m_LifetimeToken;
+		static void QueueUpdate(const std::weak_ptr<LifetimeToken>& token);
+		static mh::task<> DispatchUpdateAsync(std::weak_ptr<LifetimeToken> token);
+
+		// Declared last so the reader thread is shut down before anything it touches is destroyed
+		std::optional<ConsoleLogReader> m_Reader;
 	};
 }
@@ -0,0 +1,212 @@
+#include "ConsoleLogReader.h"
+#include "Log.h"
+#include "Platform/Platform.h"
+
+#include <mh/text/format.hpp>
+#include <mh/text/formatters/error_code.hpp>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+using namespace tf2_bot_detector;
+
+// Some filesystems only report size changes once the writer's cache gets flushed,
+// so don't trust change notifications to be the only thing that wakes us up.
+static constexpr auto NOTIFY_FALLBACK_INTERVAL = 100ms;
+static constexpr auto POLL_INTERVAL = 50ms;
+static constexpr auto OPEN_RETRY_INTERVAL = 1s;
+
+ConsoleLogReader::ConsoleLogReader(std::filesystem::path fileName, DataAvailableFunc onDataAvailable) :
+	m_FileName(std::move(fileName)),
+	m_OnDataAvailable(std::move(onDataAvailable)),
+	m_ReadBuf(std::make_unique<char[]>(MAX_CHUNK_SIZE))
+{
+	m_Notifier = FileWatch::CreateChangeNotifier(m_FileName);
+	if (!m_Notifier)
+		LogWarning("File change notifications unavailable for {}, falling back to polling", m_FileName);
+
+	m_Thread = std::thread(&ConsoleLogReader::ReaderThreadFunc, this);
+}
+
+ConsoleLogReader::~ConsoleLogReader()
+{
+	{
+		std::lock_guard lock(m_StopMutex);
+		m_StopRequested = true;
+	}
+	m_StopCV.notify_all();
+
+	if (m_Notifier)
+		m_Notifier->Cancel();
+
+	if (m_Thread.joinable())
+		m_Thread.join();
+}
+
+void ConsoleLogReader::CustomDeleters::operator()(FILE* f) const
+{
+	fclose(f);
+}
+
+size_t ConsoleLogReader::Consume(std::span<char> output)
+{
+	std::lock_guard lock(m_PendingMutex);
+
+	const size_t count = std::min(output.size(), m_PendingData.size() - m_PendingOffset);
+	m_PendingData.copy(output.data(), count, m_PendingOffset);
+	m_PendingOffset += count;
+
+	if (m_PendingOffset == m_PendingData.size())
+	{
+		// Keep the allocation around for next time
+		m_PendingData.clear();
+		m_PendingOffset = 0;
+	}
+
+	m_PendingSize = m_PendingData.size() - m_PendingOffset;
+	m_ConsumedSize += count;
+	return count;
+}
+
+void ConsoleLogReader::WaitFor(std::chrono::milliseconds duration)
+{
+	std::unique_lock lock(m_StopMutex);
+	m_StopCV.wait_for(lock, duration, [&] { return m_StopRequested; });
+}
+
+void ConsoleLogReader::ReaderThreadFunc()
+{
+	bool fileChanged = true;
+	while (true)
+	{
+		{
+			std::lock_guard lock(m_StopMutex);
+			if (m_StopRequested)
+				break;
+		}
+
+		if (!m_File && !TryOpenFile())
+		{
+			WaitFor(OPEN_RETRY_INTERVAL);
+			continue;
+		}
+
+		if (m_PendingSize >= MAX_PENDING_SIZE)
+		{
+			// The parser is falling behind, leave the rest in the file until it catches up.
+			// There's more to read whether or not the file changes, so don't wait on the notifier.
+			WaitFor(POLL_INTERVAL);
+			fileChanged = true;
+			continue;
+		}
+
+		if (ReadAvailable(fileChanged) && m_OnDataAvailable)
+			m_OnDataAvailable();
+
+		if (m_Notifier)
+			fileChanged = m_Notifier->WaitForChange(NOTIFY_FALLBACK_INTERVAL);
+		else
+			WaitFor(POLL_INTERVAL);
+	}
+}
+
+bool ConsoleLogReader::TryOpenFile()
+{
+	uint64_t initialSize = 0;
+
+	// Try to truncate
+	{
+		std::error_code ec;
+		const auto filesize = std::filesystem::file_size(m_FileName, ec);
+		if (ec)
+		{
+			LogWarning("Failed to get size of {}: {}", m_FileName, ec);
+		}
+		else if (std::filesystem::resize_file(m_FileName, 0, ec); ec)
+		{
+			Log("Unable to truncate {}, current size is {}", m_FileName, filesize);
+			initialSize = filesize;
+		}
+		else
+		{
+			Log("Truncated console log file");
+		}
+	}
+
+	std::error_code ec;
+	{
+		FILE* temp = _wfsopen(m_FileName.c_str(), L"r", _SH_DENYNO);
+		if (!temp)
+		{
+			auto e = errno;
+			ec = std::error_code(e, std::generic_category());
+		}
+		m_File.reset(temp);
+	}
+
+	if (!m_File)
+	{
+		DebugLog("Failed to open {}: {}", m_FileName, ec);
+		return false;
+	}
+
+	Log("Successfully opened {}", m_FileName);
+	m_ReadOffset = 0;
+	m_FileSize = initialSize;
+	m_IsOpen = true;
+	return true;
+}
+
+bool ConsoleLogReader::ReadAvailable(bool refreshFileSize)
+{
+	// How far behind we are, so the parser can report progress against the file rather than
+	// against what we've happened to read so far. Only worth a stat when we've been told the
+	// file changed, otherwise the reads below keep the size up to date.
+	if (refreshFileSize)
+	{
+		std::error_code ec;
+		if (const auto fileSize = std::filesystem::file_size(m_FileName, ec); !ec)
+			m_FileSize = std::max<uint64_t>(fileSize, m_ReadOffset);
+	}
+
+	bool anyRead = false;
+	size_t readCount;
+	do
+	{
+		const size_t chunkSize = m_ChunkSize;
+		readCount = fread(m_ReadBuf.get(), sizeof(m_ReadBuf[0]), chunkSize, m_File.get());
+		if (readCount > 0)
+		{
+			const std::string_view data(m_ReadBuf.get(), readCount);
+			ILogManager::GetInstance().LogConsoleOutput(data);
+
+			{
+				std::lock_guard lock(m_PendingMutex);
+				m_PendingData.append(data);
+				m_PendingSize = m_PendingData.size() - m_PendingOffset;
+			}
+
+			m_ReadOffset += readCount;
+			if (m_ReadOffset > m_FileSize)
+				m_FileSize = m_ReadOffset;
+
+			anyRead = true;
+		}
+
+		// Grow the chunk size while we keep filling it (big status dumps, initial catch-up),
+		// shrink it back down once the game is only trickling a few lines at a time.
+		if (readCount == chunkSize)
+			m_ChunkSize = std::min(chunkSize * 2, MAX_CHUNK_SIZE);
+		else if (readCount < (chunkSize / 4))
+			m_ChunkSize = std::max(chunkSize / 2, MIN_CHUNK_SIZE);
+
+		if (readCount < chunkSize || m_PendingSize >= MAX_PENDING_SIZE)
+			break;
+
+	} while (true);
+
+	// We hit EOF, make sure the next read actually goes back to the file
+	clearerr(m_File.get());
+
+	return anyRead;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+namespace tf2_bot_detector
+{
+	inline namespace Platform
+	{
+		namespace FileWatch
+		{
+			class IChangeNotifier;
+		}
+	}
+
+	// Tails a file on a background thread. The thread sleeps until the platform tells us the
+	// file has changed (or a fallback poll interval expires), then reads everything that
+	// was appended in as few reads as possible.
+	class ConsoleLogReader final
+	{
+	public:
+		using DataAvailableFunc = std::function<void()>;
+
+		// onDataAvailable is invoked on the reader thread whenever new data has been read.
+		ConsoleLogReader(std::filesystem::path fileName, DataAvailableFunc onDataAvailable = nullptr);
+		~ConsoleLogReader();
+
+		ConsoleLogReader(const ConsoleLogReader&) = delete;
+		ConsoleLogReader& operator=(const ConsoleLogReader&) = delete;
+
+		// Copies as much data read from the file as will fit into output. Returns the number of bytes copied.
+		size_t Consume(std::span<char> output);
+
+		bool IsOpen() const { return m_IsOpen; }
+		bool HasPendingData() const { return m_PendingSize > 0; }
+
+		// Total number of bytes handed out via Consume().
+		uint64_t GetConsumedSize() const { return m_ConsumedSize; }
+		// Size of the file as of the last change notification, or how much we've read if that's more.
+		uint64_t GetFileSize() const { return m_FileSize; }
+
+		static constexpr size_t MIN_CHUNK_SIZE = 16 * 1024;
+		static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+		// We stop reading while this much is waiting to be consumed
+		static constexpr size_t MAX_PENDING_SIZE = 4 * MAX_CHUNK_SIZE;
+
+	private:
+		void ReaderThreadFunc();
+		bool TryOpenFile();
+		bool ReadAvailable(bool refreshFileSize);
+		void WaitFor(std::chrono::milliseconds duration);
+
+		struct CustomDeleters
+		{
+			void operator()(FILE*) const;
+		};
+
+		std::filesystem::path m_FileName;
+		DataAvailableFunc m_OnDataAvailable;
+		std::unique_ptr<FileWatch::IChangeNotifier> m_Notifier;
+
+		// Only touched by the reader thread
+		std::unique_ptr<FILE, CustomDeleters> m_File;
+		std::unique_ptr<char[]> m_ReadBuf;
+		size_t m_ChunkSize = MIN_CHUNK_SIZE;
+		uint64_t m_ReadOffset = 0;
+
+		std::mutex m_PendingMutex;
+		std::string m_PendingData;
+		size_t m_PendingOffset = 0;
+
+		std::atomic<bool> m_IsOpen = false;
+		std::atomic<size_t> m_PendingSize = 0;
+		std::atomic<uint64_t> m_ConsumedSize = 0;
+		std::atomic<uint64_t> m_FileSize = 0;
+
+		std::mutex m_StopMutex;
+		std::condition_variable m_StopCV;
+		bool m_StopRequested = false;
+
+		std::thread m_Thread;
+	};
+}
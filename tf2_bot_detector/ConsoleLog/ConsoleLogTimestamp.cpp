@@ -0,0 +1,198 @@
+#include "ConsoleLogTimestamp.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TF2BD_TIMESTAMP_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TF2BD_TARGET_AVX2
+#else
+#define TF2BD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace tf2_bot_detector;
+
+namespace
+{
+	constexpr bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	constexpr int Digits2(const char* p)
+	{
+		return (p[0] - '0') * 10 + (p[1] - '0');
+	}
+
+	constexpr int Digits4(const char* p)
+	{
+		return Digits2(p) * 100 + Digits2(p + 2);
+	}
+
+	size_t FindNewlineScalar(const char* data, size_t pos, size_t end)
+	{
+		if (auto found = static_cast<const char*>(std::memchr(data + pos, '\n', end - pos)))
+			return found - data;
+
+		return end;
+	}
+
+#ifdef TF2BD_TIMESTAMP_SIMD
+	unsigned CountTrailingZeros(uint32_t mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	size_t FindNewlineSSE2(const char* data, size_t pos, size_t end)
+	{
+		const __m128i newline = _mm_set1_epi8('\n');
+		for (; pos + 16 <= end; pos += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+			if (const uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)))
+				return pos + CountTrailingZeros(mask);
+		}
+
+		return FindNewlineScalar(data, pos, end);
+	}
+
+	TF2BD_TARGET_AVX2 size_t FindNewlineAVX2(const char* data, size_t pos, size_t end)
+	{
+		const __m256i newline = _mm256_set1_epi8('\n');
+		for (; pos + 32 <= end; pos += 32)
+		{
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+			if (const uint32_t mask = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline))))
+				return pos + CountTrailingZeros(mask);
+		}
+
+		return FindNewlineSSE2(data, pos, end);
+	}
+
+	bool IsAVX2Supported()
+	{
+#ifdef _MSC_VER
+		int regs[4]{};
+		__cpuid(regs, 0);
+		if (regs[0] < 7)
+			return false;
+
+		__cpuid(regs, 1);
+		const bool osxsave = regs[2] & (1 << 27);
+		const bool avx = regs[2] & (1 << 28);
+		if (!osxsave || !avx)
+			return false;
+
+		// OS must be saving the YMM registers
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(regs, 7, 0);
+		return regs[1] & (1 << 5);
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	using FindNewlineFn = size_t(*)(const char* data, size_t pos, size_t end);
+
+	FindNewlineFn SelectFindNewline()
+	{
+#ifdef TF2BD_TIMESTAMP_SIMD
+		if (IsAVX2Supported())
+			return &FindNewlineAVX2;
+		else
+			return &FindNewlineSSE2;
+#else
+		return &FindNewlineScalar;
+#endif
+	}
+
+	const FindNewlineFn s_FindNewline = SelectFindNewline();
+}
+
+std::optional<ConsoleLogTimestamp> tf2_bot_detector::TryParseConsoleLogTimestamp(const std::string_view& text, size_t offset)
+{
+	if (offset > text.size() || (text.size() - offset) < ConsoleLogTimestamp::LENGTH)
+		return std::nullopt;
+
+	// \n(\d\d)\/(\d\d)\/(\d\d\d\d) - (\d\d):(\d\d):(\d\d):[ \n]
+	const char* p = text.data() + offset;
+	if (p[0] != '\n' ||
+		!IsDigit(p[1]) || !IsDigit(p[2]) || p[3] != '/' ||
+		!IsDigit(p[4]) || !IsDigit(p[5]) || p[6] != '/' ||
+		!IsDigit(p[7]) || !IsDigit(p[8]) || !IsDigit(p[9]) || !IsDigit(p[10]) ||
+		p[11] != ' ' || p[12] != '-' || p[13] != ' ' ||
+		!IsDigit(p[14]) || !IsDigit(p[15]) || p[16] != ':' ||
+		!IsDigit(p[17]) || !IsDigit(p[18]) || p[19] != ':' ||
+		!IsDigit(p[20]) || !IsDigit(p[21]) || p[22] != ':' ||
+		(p[23] != ' ' && p[23] != '\n'))
+	{
+		return std::nullopt;
+	}
+
+	ConsoleLogTimestamp retVal;
+	retVal.m_Offset = offset;
+	retVal.m_Month = Digits2(p + 1);
+	retVal.m_Day = Digits2(p + 4);
+	retVal.m_Year = Digits4(p + 7);
+	retVal.m_Hour = Digits2(p + 14);
+	retVal.m_Minute = Digits2(p + 17);
+	retVal.m_Second = Digits2(p + 20);
+	return retVal;
+}
+
+std::optional<ConsoleLogTimestamp> tf2_bot_detector::FindConsoleLogTimestamp(const std::string_view& text, size_t startPos)
+{
+	if (text.size() < ConsoleLogTimestamp::LENGTH)
+		return std::nullopt;
+
+	// A timestamp can't start any later than this
+	const size_t searchEnd = text.size() - ConsoleLogTimestamp::LENGTH + 1;
+
+	for (size_t pos = startPos; pos < searchEnd; pos++)
+	{
+		pos = s_FindNewline(text.data(), pos, searchEnd);
+		if (pos >= searchEnd)
+			break;
+
+		if (auto result = TryParseConsoleLogTimestamp(text, pos))
+			return result;
+	}
+
+	return std::nullopt;
+}
+
+time_point_t ConsoleLogTimestampConverter::ToTimePoint(const ConsoleLogTimestamp& timestamp)
+{
+	const uint64_t hourKey =
+		uint64_t(timestamp.m_Year) * 1'000'000 +
+		uint64_t(timestamp.m_Month) * 10'000 +
+		uint64_t(timestamp.m_Day) * 100 +
+		uint64_t(timestamp.m_Hour);
+
+	if (hourKey != m_CachedHourKey)
+	{
+		std::tm time{};
+		time.tm_isdst = -1;
+		time.tm_mon = timestamp.m_Month - 1;
+		time.tm_mday = timestamp.m_Day;
+		time.tm_year = timestamp.m_Year - 1900;
+		time.tm_hour = timestamp.m_Hour;
+
+		m_CachedHourStart = std::mktime(&time);
+		m_CachedHourKey = hourKey;
+	}
+
+	return clock_t::from_time_t(m_CachedHourStart + timestamp.m_Minute * 60 + timestamp.m_Second);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Clock.h"
+
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <string_view>
+
+namespace tf2_bot_detector
+{
+	// A "\nMM/DD/YYYY - HH:MM:SS: " line prefix, as written by con_timestamp. The
+	// trailing character may also be a '\n' if the line is empty.
+	struct ConsoleLogTimestamp
+	{
+		static constexpr size_t LENGTH = 24;
+
+		size_t m_Offset = 0; // Offset of the leading '\n'
+
+		int m_Month = 0;     // 1-12
+		int m_Day = 0;       // 1-31
+		int m_Year = 0;
+		int m_Hour = 0;
+		int m_Minute = 0;
+		int m_Second = 0;
+
+		constexpr size_t GetEnd() const { return m_Offset + LENGTH; }
+	};
+
+	// Equivalent to std::regex_search for
+	// \n(\d\d)\/(\d\d)\/(\d\d\d\d) - (\d\d):(\d\d):(\d\d):[ \n]
+	// starting at startPos, but without the regex.
+	std::optional<ConsoleLogTimestamp> FindConsoleLogTimestamp(const std::string_view& text, size_t startPos = 0);
+
+	// Validates and decodes a timestamp at exactly the given offset.
+	std::optional<ConsoleLogTimestamp> TryParseConsoleLogTimestamp(const std::string_view& text, size_t offset);
+
+	// Converts ConsoleLogTimestamps (local time) to time points. Consecutive timestamps
+	// almost always fall within the same hour, so we only pay for std::mktime when the
+	// hour changes.
+	class ConsoleLogTimestampConverter final
+	{
+	public:
+		time_point_t ToTimePoint(const ConsoleLogTimestamp& timestamp);
+
+	private:
+		uint64_t m_CachedHourKey = UINT64_MAX;
+		std::time_t m_CachedHourStart{};
+	};
+}
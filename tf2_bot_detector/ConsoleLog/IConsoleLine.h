@@ -1,10 +1,17 @@
 #pragma once
 
 #include "Clock.h"
+#include "ConsoleLineArena.h"
 
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
 #include <list>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace tf2_bot_detector
 {
@@ -58,6 +65,39 @@ namespace tf2_bot_detector
 		NetChannelChoke,
 		NetChannelFlow,
 		NetChannelTotal,
+
+		COUNT,
+	};
+
+	// Set of ConsoleLineTypes, used by listeners to say which lines they care about
+	class ConsoleLineTypeMask final
+	{
+	public:
+		constexpr ConsoleLineTypeMask() = default;
+		constexpr ConsoleLineTypeMask(std::initializer_list<ConsoleLineType> types)
+		{
+			for (ConsoleLineType type : types)
+				m_Bits |= GetBit(type);
+		}
+
+		static constexpr ConsoleLineTypeMask All() { return ConsoleLineTypeMask(GetBit(ConsoleLineType::COUNT) - 1); }
+
+		constexpr bool Contains(ConsoleLineType type) const { return m_Bits & GetBit(type); }
+		constexpr bool empty() const { return !m_Bits; }
+
+		constexpr ConsoleLineTypeMask& Add(ConsoleLineType type) { m_Bits |= GetBit(type); return *this; }
+
+		constexpr ConsoleLineTypeMask operator|(const ConsoleLineTypeMask& other) const { return ConsoleLineTypeMask(m_Bits | other.m_Bits); }
+		constexpr ConsoleLineTypeMask operator&(const ConsoleLineTypeMask& other) const { return ConsoleLineTypeMask(m_Bits & other.m_Bits); }
+		constexpr ConsoleLineTypeMask& operator|=(const ConsoleLineTypeMask& other) { m_Bits |= other.m_Bits; return *this; }
+		constexpr bool operator==(const ConsoleLineTypeMask&) const = default;
+
+	private:
+		static_assert(size_t(ConsoleLineType::COUNT) < 64);
+		static constexpr uint64_t GetBit(ConsoleLineType type) { return uint64_t(1) << uint64_t(type); }
+
+		explicit constexpr ConsoleLineTypeMask(uint64_t bits) : m_Bits(bits) {}
+		uint64_t m_Bits = 0;
 	};
 
 	enum class ConsoleLineOrdering
@@ -67,6 +107,17 @@ namespace tf2_bot_detector
 		Last,
 	};
 
+	// Profiling counters for a single console line type's parser
+	struct ConsoleLineParserStats
+	{
+		std::string_view m_TypeName;
+		uint64_t m_Attempts = 0;
+		uint64_t m_Hits = 0;
+		uint64_t m_TotalNanoseconds = 0;
+		uint64_t m_MaxNanoseconds = 0;
+		uint64_t m_BytesExamined = 0;
+	};
+
 	class IConsoleLine : public std::enable_shared_from_this<IConsoleLine>
 	{
 	public:
@@ -82,7 +133,19 @@ namespace tf2_bot_detector
 		};
 		virtual void Print(const PrintArgs& args) const = 0;
 
-		static std::shared_ptr<IConsoleLine> ParseConsoleLine(const std::string_view& text, time_point_t timestamp);
+		// Only line types in the mask are parsed. Lines that could only have been parsed as
+		// some other type come back as nullptr, the same as lines nothing recognizes.
+		// If more than one type could parse a line, the first of these to accept it wins:
+		//  1. Types with a matching prefix, shortest prefix first
+		//  2. Types with a matching anchor
+		//  3. Types with neither
+		// Ties within each group go to the type that comes first in ConsoleLineType.
+		static std::shared_ptr<IConsoleLine> ParseConsoleLine(const std::string_view& text, time_point_t timestamp,
+			const ConsoleLineTypeMask& types = ConsoleLineTypeMask::All());
+
+		// Snapshot of the parser counters of every registered line type
+		static std::vector<ConsoleLineParserStats> GetParserStats();
+		static void ResetParserStats();
 
 		time_point_t GetTimestamp() const { return m_Timestamp; }
 
@@ -92,20 +155,29 @@ namespace tf2_bot_detector
 		{
 			TryParseFunc m_TryParseFunc = nullptr;
 			const std::type_info* m_TypeInfo = nullptr;
+			ConsoleLineType m_Type{};
+
+			// Literal text that every line this type can parse starts with. ParseConsoleLine
+			// routes lines through a trie built from these, so TryParse only ever sees lines
+			// starting with one of them.
+			std::span<const std::string_view> m_Prefixes;
+
+			// For types without a fixed prefix: literal text, one of which every parseable line contains.
+			std::span<const std::string_view> m_Anchors;
 
-			size_t m_AutoParseSuccessCount = 0;
+			ConsoleLineParserStats m_Stats; // Only ever accessed through std::atomic_ref
 			bool m_AutoParse = true;
 		};
 
-		//static const ConsoleLineTypeData* GetTypeData() { return s_TypeData; }
-		static void AddTypeData(ConsoleLineTypeData data);
+		static ConsoleLineTypeData* AddTypeData(ConsoleLineTypeData data);
+		static void RecordParseStats(ConsoleLineTypeData& data, size_t bytesExamined,
+			std::chrono::nanoseconds elapsed, bool hit);
 
 	private:
 		time_point_t m_Timestamp;
 
-		static std::list<ConsoleLineTypeData>& GetTypeData();
-		inline static ConsoleLineTypeData* s_TypeData = nullptr;
-		inline static size_t s_TotalParseCount = 0;
+		struct TypeRegistry;
+		static TypeRegistry& GetTypeRegistry();
 	};
 
 	template<typename TSelf, bool AutoParse = true>
@@ -114,19 +186,65 @@ namespace tf2_bot_detector
 	public:
 		ConsoleLineBase(time_point_t timestamp) : IConsoleLine(timestamp) {}
 
+		ConsoleLineType GetType() const override final { return TSelf::LINE_TYPE; }
+
+		// Allocates a TSelf from the current thread's ConsoleLineArena (or a small private one if
+		// there isn't one). Anything passed in that converts to a std::string_view is redirected
+		// to text owned by the arena, so TSelf can simply keep the views.
+		template<typename... TArgs>
+		static std::shared_ptr<TSelf> Create(TArgs&&... args)
+		{
+			std::shared_ptr<ConsoleLineArena> arena = ConsoleLineArena::GetCurrent();
+			if (!arena)
+				arena = std::make_shared<ConsoleLineArena>(nullptr, PRIVATE_ARENA_BLOCK_SIZE);
+
+			auto& arenaRef = *arena;
+			return std::allocate_shared<TSelf>(ConsoleLineArena::Allocator<TSelf>(std::move(arena)),
+				StoreArg(arenaRef, std::forward<TArgs>(args))...);
+		}
+
+		// For line types that are recognized somewhere other than ParseConsoleLine (chat messages)
+		static void RecordParseAttempt(size_t bytesExamined, std::chrono::nanoseconds elapsed, bool hit)
+		{
+			if (s_TypeData)
+				RecordParseStats(*s_TypeData, bytesExamined, elapsed, hit);
+		}
+
 	private:
+		static constexpr size_t PRIVATE_ARENA_BLOCK_SIZE = 512;
+
+		template<typename T>
+		static decltype(auto) StoreArg(ConsoleLineArena& arena, T&& arg)
+		{
+			if constexpr (std::is_convertible_v<T&&, std::string_view>)
+				return arena.Store(std::string_view(arg));
+			else
+				return std::forward<T>(arg);
+		}
+
 		struct AutoRegister
 		{
 			AutoRegister()
 			{
-				AddTypeData(ConsoleLineTypeData
-					{
-						.m_TryParseFunc = &TSelf::TryParse,
-						.m_TypeInfo = &typeid(TSelf),
-						.m_AutoParse = AutoParse
-					});
+				ConsoleLineTypeData data
+				{
+					.m_TryParseFunc = &TSelf::TryParse,
+					.m_TypeInfo = &typeid(TSelf),
+					.m_Type = TSelf::LINE_TYPE,
+					.m_AutoParse = AutoParse
+				};
+
+				// Line types declare either PARSE_PREFIXES or PARSE_ANCHORS. Types with neither
+				// get offered every line that nothing else claimed.
+				if constexpr (requires { TSelf::PARSE_PREFIXES; })
+					data.m_Prefixes = TSelf::PARSE_PREFIXES;
+				else if constexpr (requires { TSelf::PARSE_ANCHORS; })
+					data.m_Anchors = TSelf::PARSE_ANCHORS;
+
+				s_TypeData = AddTypeData(std::move(data));
 			}
 
 		} inline static s_AutoRegister;
+		inline static ConsoleLineTypeData* s_TypeData = nullptr;
 	};
 }
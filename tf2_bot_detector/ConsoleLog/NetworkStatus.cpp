@@ -9,9 +9,6 @@ using namespace tf2_bot_detector;
 using namespace std::string_literals;
 using namespace std::string_view_literals;
 
-// net_status
-static std::regex s_DataPerClientOut(R"regex(           per client out (\d+\.\d), in (\d+\.\d) kB\/s)regex", std::regex::optimize);
-
 SplitPacketLine::SplitPacketLine(time_point_t timestamp, SplitPacket packet) :
 	BaseClass(timestamp), m_Packet(std::move(packet))
 {
@@ -19,9 +16,9 @@ SplitPacketLine::SplitPacketLine(time_point_t timestamp, SplitPacket packet) :
 
 std::shared_ptr<IConsoleLine> SplitPacketLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static std::regex s_Regex(R"regex(<-- \[(.{3})\] Split packet +(\d+)\/ +(\d+) seq +(\d+) size +(\d+) mtu +(\d+) from ([0-9.:a-fA-F]+:\d+))regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(<-- \[(.{3})\] Split packet +(\d+)\/ +(\d+) seq +(\d+) size +(\d+) mtu +(\d+) from ([0-9.:a-fA-F]+:\d+))regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
 		SplitPacket packet;
 
@@ -54,7 +51,7 @@ std::shared_ptr<IConsoleLine> SplitPacketLine::TryParse(const std::string_view&
 		from_chars_throw(result[6], packet.m_MTU);
 		packet.m_Address = result[7].str();
 
-		return std::make_shared<SplitPacketLine>(timestamp, std::move(packet));
+		return SplitPacketLine::Create(timestamp, std::move(packet));
 	}
 
 	return nullptr;
@@ -95,11 +92,11 @@ NetStatusConfigLine::NetStatusConfigLine(time_point_t timestamp,
 
 std::shared_ptr<IConsoleLine> NetStatusConfigLine::TryParse(const std::string_view& text, time_point_t timestamp)
 {
-	static const std::regex s_Regex(R"regex(- Config: (.*), (.*), (\d+) connections)regex", std::regex::optimize);
+	static constexpr ct_regex<R"regex(- Config: (.*), (.*), (\d+) connections)regex"> s_Regex;
 
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
+	if (auto result = s_Regex.match(text))
 	{
-		const std::string_view playerModeStr(&*result[1].first, result[1].length());
+		const std::string_view playerModeStr = to_string_view(result[1]);
 		PlayerMode playerMode;
 		if (playerModeStr == "Multiplayer"sv)
 			playerMode = PlayerMode::Multiplayer;
@@ -111,7 +108,7 @@ std::shared_ptr<IConsoleLine> NetStatusConfigLine::TryParse(const std::string_vi
 			return nullptr;
 		}
 
-		const std::string_view serverModeStr(&*result[2].first, result[2].length());
+		const std::string_view serverModeStr = to_string_view(result[2]);
 		ServerMode serverMode;
 		if (serverModeStr == "dedicated"sv)
 			serverMode = ServerMode::Dedicated;
@@ -126,7 +123,7 @@ std::shared_ptr<IConsoleLine> NetStatusConfigLine::TryParse(const std::string_vi
 		unsigned connectionCount;
 		from_chars_throw(result[3], connectionCount);
 
-		return std::make_shared<NetStatusConfigLine>(timestamp, playerMode, serverMode, connectionCount);
+		return NetStatusConfigLine::Create(timestamp, playerMode, serverMode, connectionCount);
 	}
 
 	return nullptr;
@@ -140,21 +137,6 @@ void NetStatusConfigLine::Print(const PrintArgs& args) const
 		m_ConnectionCount);
 }
 
-bool NetChannelDualFloatLineBase::TryParse(const std::string_view& text,
-	const std::string_view& pattern, float& f0, float& f1)
-{
-	const std::regex s_Regex(pattern.data(), pattern.data() + pattern.size());
-
-	if (svmatch result; std::regex_match(text.begin(), text.end(), result, s_Regex))
-	{
-		from_chars_throw(result[1], f0);
-		from_chars_throw(result[2], f1);
-		return true;
-	}
-
-	return false;
-}
-
 void NetChannelDualFloatLineBase::Print(const IConsoleLine::PrintArgs& args, const std::string_view& fmtStr) const
 {
 	ImGui::TextFmt(fmtStr, m_Float0, m_Float1);
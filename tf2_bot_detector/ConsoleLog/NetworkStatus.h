@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ConsoleLog/IConsoleLine.h"
+#include "Util/RegexUtils.h"
 
 #include <string>
 #include <string_view>
@@ -47,10 +48,11 @@ namespace tf2_bot_detector
 		SplitPacketLine(time_point_t timestamp, SplitPacket packet);
 
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "<-- [" };
 
 		const SplitPacket& GetSplitPacket() const { return m_Packet; }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::SplitPacket; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::SplitPacket;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -77,8 +79,9 @@ namespace tf2_bot_detector
 
 		NetStatusConfigLine(time_point_t timestamp, PlayerMode playerMode, ServerMode serverMode, unsigned connectionCount);
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp);
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- Config: " };
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetStatusConfig; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetStatusConfig;
 		bool ShouldPrint() const override { return false; }
 		void Print(const PrintArgs& args) const override;
 
@@ -98,7 +101,6 @@ namespace tf2_bot_detector
 		constexpr NetChannelDualFloatLineBase(float f0, float f1) : m_Float0(f0), m_Float1(f1) {}
 
 	protected:
-		static bool TryParse(const std::string_view& text, const std::string_view& pattern, float& f0, float& f1);
 		void Print(const IConsoleLine::PrintArgs& args, const std::string_view& fmtStr) const;
 
 		float GetFloat0() const { return m_Float0; }
@@ -117,8 +119,13 @@ namespace tf2_bot_detector
 	public:
 		static std::shared_ptr<IConsoleLine> TryParse(const std::string_view& text, time_point_t timestamp)
 		{
-			if (float f0, f1; NetChannelDualFloatLineBase::TryParse(text, TSelf::REGEX_PATTERN, f0, f1))
-				return std::make_shared<TSelf>(timestamp, f0, f1);
+			if (auto result = TSelf::REGEX.match(text))
+			{
+				float f0, f1;
+				from_chars_throw(result[1], f0);
+				from_chars_throw(result[2], f1);
+				return TSelf::Create(timestamp, f0, f1);
+			}
 
 			return nullptr;
 		}
@@ -149,10 +156,11 @@ namespace tf2_bot_detector
 		float GetLatency() const { return GetFloat0(); }
 		float GetLoss() const { return GetFloat1(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetChannelLatencyLoss; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetChannelLatencyLoss;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- latency: {.1f}, loss {.2f}";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- latency: (\d+\.\d+), loss (\d+\.\d+))regex";
+		static constexpr ct_regex<R"regex(- latency: (\d+\.\d+), loss (\d+\.\d+))regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- latency: " };
 	};
 
 	class NetChannelPacketsLine final : public NetChannelDualFloatLine<NetChannelPacketsLine>
@@ -168,10 +176,11 @@ namespace tf2_bot_detector
 		float GetInPacketsPerSecond() const { return GetFloat0(); }
 		float GetOutPacketsPerSecond() const { return GetFloat1(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetChannelPackets; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetChannelPackets;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- packets: in {.1f}/s, out {.1f}/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- packets: in (\d+\.\d+)\/s, out (\d+\.\d+)\/s)regex";
+		static constexpr ct_regex<R"regex(- packets: in (\d+\.\d+)\/s, out (\d+\.\d+)\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- packets: in " };
 	};
 
 	class NetChannelChokeLine final : public NetChannelDualFloatLine<NetChannelChokeLine>
@@ -185,10 +194,11 @@ namespace tf2_bot_detector
 		float GetInPercentChoke() const { return GetFloat0(); }
 		float GetOutPercentChoke() const { return GetFloat1(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetChannelChoke; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetChannelChoke;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- choke: in {.2f}, out {.2f}";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- choke: in (\d+\.\d+), out (\d+\.\d+))regex";
+		static constexpr ct_regex<R"regex(- choke: in (\d+\.\d+), out (\d+\.\d+))regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- choke: in " };
 	};
 
 	class NetChannelFlowLine final : public NetChannelDualFloatLine<NetChannelFlowLine>
@@ -204,10 +214,11 @@ namespace tf2_bot_detector
 		float GetInKBps() const { return GetFloat0(); }
 		float GetOutKBps() const { return GetFloat1(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetChannelFlow; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetChannelFlow;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- flow: in {.1f}, out {.1f} KB/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- flow: in (\d+\.\d+), out (\d+\.\d+) kB\/s)regex";
+		static constexpr ct_regex<R"regex(- flow: in (\d+\.\d+), out (\d+\.\d+) kB\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- flow: in " };
 	};
 
 	class NetChannelTotalLine final : public NetChannelDualFloatLine<NetChannelTotalLine>
@@ -223,10 +234,11 @@ namespace tf2_bot_detector
 		float GetInMB() const { return GetFloat0(); }
 		float GetOutMB() const { return GetFloat1(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetChannelTotal; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetChannelTotal;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- total: in {.1f}, out {.1f} MB";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- total: in (\d+\.\d+), out (\d+\.\d+) MB)regex";
+		static constexpr ct_regex<R"regex(- total: in (\d+\.\d+), out (\d+\.\d+) MB)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- total: in " };
 	};
 
 	class NetLatencyLine final : public NetChannelDualFloatLine<NetLatencyLine>
@@ -242,10 +254,11 @@ namespace tf2_bot_detector
 		float GetInLatency() const { return GetFloat1(); }
 		float GetOutLatency() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetLatency; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetLatency;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- Latency: avg out {.2f}s, in {.2f}s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- Latency: avg out (\d+\.\d+)s, in (\d+\.\d+)s)regex";
+		static constexpr ct_regex<R"regex(- Latency: avg out (\d+\.\d+)s, in (\d+\.\d+)s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- Latency: avg out " };
 	};
 
 	class NetLossLine final : public NetChannelDualFloatLine<NetLossLine>
@@ -261,10 +274,11 @@ namespace tf2_bot_detector
 		float GetInLossPercent() const { return GetFloat1(); }
 		float GetOutLossPercent() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetLoss; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetLoss;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- Loss:    avg out {.1f}, in {.1f}";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- Loss:    avg out (\d+\.\d+), in (\d+\.\d+))regex";
+		static constexpr ct_regex<R"regex(- Loss:    avg out (\d+\.\d+), in (\d+\.\d+))regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- Loss:    avg out " };
 	};
 
 	class NetPacketsTotalLine final : public NetChannelDualFloatLine<NetPacketsTotalLine>
@@ -280,10 +294,11 @@ namespace tf2_bot_detector
 		float GetInPacketsPerSecond() const { return GetFloat1(); }
 		float GetOutPacketsPerSecond() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetPacketsTotal; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetPacketsTotal;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- Packets: net total out  {.1f}/s, in {.1f}/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- Packets: net total out  (\d+\.\d)\/s, in (\d+\.\d)\/s)regex";
+		static constexpr ct_regex<R"regex(- Packets: net total out  (\d+\.\d)\/s, in (\d+\.\d)\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- Packets: net total out  " };
 	};
 
 	class NetPacketsPerClientLine final : public NetChannelDualFloatLine<NetPacketsPerClientLine>
@@ -299,10 +314,11 @@ namespace tf2_bot_detector
 		float GetInPacketsPerSecond() const { return GetFloat1(); }
 		float GetOutPacketsPerSecond() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetPacketsPerClient; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetPacketsPerClient;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "           per client out {.1f}/s, in {.1f}/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(           per client out (\d+\.\d)\/s, in (\d+\.\d)\/s)regex";
+		static constexpr ct_regex<R"regex(           per client out (\d+\.\d)\/s, in (\d+\.\d)\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "           per client out " };
 	};
 
 	class NetDataTotalLine final : public NetChannelDualFloatLine<NetDataTotalLine>
@@ -318,10 +334,11 @@ namespace tf2_bot_detector
 		float GetInKBps() const { return GetFloat1(); }
 		float GetOutKBps() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetDataTotal; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetDataTotal;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "- Data:    net total out  {.1f}, in {.1f} kB/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(- Data:    net total out  (\d+\.\d), in (\d+\.\d) kB\/s)regex";
+		static constexpr ct_regex<R"regex(- Data:    net total out  (\d+\.\d), in (\d+\.\d) kB\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "- Data:    net total out  " };
 	};
 
 	class NetDataPerClientLine final : public NetChannelDualFloatLine<NetDataPerClientLine>
@@ -337,9 +354,10 @@ namespace tf2_bot_detector
 		float GetInKBps() const { return GetFloat1(); }
 		float GetOutKBps() const { return GetFloat0(); }
 
-		ConsoleLineType GetType() const override { return ConsoleLineType::NetDataPerClient; }
+		static constexpr ConsoleLineType LINE_TYPE = ConsoleLineType::NetDataPerClient;
 
 		static constexpr std::string_view PRINT_FORMAT_STRING =  "           per client out {.1f}, in {.1f} kB/s";
-		static constexpr std::string_view REGEX_PATTERN = R"regex(           per client out (\d+\.\d), in (\d+\.\d) kB\/s)regex";
+		static constexpr ct_regex<R"regex(           per client out (\d+\.\d), in (\d+\.\d) kB\/s)regex"> REGEX{};
+		static constexpr std::string_view PARSE_PREFIXES[] = { "           per client out " };
 	};
 }
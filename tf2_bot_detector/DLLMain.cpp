@@ -1,14 +1,19 @@
 #include "DLLMain.h"
 
+#include "Config/Settings.h"
 #include "Tests/Tests.h"
 #include "UI/MainWindow.h"
 #include "Util/TextUtils.h"
 #include "Log.h"
 #include "Filesystem.h"
+#include "ModeratorLogic.h"
+#include "WorldJournal.h"
 
 #include <imgui_desktop/Application.h>
 #include <mh/text/string_insertion.hpp>
 
+#include <fstream>
+
 #ifdef WIN32
 #include "Platform/Windows/WindowsHelpers.h"
 #include <Windows.h>
@@ -29,6 +34,46 @@ namespace tf2_bot_detector
 	{
 		DebugLog(location, "[ImGuiDesktop] {}", msg);
 	}
+
+	static int ReplayJournalFile(const std::filesystem::path& path) try
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.good())
+		{
+			LogError("Failed to open journal {}", path);
+			return 1;
+		}
+
+		Settings settings;
+
+		// Copied up front, so marks made during the replay can't end up in the user's lists
+		const auto moderatorConfig = ModeratorConfig::CopyFromConfigFiles();
+		const auto result = ReplayJournal(file, settings, &moderatorConfig);
+
+		Log("Replayed {}: {} records ({} KB of console log, {} game command responses, {} HTTP responses)",
+			path, result.m_RecordCount, result.m_ConsoleLogBytes / 1024, result.m_GameCommandOutputCount,
+			result.m_HTTPResponseCount);
+		Log("{:1.1f} seconds of recorded session took {:1.3f} seconds to replay, {} actions were queued, {} players were left",
+			std::chrono::duration<double>(result.m_RecordedDuration).count(),
+			std::chrono::duration<double>(result.m_ReplayDuration).count(), result.m_QueuedActionCount,
+			result.m_PlayerCount);
+
+		if (result.m_DeliveryTimeoutCount > 0)
+			LogWarning("Gave up waiting for parsed lines {} times, so results may differ", result.m_DeliveryTimeoutCount);
+
+		if (result.m_HTTPUnansweredCount > 0)
+		{
+			LogWarning("{} of the lookups made in {} HTTP requests had no recorded response, so results may differ",
+				result.m_HTTPUnansweredCount, result.m_HTTPRequestCount);
+		}
+
+		return 0;
+	}
+	catch (...)
+	{
+		LogException("Failed to replay journal {}", path);
+		return 1;
+	}
 }
 
 TF2_BOT_DETECTOR_EXPORT int tf2_bot_detector::RunProgram(int argc, const char** argv)
@@ -73,8 +118,12 @@ TF2_BOT_DETECTOR_EXPORT int tf2_bot_detector::RunProgram(int argc, const char**
 
 	for (int i = 1; i < argc; i++)
 	{
+		if (!strcmp(argv[i], "--record-journal"))
+			IJournalRecorder::GetInstance().Start();
+		else if (!strcmp(argv[i], "--replay-journal") && (i + 1) < argc)
+			return tf2_bot_detector::ReplayJournalFile(argv[i + 1]);
 #ifdef _DEBUG
-		if (!strcmp(argv[i], "--static-seed") && (i + 1) < argc)
+		else if (!strcmp(argv[i], "--static-seed") && (i + 1) < argc)
 			tf2_bot_detector::g_StaticRandomSeed = atoi(argv[i + 1]);
 		else if (!strcmp(argv[i], "--allow-open-tf2"))
 			tf2_bot_detector::g_SkipOpenTF2Check = true;
@@ -713,12 +713,30 @@ namespace
 		void QueueUpdate() { m_WantsUpdate = true; }
 		void Update() override;
 
-		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) override;
+		void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override;
 		void OnLocalPlayerSpawned(IWorldState& world, TFClassType classType) override;
 
 	private:
 		mh::thread_sentinel m_Sentinel;
 
+		static constexpr ConsoleLineTypeMask CONSOLE_LINE_INTERESTS =
+		{
+			ConsoleLineType::Connecting,
+			ConsoleLineType::HostNewGame,
+			ConsoleLineType::InQueue,
+			ConsoleLineType::LobbyChanged,
+			ConsoleLineType::LobbyHeader,
+			ConsoleLineType::LobbyStatusFailed,
+			ConsoleLineType::NetStatusConfig,
+			ConsoleLineType::PartyHeader,
+			ConsoleLineType::PlayerStatusIP,
+			ConsoleLineType::PlayerStatusMapPosition,
+			ConsoleLineType::QueueStateChange,
+			ConsoleLineType::SVC_UserMessage,
+			ConsoleLineType::ServerJoin,
+		};
+		void OnConsoleLineParsed(IConsoleLine& line);
+
 		std::unique_ptr<discord::Core> m_Core;
 		time_point_t m_LastDiscordInitializeTime{};
 
@@ -738,7 +756,7 @@ namespace
 
 DiscordState::DiscordState(const Settings& settings, IWorldState& world) :
 	AutoWorldEventListener(world),
-	AutoConsoleLineListener(world),
+	AutoConsoleLineListener(world, CONSOLE_LINE_INTERESTS),
 	m_Settings(settings),
 	m_WorldState(world),
 	m_GameState(settings, m_DRPInfo),
@@ -751,17 +769,23 @@ DiscordState::~DiscordState()
 	DiscordDebugLog(MH_SOURCE_LOCATION_CURRENT());
 }
 
-void DiscordState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& line)
+void DiscordState::OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines)
 {
 	m_Sentinel.check();
 
+	for (IConsoleLine& line : lines)
+		OnConsoleLineParsed(line);
+}
+
+void DiscordState::OnConsoleLineParsed(IConsoleLine& line)
+{
 	switch (line.GetType())
 	{
 	case ConsoleLineType::PlayerStatusMapPosition:
 	{
 		QueueUpdate();
 		auto& statusLine = static_cast<const ServerStatusMapLine&>(line);
-		m_GameState.SetMapName(statusLine.GetMapName());
+		m_GameState.SetMapName(std::string(statusLine.GetMapName()));
 		break;
 	}
 	case ConsoleLineType::PartyHeader:
@@ -810,7 +834,7 @@ void DiscordState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& line)
 	{
 		QueueUpdate();
 		auto& joinLine = static_cast<const ServerJoinLine&>(line);
-		m_GameState.SetMapName(joinLine.GetMapName());
+		m_GameState.SetMapName(std::string(joinLine.GetMapName()));
 		// Not necessarily in a lobby at this point, but in-lobby state will be reapplied soon if we are in a lobby
 		m_GameState.SetInLobby(false);
 		break;
@@ -5,4 +5,8 @@
 namespace tf2_bot_detector
 {
 	mh::dispatcher& GetDispatcher();
+
+	// Wakes the main loop if it's sleeping, so work just queued on GetDispatcher() runs now
+	// instead of whenever the window next wakes up. Safe to call from any thread.
+	void WakeMainThread();
 }
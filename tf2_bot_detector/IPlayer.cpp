@@ -2,6 +2,8 @@
 #include "WorldState.h"
 #include "Util/TextUtils.h"
 
+#include <atomic>
+
 using namespace tf2_bot_detector;
 
 duration_t IPlayer::GetTimeSinceLastStatusUpdate() const
@@ -32,3 +34,22 @@ std::string IPlayer::GetNameSafe() const
 {
 	return CollapseNewlines(GetNameUnsafe());
 }
+
+size_t PlayerDataStorage::AllocateSlot()
+{
+	static std::atomic<size_t> s_NextSlot = 0;
+	return s_NextSlot++;
+}
+
+auto PlayerDataStorage::GetOrCreateSlot(size_t slot) -> value_ptr&
+{
+	if (slot >= m_Slots.size())
+		m_Slots.resize(slot + 1);
+
+	return m_Slots[slot];
+}
+
+size_t PlayerDataStorage::GetApproxMemoryUsage() const
+{
+	return m_Slots.capacity() * sizeof(value_ptr);
+}
@@ -6,11 +6,12 @@
 
 #include <mh/error/expected.hpp>
 
-#include <any>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <ostream>
-#include <typeindex>
+#include <type_traits>
+#include <vector>
 
 namespace tf2_bot_detector
 {
@@ -38,6 +39,74 @@ namespace tf2_bot_detector
 		uint16_t m_LocalDeaths = 0;
 	};
 
+	// Arbitrary data attached to a player by other systems (the UI, moderator logic, etc).
+	// Each type gets its own slot index the first time it is used anywhere, so a lookup is
+	// just an index into a small array.
+	class PlayerDataStorage final
+	{
+	public:
+		template<typename T> T* Get()
+		{
+			return const_cast<T*>(std::as_const(*this).Get<T>());
+		}
+		template<typename T> const T* Get() const
+		{
+			const size_t slot = GetSlot<T>();
+			if (slot < m_Slots.size())
+				return static_cast<const T*>(m_Slots[slot].get());
+
+			return nullptr;
+		}
+		template<typename T, typename... TArgs> T& GetOrCreate(TArgs&&... args)
+		{
+			using value_type = std::remove_cvref_t<T>;
+			auto& data = GetOrCreateSlot(GetSlot<value_type>());
+			if (!data)
+				data = value_ptr(new value_type(std::forward<TArgs>(args)...), Deleter{ &Delete<value_type> });
+
+			return *static_cast<value_type*>(data.get());
+		}
+		template<typename T> T& Set(T&& value)
+		{
+			using value_type = std::decay_t<T>;
+			auto& data = GetOrCreateSlot(GetSlot<value_type>());
+			data = value_ptr(new value_type(std::forward<T>(value)), Deleter{ &Delete<value_type> });
+			return *static_cast<value_type*>(data.get());
+		}
+
+		size_t GetApproxMemoryUsage() const;
+
+	private:
+		struct Deleter
+		{
+			void (*m_Func)(void*) = nullptr;
+			void operator()(void* data) const { m_Func(data); }
+		};
+		using value_ptr = std::unique_ptr<void, Deleter>;
+
+		template<typename T> static void Delete(void* data) { delete static_cast<T*>(data); }
+
+		static size_t AllocateSlot();
+		template<typename T> static size_t GetSlot()
+		{
+			// Otherwise Get<const T>() would look in a different slot than Set(T{})
+			using value_type = std::remove_cvref_t<T>;
+			if constexpr (!std::is_same_v<T, value_type>)
+			{
+				return GetSlot<value_type>();
+			}
+			else
+			{
+				static const size_t s_Slot = AllocateSlot();
+				return s_Slot;
+			}
+		}
+
+		value_ptr& GetOrCreateSlot(size_t slot);
+
+		std::vector<value_ptr> m_Slots;
+	};
+
 	class IPlayer : public std::enable_shared_from_this<IPlayer>
 	{
 	public:
@@ -86,32 +155,26 @@ namespace tf2_bot_detector
 
 		template<typename T> inline T* GetData()
 		{
-			return const_cast<T*>(std::as_const(*this).GetData<T>());
+			return GetDataStorage().Get<T>();
 		}
 		template<typename T, typename... TArgs> inline T& GetOrCreateData(TArgs&&... args)
 		{
-			auto& storage = GetOrCreateDataStorage(typeid(T));
-			if (!storage.has_value())
-				return storage.emplace<T>(std::forward<TArgs>(args)...);
-			else
-				return std::any_cast<T&>(storage);
+			return GetDataStorage().GetOrCreate<T>(std::forward<TArgs>(args)...);
 		}
 		template<typename T> inline const T* GetData() const
 		{
-			return std::any_cast<T>(FindDataStorage(typeid(T)));
+			return GetDataStorage().Get<T>();
 		}
-		template<typename T> inline bool SetData(T&& value)
+		template<typename T> inline T& SetData(T&& value)
 		{
-			GetOrCreateDataStorage(typeid(T)) = std::move(value);
+			return GetDataStorage().Set(std::forward<T>(value));
 		}
 
-		virtual std::any& GetOrCreateDataStorage(const std::type_index& type) = 0;
-
 	protected:
-		virtual const std::any* FindDataStorage(const std::type_index& type) const = 0;
-		virtual std::any* FindDataStorage(const std::type_index& type)
+		virtual const PlayerDataStorage& GetDataStorage() const = 0;
+		virtual PlayerDataStorage& GetDataStorage()
 		{
-			return const_cast<std::any*>(std::as_const(*this).FindDataStorage(type));
+			return const_cast<PlayerDataStorage&>(std::as_const(*this).GetDataStorage());
 		}
 	};
 }
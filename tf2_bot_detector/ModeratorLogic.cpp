@@ -1,24 +1,30 @@
 #include "ModeratorLogic.h"
 #include "Actions/Actions.h"
 #include "Actions/RCONActionManager.h"
+#include "Config/ConfigHelpers.h"
 #include "Config/PlayerListJSON.h"
 #include "Config/Rules.h"
 #include "Config/Settings.h"
 #include "ConsoleLog/ConsoleLineListener.h"
 #include "ConsoleLog/IConsoleLine.h"
 #include "ConsoleLog/ConsoleLines.h"
+#include "Filesystem.h"
 #include "GameData/UserMessageType.h"
 #include "IPlayer.h"
 #include "Log.h"
 #include "PlayerStatus.h"
+#include "PlayerTable.h"
 #include "WorldEventListener.h"
+#include "WorldJournal.h"
 #include "WorldState.h"
 
 #include <mh/algorithm/algorithm_generic.hpp>
 #include <mh/text/case_insensitive_string.hpp>
 #include <mh/text/fmtstr.hpp>
 #include <mh/text/string_insertion.hpp>
+#include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <iomanip>
 #include <map>
 #include <regex>
@@ -60,7 +66,8 @@ namespace
 	class ModeratorLogic final : public IModeratorLogic, AutoConsoleLineListener, AutoWorldEventListener
 	{
 	public:
-		ModeratorLogic(IWorldState& world, const Settings& settings, IRCONActionManager& actionManager);
+		ModeratorLogic(IWorldState& world, const Settings& settings, IRCONActionManager& actionManager,
+			WallClockFunc wallClock, const ModeratorConfig* fixedConfig);
 
 		void Update() override;
 
@@ -97,6 +104,7 @@ namespace
 
 		size_t GetBlacklistedPlayerCount() const override { return m_PlayerList.GetPlayerCount(); }
 		size_t GetRuleCount() const override { return m_Rules.GetRuleCount(); }
+		RuleMatchCacheStats GetRuleMatchCacheStats() const override { return m_RuleMatchCacheStats; }
 
 		void ReloadConfigFiles() override;
 
@@ -106,6 +114,7 @@ namespace
 		IWorldState* m_World = nullptr;
 		const Settings* m_Settings = nullptr;
 		IRCONActionManager* m_ActionManager = nullptr;
+		WallClockFunc m_WallClock;
 
 		struct PlayerExtraData
 		{
@@ -123,19 +132,33 @@ namespace
 				time_point_t m_LastTransmission{};
 				duration_t m_TotalTransmissions{};
 			} m_Voice;
+
+			PlayerRuleMatches m_RuleMatches;
 		};
 
+		RuleMatchCacheStats m_RuleMatchCacheStats;
+
 		// Steam IDs of players that we think are running the tool.
 		std::unordered_set<SteamID> m_PlayersRunningTool;
 
 		void OnPlayerStatusUpdate(IWorldState& world, const IPlayer& player) override;
 		void OnChatMsg(IWorldState& world, IPlayer& player, const std::string_view& msg) override;
 
-		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) override;
+		static constexpr ConsoleLineTypeMask CONSOLE_LINE_INTERESTS =
+		{
+			ConsoleLineType::ClientReachedServerSpawn,
+			ConsoleLineType::SVC_UserMessage,
+		};
+		void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override;
+		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line);
 		void OnUserMessageReceived(IWorldState& world, const SVCUserMessageLine& userMsg);
 
 		void OnRuleMatch(const ModerationRule& rule, const IPlayer& player);
 
+		// Tells the world state whether the player list has anything on them, so they're
+		// prefetched first. Needed whenever the player list changes.
+		void SyncPlayerMarked(const SteamID& id);
+
 		// How long inbetween accusations
 		static constexpr duration_t CHEATER_WARNING_INTERVAL = std::chrono::seconds(20);
 
@@ -168,20 +191,17 @@ namespace
 
 		struct VoteStateHelper
 		{
-			VoteStateHelper(VoteState state = VoteState::Inactive) :
-				m_Value(state), m_LastChangedTime(tfbd_clock_t::now())
-			{
-			}
-
 			VoteState GetValue() const { return m_Value; }
 			operator VoteState() const { return GetValue(); }
 
+			void Set(VoteState state, time_point_t time) { m_Value = state; m_LastChangedTime = time; }
+
 			time_point_t GetLastChangedTime() const { return m_LastChangedTime; }
-			duration_t GetTimeSinceLastChanged() const { return tfbd_clock_t::now() - m_LastChangedTime; }
+			duration_t GetTimeSinceLastChanged(time_point_t now) const { return now - m_LastChangedTime; }
 
 		private:
-			time_point_t m_LastChangedTime;
-			VoteState m_Value;
+			time_point_t m_LastChangedTime{}; // World time
+			VoteState m_Value = VoteState::Inactive;
 
 		} m_VoteState;
 
@@ -192,7 +212,7 @@ namespace
 		// Minimum interval between callvote commands (the 150 comes from the default value of sv_vote_creation_timer)
 		static constexpr duration_t MIN_VOTEKICK_INTERVAL = std::chrono::seconds(150);
 		time_point_t m_LastVoteCallTime{}; // Last time we called a votekick on someone
-		duration_t GetTimeSinceLastCallVote() const { return tfbd_clock_t::now() - m_LastVoteCallTime; }
+		duration_t GetTimeSinceLastCallVote() const { return m_World->GetCurrentTime() - m_LastVoteCallTime; }
 
 		PlayerListJSON m_PlayerList;
 		ModerationRules m_Rules;
@@ -224,10 +244,75 @@ namespace
 	}
 }
 
+ModeratorConfig ModeratorConfig::CopyFromConfigFiles()
+{
+	// Every list in cfg/ with this base name, in the order ConfigFileGroupBase loads them
+	const auto ForEachFile = [](const std::string_view& baseName, const auto& func)
+	{
+		const auto paths = GetConfigFilePaths(baseName);
+
+		std::vector<std::filesystem::path> files;
+		if (!paths.m_Official.empty())
+			files.push_back(paths.m_Official);
+		if (!paths.m_User.empty())
+			files.push_back(paths.m_User);
+		files.insert(files.end(), paths.m_Others.begin(), paths.m_Others.end());
+
+		for (const auto& file : files)
+		{
+			try
+			{
+				func(nlohmann::json::parse(IFilesystem::Get().ReadFile(file)));
+			}
+			catch (...)
+			{
+				LogException("Failed to copy {}, leaving it out", file);
+			}
+		}
+	};
+
+	nlohmann::json rules = nlohmann::json::array();
+	ForEachFile("rules", [&](const nlohmann::json& json)
+		{
+			for (const auto& rule : json.at("rules"))
+				rules.push_back(rule);
+		});
+
+	// The same player can be in more than one list, with different attributes in each
+	nlohmann::json players = nlohmann::json::array();
+	std::map<std::string, size_t> playerIndices;
+	ForEachFile("playerlist", [&](const nlohmann::json& json)
+		{
+			for (const auto& player : json.at("players"))
+			{
+				const auto [it, inserted] = playerIndices.emplace(player.at("steamid").get<SteamID>().str(), players.size());
+				if (inserted)
+				{
+					players.push_back(player);
+					continue;
+				}
+
+				auto& attributes = players[it->second]["attributes"];
+				for (const auto& attribute : player.at("attributes"))
+				{
+					if (std::find(attributes.begin(), attributes.end(), attribute) == attributes.end())
+						attributes.push_back(attribute);
+				}
+			}
+		});
+
+	return ModeratorConfig
+	{
+		.m_Rules = nlohmann::json{ { "rules", std::move(rules) } }.dump(),
+		.m_PlayerList = nlohmann::json{ { "players", std::move(players) } }.dump(),
+	};
+}
+
 std::unique_ptr<IModeratorLogic> IModeratorLogic::Create(IWorldState& world,
-	const Settings& settings, IRCONActionManager& actionManager)
+	const Settings& settings, IRCONActionManager& actionManager, WallClockFunc wallClock,
+	const ModeratorConfig* fixedConfig)
 {
-	return std::make_unique<ModeratorLogic>(world, settings, actionManager);
+	return std::make_unique<ModeratorLogic>(world, settings, actionManager, std::move(wallClock), fixedConfig);
 }
 
 void ModeratorLogic::HandleVoteStateTimeouts()
@@ -241,7 +326,8 @@ void ModeratorLogic::HandleVoteStateTimeouts()
 	case VoteState::LocalOwner:
 	case VoteState::SentCallVote:
 	{
-		auto elapsed = m_VoteState.GetTimeSinceLastChanged();
+		const auto now = m_World->GetCurrentTime();
+		auto elapsed = m_VoteState.GetTimeSinceLastChanged(now);
 		const auto maxWaitTime = m_VoteState == VoteState::SentCallVote ? MAX_WAIT_VOTESTATE_CALLVOTESENT : MAX_WAIT_VOTESTATE_VOTEACTIVE;
 
 		if (elapsed > maxWaitTime)
@@ -253,7 +339,7 @@ void ModeratorLogic::HandleVoteStateTimeouts()
 			if (m_VoteState == VoteState::LocalOwner)
 				m_LastVoteCallTime = {};
 
-			m_VoteState = NEW_VOTE_STATE;
+			m_VoteState.Set(NEW_VOTE_STATE, now);
 		}
 		break;
 	}
@@ -262,6 +348,7 @@ void ModeratorLogic::HandleVoteStateTimeouts()
 
 void ModeratorLogic::Update()
 {
+	m_Rules.Update();
 	HandleVoteStateTimeouts();
 	ProcessPlayerActions();
 }
@@ -292,14 +379,26 @@ void ModeratorLogic::OnPlayerStatusUpdate(IWorldState& world, const IPlayer& pla
 
 	if (m_Settings->m_AutoMark)
 	{
-		for (const ModerationRule& rule : m_Rules.GetRules())
-		{
-			if (!rule.Match(player))
-				continue;
+		const auto rules = m_Rules.GetCompiledRules();
 
-			OnRuleMatch(rule, player);
-		}
+		auto& ruleMatches = world.FindPlayer(steamID)->GetOrCreateData<PlayerExtraData>().m_RuleMatches;
+		if (ruleMatches.Update(*rules, player))
+			m_RuleMatchCacheStats.m_Hits++;
+		else
+			m_RuleMatchCacheStats.m_Misses++;
+
+		// Still applied every time, the same as if we'd run the rules again
+		for (size_t ruleIndex : ruleMatches.GetMatchedRules())
+			OnRuleMatch(rules->GetRules()[ruleIndex], player);
 	}
+
+	// Also catches entries from lists that finished loading in the background
+	SyncPlayerMarked(steamID);
+}
+
+void ModeratorLogic::SyncPlayerMarked(const SteamID& id)
+{
+	m_World->SetPlayerMarked(id, !!m_PlayerList.GetPlayerAttributes(id));
 }
 
 static bool IsCheaterConnectedWarning(const std::string_view& msg)
@@ -344,17 +443,21 @@ void ModeratorLogic::OnChatMsg(IWorldState& world, IPlayer& player, const std::s
 
 	if (m_Settings->m_AutoMark && !botMsgDetected)
 	{
-		for (const ModerationRule& rule : m_Rules.GetRules())
+		const auto rules = m_Rules.GetCompiledRules();
+		for (const ModerationRule& rule : rules->FindMatches(player, msg))
 		{
-			if (!rule.Match(player, msg))
-				continue;
-
 			OnRuleMatch(rule, player);
 			Log("Chat message rule match for {}: {}", rule.m_Description, std::quoted(msg));
 		}
 	}
 }
 
+void ModeratorLogic::OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines)
+{
+	for (IConsoleLine& line : lines)
+		OnConsoleLineParsed(world, line);
+}
+
 void ModeratorLogic::OnConsoleLineParsed(IWorldState& world, IConsoleLine& baseLine)
 {
 	switch (baseLine.GetType())
@@ -363,7 +466,7 @@ void ModeratorLogic::OnConsoleLineParsed(IWorldState& world, IConsoleLine& baseL
 
 	case ConsoleLineType::ClientReachedServerSpawn:
 	{
-		m_VoteState = VoteState::Inactive;
+		m_VoteState.Set(VoteState::Inactive, baseLine.GetTimestamp());
 		m_LastVoteCallTime = {};
 		break;
 	}
@@ -383,7 +486,7 @@ void ModeratorLogic::OnUserMessageReceived(IWorldState& world, const SVCUserMess
 		assert(newVoteState == VoteState::Inactive || m_VoteState != newVoteState);
 
 		const auto oldVoteState = m_VoteState;
-		m_VoteState = newVoteState;
+		m_VoteState.Set(newVoteState, userMsg.GetTimestamp());
 		DebugLogWarning(VOTESTATUS_COLOR, location, "Received {}: {} -> {}", mh::enum_fmt(userMsgType),
 			mh::enum_fmt(oldVoteState.GetValue()), mh::enum_fmt(m_VoteState.GetValue()));
 	};
@@ -557,7 +660,7 @@ void ModeratorLogic::HandleEnemyCheaters(uint8_t enemyPlayerCount,
 
 void ModeratorLogic::HandleConnectedEnemyCheaters(const std::vector<Cheater>& enemyCheaters)
 {
-	const auto now = tfbd_clock_t::now();
+	const auto now = m_World->GetCurrentTime();
 
 	// There are enough people on the other team to votekick the cheater(s)
 	std::string logMsg = mh::format("Telling the other team about {} cheater(s) named ", enemyCheaters.size());
@@ -675,7 +778,7 @@ void ModeratorLogic::HandleConnectingEnemyCheaters(const std::vector<Cheater>& c
 	if (!m_Settings->m_AutoChatWarnings || !m_Settings->m_AutoChatWarningsConnecting)
 		return;  // user has disabled this functionality
 
-	const auto now = tfbd_clock_t::now();
+	const auto now = m_World->GetCurrentTime();
 	if (now < m_NextConnectingCheaterWarningTime)
 	{
 		DebugLog("HandleEnemyCheaters(): Discarding connection warnings ("s
@@ -768,8 +871,8 @@ void ModeratorLogic::ProcessPlayerActions()
 	}
 
 	// Don't process actions if we're way out of date
-	[[maybe_unused]] const auto dbgDeltaTime = to_seconds(tfbd_clock_t::now() - now);
-	if ((tfbd_clock_t::now() - now) > 15s)
+	[[maybe_unused]] const auto dbgDeltaTime = to_seconds(m_WallClock() - now);
+	if ((m_WallClock() - now) > 15s)
 		return;
 
 	const auto myTeam = TryGetMyTeam();
@@ -786,11 +889,16 @@ void ModeratorLogic::ProcessPlayerActions()
 
 	const bool isBotLeader = IsBotLeader();
 	bool needsEnemyWarning = false;
-	for (IPlayer& player : m_World->GetLobbyMembers())
+	const PlayerTable& table = m_World->GetPlayerTable();
+	for (size_t i = 0; i < table.size(); i++)
 	{
-		const bool isPlayerConnected = player.GetConnectionState() == PlayerStatusState::Active;
+		if (!table.m_LobbyTeams[i])
+			continue; // Not a lobby member
+
+		IPlayer& player = *table.m_Players[i];
+		const bool isPlayerConnected = table.m_States[i] == PlayerStatusState::Active;
 		const auto isCheater = m_PlayerList.HasPlayerAttributes(player, PlayerAttribute::Cheater);
-		const auto teamShareResult = m_World->GetTeamShareResult(*myTeam, player);
+		const auto teamShareResult = IWorldState::GetTeamShareResult(*myTeam, table.m_LobbyTeams[i]);
 		if (teamShareResult == TeamShareResult::SameTeams)
 		{
 			if (isPlayerConnected)
@@ -857,6 +965,9 @@ bool ModeratorLogic::SetPlayerAttribute(const IPlayer& player, PlayerAttribute a
 			return ModifyPlayerAction::Modified;
 		});
 
+	if (attributeChanged)
+		SyncPlayerMarked(player.GetSteamID());
+
 	return attributeChanged;
 }
 
@@ -938,6 +1049,9 @@ void ModeratorLogic::ReloadConfigFiles()
 {
 	m_PlayerList.LoadFiles();
 	m_Rules.LoadFiles();
+
+	for (const IPlayer& player : std::as_const(*m_World).GetPlayers())
+		SyncPlayerMarked(player.GetSteamID());
 }
 
 std::optional<VoteCooldown> ModeratorLogic::GetVoteCooldown() const
@@ -952,15 +1066,24 @@ std::optional<VoteCooldown> ModeratorLogic::GetVoteCooldown() const
 	return cd;
 }
 
-ModeratorLogic::ModeratorLogic(IWorldState& world, const Settings& settings, IRCONActionManager& actionManager) :
-	AutoConsoleLineListener(world),
+ModeratorLogic::ModeratorLogic(IWorldState& world, const Settings& settings, IRCONActionManager& actionManager,
+	WallClockFunc wallClock, const ModeratorConfig* fixedConfig) :
+	AutoConsoleLineListener(world, CONSOLE_LINE_INTERESTS),
 	AutoWorldEventListener(world),
 	m_World(&world),
 	m_Settings(&settings),
 	m_ActionManager(&actionManager),
-	m_PlayerList(settings),
-	m_Rules(settings)
+	m_WallClock(std::move(wallClock)),
+	m_PlayerList(fixedConfig ?
+		PlayerListJSON(settings, nlohmann::json::parse(fixedConfig->m_PlayerList)) : PlayerListJSON(settings)),
+	m_Rules(fixedConfig ?
+		ModerationRules(settings, nlohmann::json::parse(fixedConfig->m_Rules)) : ModerationRules(settings))
 {
+	if (auto& recorder = IJournalRecorder::GetInstance(); recorder.IsRecording())
+	{
+		const JournalModeratorHeader header(settings, GetRuleCount(), GetBlacklistedPlayerCount());
+		recorder.Record(JournalRecordType::ModeratorHeader, nlohmann::json(header).dump());
+	}
 }
 
 PlayerMarks ModeratorLogic::GetPlayerAttributes(const SteamID& id) const
@@ -990,8 +1113,8 @@ bool ModeratorLogic::InitiateVotekick(const IPlayer& player, KickReason reason,
 
 		Log(std::move(logMsg));
 
-		m_LastVoteCallTime = tfbd_clock_t::now();
-		m_VoteState = VoteState::SentCallVote;
+		m_LastVoteCallTime = m_World->GetCurrentTime();
+		m_VoteState.Set(VoteState::SentCallVote, m_LastVoteCallTime);
 	}
 
 	return true;
@@ -1,8 +1,12 @@
 #pragma once
 
+#include "Clock.h"
+
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <string>
 
 namespace tf2_bot_detector
 {
@@ -28,18 +32,44 @@ namespace tf2_bot_detector
 		float GetProgress() const;
 	};
 
+	// How often player status updates were able to skip running the rules, because the
+	// player's name, avatar and the rules themselves were the same as last time
+	struct RuleMatchCacheStats
+	{
+		size_t m_Hits = 0;
+		size_t m_Misses = 0;
+	};
+
 	enum class AttributePersistence
 	{
 		Saved,
 		Transient,
 	};
 
+	// Rules and a player list for ModeratorLogic to use instead of everything in cfg/, in the
+	// same json format as rules.json and playerlist.json. Nothing is written back. For tests and
+	// journal replays that shouldn't depend on what the machine running them has installed.
+	struct ModeratorConfig
+	{
+		// Copies of the rules and player lists in cfg/ (official, user and third party), each
+		// merged into one list. Files that fail to load are skipped.
+		static ModeratorConfig CopyFromConfigFiles();
+
+		std::string m_Rules;
+		std::string m_PlayerList;
+	};
+
 	class IModeratorLogic
 	{
 	public:
 		virtual ~IModeratorLogic() = default;
 
-		static std::unique_ptr<IModeratorLogic> Create(IWorldState& world, const Settings& settings, IRCONActionManager& actionManager);
+		// Everything else goes by world time. The wall clock is only used to tell how far behind
+		// the game we are, so journal replays pass the time each record was written instead.
+		using WallClockFunc = std::function<time_point_t()>;
+		static std::unique_ptr<IModeratorLogic> Create(IWorldState& world, const Settings& settings,
+			IRCONActionManager& actionManager, WallClockFunc wallClock = &tfbd_clock_t::now,
+			const ModeratorConfig* fixedConfig = nullptr);
 
 		virtual void Update() = 0;
 
@@ -58,6 +88,7 @@ namespace tf2_bot_detector
 
 		virtual size_t GetBlacklistedPlayerCount() const = 0;
 		virtual size_t GetRuleCount() const = 0;
+		virtual RuleMatchCacheStats GetRuleMatchCacheStats() const = 0;
 
 		virtual void ReloadConfigFiles() = 0;
 
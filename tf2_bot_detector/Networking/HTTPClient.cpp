@@ -2,9 +2,11 @@
 
 #include <mh/concurrency/thread_pool.hpp>
 #include <mh/error/error_code_exception.hpp>
+#include <nlohmann/json.hpp>
 
 #include "HTTPClient.h"
 #include "HTTPHelpers.h"
+#include "WorldJournal.h"
 
 #pragma warning(push, 1)
 #include <httplib.h>
@@ -81,6 +83,40 @@ namespace httplib
 	}
 }
 
+static void RecordResponse(JournalRecordType type, const URL& url, const std::string_view& data)
+{
+	if (auto& recorder = IJournalRecorder::GetInstance(); recorder.IsRecording())
+		recorder.Record(type, data, GetJournalKey(url));
+}
+
+static std::string GetErrorDetail(const URL& url)
+{
+	return mh::format("Failed to HTTP GET {}", url);
+}
+
+std::string tf2_bot_detector::SerializeHTTPError(const http_error& error)
+{
+	return nlohmann::json
+	{
+		{ "category", error.code().category().name() },
+		{ "value", error.code().value() },
+	}.dump();
+}
+
+void tf2_bot_detector::ThrowRecordedHTTPError(const URL& url, const std::string_view& serialized)
+{
+	const auto json = nlohmann::json::parse(serialized);
+	const auto category = json.at("category").get<std::string>();
+	const auto value = json.at("value").get<int>();
+
+	if (category == make_error_condition(httplib::Error::Success).category().name())
+		throw http_error(httplib::Error(value), GetErrorDetail(url));
+	if (category == make_error_condition(HTTPResponseCode::OK).category().name())
+		throw http_error(HTTPResponseCode(value), GetErrorDetail(url));
+
+	throw std::runtime_error(mh::format("Recorded error for {} has an unknown category {}", url, category));
+}
+
 std::string HTTPClientImpl::GetString(const URL& url) const try
 {
 	++m_TotalRequestCount;
@@ -98,32 +134,35 @@ std::string HTTPClientImpl::GetString(const URL& url) const try
 
 	auto response = client.Get(url.m_Path.c_str(), headers);
 	if (!response)
-		throw http_error(response.error(), mh::format("Failed to HTTP GET {}", url));
+		throw http_error(response.error(), GetErrorDetail(url));
 
 	if (response->status >= 400 && response->status < 600)
-		throw http_error((HTTPResponseCode)response->status, mh::format("Failed to HTTP GET {}", url));
+		throw http_error((HTTPResponseCode)response->status, GetErrorDetail(url));
 
+	RecordResponse(JournalRecordType::HTTPResponse, url, response->body);
 	return response->body;
 }
-catch (const http_error&)
+catch (const http_error& e)
 {
+	RecordResponse(JournalRecordType::HTTPError, url, SerializeHTTPError(e));
 	DebugLogException("{}", url);
 	throw;
 }
 catch (...)
 {
+	RecordResponse(JournalRecordType::HTTPError, url, {});
 	LogException("{}", url);
 	throw;
 }
 
-static duration_t GetMinRequestInterval(const URL& url)
+duration_t tf2_bot_detector::GetMinRequestInterval(const std::string_view& host)
 {
-	if (url.m_Host.ends_with("akamaihd.net") ||
-		url.m_Host.ends_with("steamstatic.com"))
+	if (host.ends_with("akamaihd.net") ||
+		host.ends_with("steamstatic.com"))
 	{
 		return 50ms;
 	}
-	else if (url.m_Host == "api.steampowered.com")
+	else if (host == "api.steampowered.com")
 	{
 		return 100ms;
 	}
@@ -140,7 +179,7 @@ mh::task<std::string> HTTPClientImpl::GetStringAsync(URL url) const try
 	using throttle_time_t = mh::thread_pool::clock_t::time_point;
 	throttle_time_t throttleTime{};
 	{
-		const duration_t MIN_INTERVAL = GetMinRequestInterval(url);
+		const duration_t MIN_INTERVAL = GetMinRequestInterval(url.m_Host);
 
 		static std::mutex s_ThrottleMutex;
 		static std::map<std::string, throttle_time_t> s_ThrottleDomains;
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "Clock.h"
+
 #include <mh/coroutine/task.hpp>
 
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace tf2_bot_detector
 {
+	class http_error;
 	class URL;
 
 	// Only intended to be stored if you are doing something async
@@ -23,5 +27,13 @@ namespace tf2_bot_detector
 		virtual uint32_t GetTotalRequestCount() const = 0;
 	};
 
+	// HTTP errors as journal records. Only the error condition is kept, which is all it takes to
+	// throw the same http_error again when the journal is replayed.
+	std::string SerializeHTTPError(const http_error& error);
+	[[noreturn]] void ThrowRecordedHTTPError(const URL& url, const std::string_view& serialized);
+
+	// GetStringAsync() spaces out requests to the same host by at least this much
+	duration_t GetMinRequestInterval(const std::string_view& host);
+
 	using HTTPClient = IHTTPClient; // temp, but probably valve time temp if i'm being totally honest
 }
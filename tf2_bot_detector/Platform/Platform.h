@@ -7,8 +7,10 @@
 #include <mh/coroutine/task.hpp>
 #include <mh/reflection/enum.hpp>
 
+#include <chrono>
 #include <filesystem>
 #include <future>
+#include <memory>
 #include <string>
 #include <variant>
 
@@ -84,6 +86,25 @@ namespace tf2_bot_detector
 			size_t GetCurrentRAMUsage();
 		}
 
+		namespace FileWatch
+		{
+			// Wakes a waiting thread when a file may have been written to.
+			class IChangeNotifier
+			{
+			public:
+				virtual ~IChangeNotifier() = default;
+
+				// Returns true if the file may have changed, false on timeout or cancellation.
+				virtual bool WaitForChange(std::chrono::milliseconds timeout) = 0;
+
+				// Wakes up any thread blocked in WaitForChange(). Safe to call from any thread.
+				virtual void Cancel() = 0;
+			};
+
+			// Returns nullptr if change notifications are unavailable, callers are expected to fall back to polling.
+			std::unique_ptr<IChangeNotifier> CreateChangeNotifier(const std::filesystem::path& file);
+		}
+
 		namespace Shell
 		{
 			std::vector<std::string> SplitCommandLineArgs(const std::string_view& cmdline);
@@ -0,0 +1,82 @@
+#include "Platform/Platform.h"
+#include "Log.h"
+#include "WindowsHelpers.h"
+
+#include <mh/text/formatters/error_code.hpp>
+
+#include <Windows.h>
+
+using namespace tf2_bot_detector;
+using namespace tf2_bot_detector::Windows;
+
+namespace
+{
+	class ChangeNotifier final : public FileWatch::IChangeNotifier
+	{
+	public:
+		ChangeNotifier(HANDLE changeHandle, HANDLE cancelEvent) :
+			m_ChangeHandle(changeHandle), m_CancelEvent(cancelEvent)
+		{
+		}
+		~ChangeNotifier()
+		{
+			FindCloseChangeNotification(m_ChangeHandle);
+			CloseHandle(m_CancelEvent);
+		}
+
+		bool WaitForChange(std::chrono::milliseconds timeout) override
+		{
+			const HANDLE handles[] = { m_ChangeHandle, m_CancelEvent };
+			const auto result = WaitForMultipleObjects(DWORD(std::size(handles)), handles, FALSE, DWORD(timeout.count()));
+
+			if (result == WAIT_OBJECT_0)
+			{
+				if (!FindNextChangeNotification(m_ChangeHandle))
+					LogError("FindNextChangeNotification failed: {}", GetLastErrorCode());
+
+				return true;
+			}
+			else if (result == WAIT_FAILED)
+			{
+				LogError("WaitForMultipleObjects failed: {}", GetLastErrorCode());
+			}
+
+			return false;
+		}
+
+		void Cancel() override
+		{
+			SetEvent(m_CancelEvent);
+		}
+
+	private:
+		HANDLE m_ChangeHandle = INVALID_HANDLE_VALUE;
+		HANDLE m_CancelEvent = nullptr;
+	};
+}
+
+std::unique_ptr<FileWatch::IChangeNotifier> tf2_bot_detector::FileWatch::CreateChangeNotifier(
+	const std::filesystem::path& file)
+{
+	// Windows only lets us watch directories, so watch the parent and let the caller
+	// figure out if anything was actually appended to the file it cares about.
+	const auto dir = file.parent_path();
+	const HANDLE changeHandle = FindFirstChangeNotificationW(dir.c_str(), FALSE,
+		FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+
+	if (changeHandle == INVALID_HANDLE_VALUE)
+	{
+		LogWarning("Unable to watch {} for changes: {}", dir, GetLastErrorCode());
+		return nullptr;
+	}
+
+	const HANDLE cancelEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (!cancelEvent)
+	{
+		LogWarning("Unable to create cancellation event for file change notifier: {}", GetLastErrorCode());
+		FindCloseChangeNotification(changeHandle);
+		return nullptr;
+	}
+
+	return std::make_unique<ChangeNotifier>(changeHandle, cancelEvent);
+}
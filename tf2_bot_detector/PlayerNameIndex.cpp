@@ -0,0 +1,57 @@
+#include "PlayerNameIndex.h"
+
+#include <algorithm>
+
+using namespace tf2_bot_detector;
+
+bool PlayerNameIndex::Entry::IsNewerThan(const Entry& other) const
+{
+	if (m_LastUpdateTime != other.m_LastUpdateTime)
+		return m_LastUpdateTime > other.m_LastUpdateTime;
+
+	return m_Sequence > other.m_Sequence;
+}
+
+void PlayerNameIndex::Update(const SteamID& id, const std::string_view& oldName, const std::string_view& newName,
+	time_point_t timestamp)
+{
+	if (oldName != newName)
+		Remove(id, oldName);
+
+	auto found = m_Names.find(newName);
+	if (found == m_Names.end())
+		found = m_Names.emplace(std::string(newName), std::vector<Entry>{}).first;
+
+	auto& entries = found->second;
+	std::erase_if(entries, [&](const Entry& entry) { return entry.m_SteamID == id; });
+
+	const Entry newEntry{ id, timestamp, m_NextSequence++ };
+	const auto pos = std::find_if(entries.begin(), entries.end(),
+		[&](const Entry& entry) { return newEntry.IsNewerThan(entry); });
+
+	entries.insert(pos, newEntry);
+}
+
+void PlayerNameIndex::Remove(const SteamID& id, const std::string_view& name)
+{
+	auto found = m_Names.find(name);
+	if (found == m_Names.end())
+		return;
+
+	std::erase_if(found->second, [&](const Entry& entry) { return entry.m_SteamID == id; });
+	if (found->second.empty())
+		m_Names.erase(found);
+}
+
+void PlayerNameIndex::Clear()
+{
+	m_Names.clear();
+}
+
+std::optional<SteamID> PlayerNameIndex::Find(const std::string_view& name) const
+{
+	if (auto found = m_Names.find(name); found != m_Names.end() && !found->second.empty())
+		return found->second.front().m_SteamID;
+
+	return std::nullopt;
+}
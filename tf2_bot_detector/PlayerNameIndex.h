@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Clock.h"
+#include "SteamID.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tf2_bot_detector
+{
+	// Maps player names to the SteamIDs last seen using them, so console lines that only
+	// have a name (chat, kills, pings...) can be attributed without scanning every player.
+	//
+	// Several players can share a name (name stealers). The one whose status was updated
+	// most recently wins, and if they were updated with the same timestamp, whichever
+	// update came last.
+	class PlayerNameIndex final
+	{
+	public:
+		// Call whenever a player's status is updated, even if their name didn't change
+		void Update(const SteamID& id, const std::string_view& oldName, const std::string_view& newName,
+			time_point_t timestamp);
+		void Remove(const SteamID& id, const std::string_view& name);
+		void Clear();
+
+		std::optional<SteamID> Find(const std::string_view& name) const;
+
+		size_t size() const { return m_Names.size(); }
+
+	private:
+		struct Entry
+		{
+			SteamID m_SteamID;
+			time_point_t m_LastUpdateTime{};
+			uint64_t m_Sequence{};
+
+			bool IsNewerThan(const Entry& other) const;
+		};
+
+		struct NameHash
+		{
+			using is_transparent = void;
+			size_t operator()(const std::string_view& name) const { return std::hash<std::string_view>{}(name); }
+		};
+
+		// Entries for each name are kept newest first, so Find() never has to look past the front
+		std::unordered_map<std::string, std::vector<Entry>, NameHash, std::equal_to<>> m_Names;
+		uint64_t m_NextSequence = 0;
+	};
+}
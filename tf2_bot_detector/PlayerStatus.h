@@ -31,10 +31,4 @@ namespace tf2_bot_detector
 		uint8_t m_Loss;
 		PlayerStatusState m_State = PlayerStatusState::Invalid;
 	};
-
-	struct PlayerStatusShort
-	{
-		std::string m_Name;
-		uint8_t m_ClientIndex;
-	};
 }
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Clock.h"
+#include "LobbyMember.h"
+#include "PlayerStatus.h"
+#include "SteamID.h"
+#include "TFConstants.h"
+
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tf2_bot_detector
+{
+	class IPlayer;
+
+	// The fields of every player WorldState is tracking that get scanned every frame, one
+	// array per field. Row i of every array is the same player, so scans over the whole
+	// player list touch a few contiguous arrays instead of following a pointer per player.
+	// Everything else is still available through m_Players.
+	//
+	// Kept in sync by WorldState. Rows are reordered when players are evicted, so don't hold
+	// on to row indices past the current frame.
+	//
+	// Rows are also linked into a list ordered by m_LastStatusUpdateTimes, so "who have we
+	// seen recently" is a walk from m_NewestRow that stops as soon as it's gone far enough:
+	//	for (auto row = table.m_NewestRow; row != PlayerTable::NO_ROW; row = table.m_OlderRows[row])
+	struct PlayerTable
+	{
+		using row_t = uint32_t;
+		static constexpr row_t NO_ROW = row_t(-1);
+
+		std::vector<SteamID> m_SteamIDs;
+		std::vector<IPlayer*> m_Players;
+		std::vector<TFTeam> m_Teams;
+		std::vector<std::optional<LobbyMemberTeam>> m_LobbyTeams; // Only set for lobby members
+		std::vector<UserID_t> m_UserIDs; // 0 if we haven't seen them in status yet
+		std::vector<uint16_t> m_Kills;
+		std::vector<uint16_t> m_Deaths;
+		std::vector<uint16_t> m_Pings;
+		std::vector<PlayerStatusState> m_States;
+		std::vector<time_point_t> m_LastStatusUpdateTimes; // Only change with SetLastStatusUpdateTime()
+
+		std::vector<row_t> m_NewerRows;
+		std::vector<row_t> m_OlderRows;
+		row_t m_NewestRow = NO_ROW;
+		row_t m_OldestRow = NO_ROW;
+
+		size_t size() const { return m_SteamIDs.size(); }
+		bool empty() const { return m_SteamIDs.empty(); }
+
+		void SetLastStatusUpdateTime(row_t row, time_point_t time)
+		{
+			if (m_LastStatusUpdateTimes[row] == time)
+				return;
+
+			Unlink(row);
+			m_LastStatusUpdateTimes[row] = time;
+
+			// Status lines arrive in order, so this almost never gets past the newest row
+			row_t newer = NO_ROW;
+			row_t older = m_NewestRow;
+			while (older != NO_ROW && m_LastStatusUpdateTimes[older] > time)
+			{
+				newer = older;
+				older = m_OlderRows[older];
+			}
+
+			Link(row, newer, older);
+		}
+
+		row_t AddRow(const SteamID& id, IPlayer* player)
+		{
+			const row_t row = row_t(size());
+			m_SteamIDs.push_back(id);
+			m_Players.push_back(player);
+			m_Teams.push_back(TFTeam::Unknown);
+			m_LobbyTeams.push_back(std::nullopt);
+			m_UserIDs.push_back(0);
+			m_Kills.push_back(0);
+			m_Deaths.push_back(0);
+			m_Pings.push_back(0);
+			m_States.push_back(PlayerStatusState::Invalid);
+			m_LastStatusUpdateTimes.push_back({});
+			m_NewerRows.push_back(NO_ROW);
+			m_OlderRows.push_back(NO_ROW);
+			Link(row, m_OldestRow, NO_ROW); // Never seen in status, so older than everyone else
+			return row;
+		}
+
+		// Moves the last row into the removed one. Returns the player that moved, if any.
+		IPlayer* RemoveRow(row_t row)
+		{
+			assert(row < size());
+			const row_t last = row_t(size() - 1);
+			IPlayer* moved = (row != last) ? m_Players[last] : nullptr;
+
+			Unlink(row);
+			if (row != last)
+			{
+				// Point the last row's neighbors at where it's about to be
+				if (const row_t newer = m_NewerRows[last]; newer != NO_ROW)
+					m_OlderRows[newer] = row;
+				else
+					m_NewestRow = row;
+
+				if (const row_t older = m_OlderRows[last]; older != NO_ROW)
+					m_NewerRows[older] = row;
+				else
+					m_OldestRow = row;
+			}
+
+			const auto Remove = [&](auto& vec)
+			{
+				vec[row] = std::move(vec[last]);
+				vec.pop_back();
+			};
+
+			Remove(m_SteamIDs);
+			Remove(m_Players);
+			Remove(m_Teams);
+			Remove(m_LobbyTeams);
+			Remove(m_UserIDs);
+			Remove(m_Kills);
+			Remove(m_Deaths);
+			Remove(m_Pings);
+			Remove(m_States);
+			Remove(m_LastStatusUpdateTimes);
+			Remove(m_NewerRows);
+			Remove(m_OlderRows);
+
+			return moved;
+		}
+
+		void Clear()
+		{
+			m_SteamIDs.clear();
+			m_Players.clear();
+			m_Teams.clear();
+			m_LobbyTeams.clear();
+			m_UserIDs.clear();
+			m_Kills.clear();
+			m_Deaths.clear();
+			m_Pings.clear();
+			m_States.clear();
+			m_LastStatusUpdateTimes.clear();
+			m_NewerRows.clear();
+			m_OlderRows.clear();
+			m_NewestRow = m_OldestRow = NO_ROW;
+		}
+
+	private:
+		void Link(row_t row, row_t newer, row_t older)
+		{
+			m_NewerRows[row] = newer;
+			m_OlderRows[row] = older;
+			(newer != NO_ROW ? m_OlderRows[newer] : m_NewestRow) = row;
+			(older != NO_ROW ? m_NewerRows[older] : m_OldestRow) = row;
+		}
+		void Unlink(row_t row)
+		{
+			const row_t newer = m_NewerRows[row];
+			const row_t older = m_OlderRows[row];
+			(newer != NO_ROW ? m_OlderRows[newer] : m_NewestRow) = older;
+			(older != NO_ROW ? m_NewerRows[older] : m_OldestRow) = newer;
+			m_NewerRows[row] = m_OlderRows[row] = NO_ROW;
+		}
+	};
+}
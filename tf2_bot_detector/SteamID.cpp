@@ -4,7 +4,6 @@
 #include <mh/text/format.hpp>
 #include <nlohmann/json.hpp>
 
-#include <regex>
 #include <stdexcept>
 
 using namespace std::string_literals;
@@ -15,9 +14,8 @@ SteamID::SteamID(const std::string_view& str)
 	ID64 = 0;
 
 	// Steam3
-	static std::regex s_SteamID3Regex(R"regex(\[([a-zA-Z]):(\d):(\d+)(?::(\d+))?\])regex", std::regex::optimize);
-	if (std::match_results<std::string_view::const_iterator> result;
-		std::regex_match(str.begin(), str.end(), result, s_SteamID3Regex))
+	static constexpr ct_regex<R"regex(\[([a-zA-Z]):(\d):(\d+)(?::(\d+))?\])regex"> s_SteamID3Regex;
+	if (auto result = s_SteamID3Regex.match(str))
 	{
 		const char firstChar = *result[1].first;
 		switch (firstChar)
@@ -0,0 +1,56 @@
+#include "Util/AhoCorasick.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+#include <string>
+
+using namespace tf2_bot_detector;
+
+TEST_CASE("tf2bd_aho_corasick", "[AhoCorasick]")
+{
+	using occurrence_t = std::pair<AhoCorasick::pattern_index_t, size_t>;
+
+	// Small alphabet, so patterns overlap and share prefixes/suffixes all the time
+	std::mt19937 random(1234);
+	const auto RandomString = [&](size_t maxLength)
+	{
+		std::string str(random() % (maxLength + 1), '\0');
+		for (char& c : str)
+			c = char('a' + random() % 3);
+
+		return str;
+	};
+
+	for (int i = 0; i < 1000; i++)
+	{
+		std::vector<std::string> patterns(random() % 20);
+		for (auto& pattern : patterns)
+			pattern = RandomString(5);
+
+		const AhoCorasick automaton(std::vector<std::string_view>(patterns.begin(), patterns.end()));
+		REQUIRE(automaton.GetPatternCount() == patterns.size());
+
+		const std::string text = RandomString(30);
+
+		std::multiset<occurrence_t> found;
+		automaton.FindAll(text, [&](AhoCorasick::pattern_index_t pattern, size_t end)
+			{
+				REQUIRE(end >= automaton.GetPatternLength(pattern));
+				found.emplace(pattern, end);
+			});
+
+		std::multiset<occurrence_t> expected;
+		for (AhoCorasick::pattern_index_t p = 0; p < patterns.size(); p++)
+		{
+			if (patterns[p].empty())
+				continue;
+
+			for (size_t pos = text.find(patterns[p]); pos != text.npos; pos = text.find(patterns[p], pos + 1))
+				expected.emplace(p, pos + patterns[p].size());
+		}
+
+		REQUIRE(found == expected);
+	}
+}
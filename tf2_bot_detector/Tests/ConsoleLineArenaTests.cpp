@@ -0,0 +1,192 @@
+#include "ConsoleLog/ConsoleLineArena.h"
+#include "ConsoleLog/ConsoleLines.h"
+#include "WorldState.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <vector>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#include <Windows.h>
+#endif
+
+using namespace std::string_view_literals;
+using namespace tf2_bot_detector;
+
+#ifdef _DEBUG
+namespace
+{
+	// While alive, counts every allocation the debug CRT heap sees from the thread that created
+	// it. That's operator new, malloc, and anything else that ends up there. This hooks the CRT
+	// rather than replacing operator new, since the tests share a binary with the application.
+	class ThreadAllocationCounter final
+	{
+	public:
+		ThreadAllocationCounter()
+		{
+			s_Count = 0;
+			s_ThreadID = GetCurrentThreadId();
+			s_PreviousHook = _CrtSetAllocHook(&AllocHook);
+		}
+		~ThreadAllocationCounter()
+		{
+			_CrtSetAllocHook(s_PreviousHook);
+			s_ThreadID = 0;
+		}
+
+		ThreadAllocationCounter(const ThreadAllocationCounter&) = delete;
+		ThreadAllocationCounter& operator=(const ThreadAllocationCounter&) = delete;
+
+		size_t GetCount() const { return s_Count; }
+
+	private:
+		static int __cdecl AllocHook(int allocType, void* userData, size_t size, int blockType,
+			long requestNumber, const unsigned char* fileName, int lineNumber)
+		{
+			// The CRT's own bookkeeping isn't anything we asked for
+			if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && blockType != _CRT_BLOCK &&
+				GetCurrentThreadId() == s_ThreadID)
+			{
+				s_Count++;
+			}
+
+			if (s_PreviousHook)
+				return s_PreviousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber);
+
+			return TRUE;
+		}
+
+		// Static rather than members, other threads may still be in the hook after we're gone
+		inline static std::atomic<DWORD> s_ThreadID = 0;
+		inline static size_t s_Count = 0; // Only ever touched by s_ThreadID
+		inline static _CRT_ALLOC_HOOK s_PreviousHook = nullptr;
+	};
+}
+#endif
+
+static bool IsWithin(const std::string_view& outer, const std::string_view& inner)
+{
+	return inner.data() >= outer.data() && (inner.data() + inner.size()) <= (outer.data() + outer.size());
+}
+
+TEST_CASE("tf2bd_cl_arena", "[ConsoleLines]")
+{
+	constexpr std::string_view s_Lines[] =
+	{
+		"Lobby updated",
+		"Client reached server_spawn.",
+		"edicts  : 1032 used of 2048 max",
+		"execing autoexec.cfg",
+		"Connecting to 169.254.1.1:27015...",
+		"Player1 killed Player2 with scattergun. (crit)",
+		" 52 ms : Player1",
+		"Dropped Player1 from server (Disconnect by user.)",
+		"- latency: 32.0, loss 0.00",
+		"Teams have been switched.",
+		"#    348 \"A player with a name too long for SSO\" [U:1:1118537734] 00:51  157    0 active",
+		"#2 - A player with a name too long for SSO",
+	};
+
+	std::string text;
+	for (const auto& line : s_Lines)
+	{
+		text.append(line);
+		text.push_back('\n');
+	}
+
+	const auto ParseAll = [&](const std::shared_ptr<ConsoleLineArena>& arena, std::vector<std::shared_ptr<IConsoleLine>>& parsed)
+	{
+		ConsoleLineArena::Scope scope(arena);
+		for (size_t offset = 0; offset < text.size(); )
+		{
+			const auto end = text.find('\n', offset);
+			parsed.push_back(IConsoleLine::ParseConsoleLine(std::string_view(text).substr(offset, end - offset), {}));
+			offset = end + 1;
+		}
+	};
+
+	const auto sharedText = std::make_shared<const std::string>(text);
+
+	// Warm up the parser and put some blocks back in the pool
+	{
+		std::vector<std::shared_ptr<IConsoleLine>> parsed;
+		ParseAll(std::make_shared<ConsoleLineArena>(sharedText), parsed);
+	}
+
+	auto arena = std::make_shared<ConsoleLineArena>(sharedText);
+	std::vector<std::shared_ptr<IConsoleLine>> parsed;
+	parsed.reserve(std::size(s_Lines));
+
+	// Every line (and its shared_ptr control block) comes out of the arena, and the arena
+	// reuses the blocks released by the first one instead of going to the heap. Nothing else
+	// the parsers do along the way (copies, regex state, growing containers) may allocate
+	// either. The text the lines hold is checked below to point into the arena too.
+#ifdef _DEBUG
+	size_t allocations;
+	{
+		ThreadAllocationCounter counter;
+		ParseAll(arena, parsed);
+		allocations = counter.GetCount();
+	}
+	REQUIRE(allocations == 0);
+#else
+	ParseAll(arena, parsed);
+#endif
+
+	REQUIRE(arena->GetHeapBlockCount() == 0);
+	REQUIRE(parsed.size() == std::size(s_Lines));
+	for (const auto& line : parsed)
+	{
+		REQUIRE(line);
+		REQUIRE(arena->Owns(line.get()));
+	}
+
+	REQUIRE(arena->GetAllocatedSize() > 0);
+
+	const auto& kill = static_cast<const KillNotificationLine&>(*parsed[5]);
+	REQUIRE(kill.GetAttackerName() == "Player1"sv);
+	REQUIRE(IsWithin(arena->GetText(), kill.GetAttackerName()));
+
+	const auto& exec = static_cast<const ConfigExecLine&>(*parsed[3]);
+	REQUIRE(exec.GetConfigFileName() == "autoexec.cfg"sv);
+	REQUIRE(IsWithin(arena->GetText(), exec.GetConfigFileName()));
+
+	const auto& status = static_cast<const ServerStatusPlayerLine&>(*parsed[10]);
+	REQUIRE(status.GetPlayerName() == "A player with a name too long for SSO"sv);
+	REQUIRE(IsWithin(arena->GetText(), status.GetPlayerName()));
+	REQUIRE(status.GetPlayerStatus().m_SteamID == SteamID(1118537734, SteamAccountType::Individual, SteamAccountUniverse::Public));
+
+	const auto& shortStatus = static_cast<const ServerStatusShortPlayerLine&>(*parsed[11]);
+	REQUIRE(shortStatus.GetClientIndex() == 2);
+	REQUIRE(IsWithin(arena->GetText(), shortStatus.GetPlayerName()));
+
+	SECTION("Text from elsewhere is copied into the arena")
+	{
+		std::string name = "Player2";
+		std::shared_ptr<ChatConsoleLine> chat;
+		{
+			ConsoleLineArena::Scope scope(arena);
+			chat = ChatConsoleLine::Create(time_point_t{}, name, "hello"sv, false, false, false, TeamShareResult::Neither);
+		}
+
+		name = "overwritten";
+		REQUIRE(chat->GetPlayerName() == "Player2"sv);
+		REQUIRE(!IsWithin(arena->GetText(), chat->GetPlayerName()));
+	}
+
+	SECTION("Lines keep their arena alive")
+	{
+		const std::weak_ptr<ConsoleLineArena> weakArena = arena;
+		auto ping = std::static_pointer_cast<PingLine>(parsed[6]);
+		arena.reset();
+		parsed.clear();
+
+		REQUIRE(!weakArena.expired());
+		REQUIRE(ping->GetPlayerName() == "Player1"sv);
+
+		ping.reset();
+		REQUIRE(weakArena.expired());
+	}
+}
@@ -1,8 +1,12 @@
+#include "ConsoleLog/ConsoleLineListener.h"
 #include "ConsoleLog/ConsoleLines.h"
 #include "SteamID.h"
 
 #include <catch2/catch.hpp>
 
+#include <optional>
+#include <vector>
+
 using namespace std::chrono_literals;
 using namespace tf2_bot_detector;
 
@@ -63,3 +67,200 @@ TEST_CASE("tf2bd_cl_status", "[ConsoleLines]")
 		REQUIRE(playerStatus.m_State == test.m_ExpectedState);
 	}
 }
+
+TEST_CASE("tf2bd_cl_dispatch", "[ConsoleLines]")
+{
+	struct DispatchTest
+	{
+		std::string_view m_Line;
+		std::optional<ConsoleLineType> m_ExpectedType;
+	};
+
+	constexpr DispatchTest s_DispatchTests[] =
+	{
+		{ "Client reached server_spawn.", ConsoleLineType::ClientReachedServerSpawn },
+		{ "Lobby updated", ConsoleLineType::LobbyChanged },
+		{ "edicts  : 1032 used of 2048 max", ConsoleLineType::EdictUsage },
+		{ "#    348 \"2fort\" [U:1:1118537734] 00:51  157    0 active", ConsoleLineType::PlayerStatus },
+		{ "#2 - 2fort", ConsoleLineType::PlayerStatusShort },
+		{ "execing autoexec.cfg", ConsoleLineType::ConfigExec },
+		{ "- latency: 32.0, loss 0.00", ConsoleLineType::NetChannelLatencyLoss },
+
+		// Anchored rather than prefixed
+		{ "Player1 killed Player2 with scattergun.", ConsoleLineType::KillNotification },
+		{ " 52 ms : Player1", ConsoleLineType::Ping },
+		{ "sv_cheats                                : 0        : , \"sv\", \"rep\" : Allow cheats on server", ConsoleLineType::CvarlistConvar },
+		{ "sv_cheats\t:\t0\t:\t, \"sv\", \"rep\"\t:\tAllow cheats on server", ConsoleLineType::CvarlistConvar },
+		{ "sv_cheats\t: 0 :\t, \"sv\", \"rep\" :\tAllow cheats on server", ConsoleLineType::CvarlistConvar },
+
+		// Nothing should claim these
+		{ "", std::nullopt },
+		{ "Lobby", std::nullopt },
+		{ "CTFLobbyShared: garbage", std::nullopt },
+		{ "Some random console spam", std::nullopt },
+	};
+
+	for (const auto& test : s_DispatchTests)
+	{
+		CAPTURE(test.m_Line);
+		auto parsed = IConsoleLine::ParseConsoleLine(test.m_Line, tfbd_clock_t::now());
+
+		if (test.m_ExpectedType)
+		{
+			REQUIRE(parsed);
+			REQUIRE(parsed->GetType() == *test.m_ExpectedType);
+		}
+		else
+		{
+			REQUIRE(!parsed);
+		}
+	}
+}
+
+TEST_CASE("tf2bd_cl_dispatch_precedence", "[ConsoleLines]")
+{
+	// Both KillNotification and CvarlistConvar accept this one
+	constexpr std::string_view line = "sv_x : 1 : , \"sv\" : Player1 killed Player2 with scattergun.";
+	REQUIRE(KillNotificationLine::TryParse(line, tfbd_clock_t::now()));
+	REQUIRE(CvarlistConvarLine::TryParse(line, tfbd_clock_t::now()));
+
+	// Neither has a prefix, so the one that comes first in ConsoleLineType wins
+	static_assert(ConsoleLineType::KillNotification < ConsoleLineType::CvarlistConvar);
+	auto parsed = IConsoleLine::ParseConsoleLine(line, tfbd_clock_t::now());
+	REQUIRE(parsed);
+	CHECK(parsed->GetType() == ConsoleLineType::KillNotification);
+
+	// Unless the winner isn't wanted
+	parsed = IConsoleLine::ParseConsoleLine(line, tfbd_clock_t::now(), { ConsoleLineType::CvarlistConvar });
+	REQUIRE(parsed);
+	CHECK(parsed->GetType() == ConsoleLineType::CvarlistConvar);
+}
+
+TEST_CASE("tf2bd_cl_cvarlist", "[ConsoleLines]")
+{
+	struct CvarlistTest
+	{
+		std::string_view m_Line;
+		std::string_view m_ExpectedName;
+		float m_ExpectedValue;
+		std::string_view m_ExpectedHelpText;
+	};
+
+	constexpr CvarlistTest s_CvarlistTests[] =
+	{
+		{ "sv_cheats                                : 0        : , \"sv\", \"rep\" : Allow cheats on server", "sv_cheats", 0, "Allow cheats on server" },
+		{ "sv_cheats\t:\t0\t:\t, \"sv\", \"rep\"\t:\tAllow cheats on server", "sv_cheats", 0, "Allow cheats on server" },
+		{ "cl_interp\t\t:\t0.1\t\t:\t, \"cl\"\t\t:\tSets the interpolation amount", "cl_interp", 0.1f, "Sets the interpolation amount" },
+	};
+
+	for (const auto& test : s_CvarlistTests)
+	{
+		CAPTURE(test.m_Line);
+		auto parsed = CvarlistConvarLine::TryParse(test.m_Line, tfbd_clock_t::now());
+		REQUIRE(parsed);
+
+		const auto& line = static_cast<const CvarlistConvarLine&>(*parsed);
+		CHECK(line.GetConvarName() == test.m_ExpectedName);
+		CHECK(line.GetConvarValue() == test.m_ExpectedValue);
+		CHECK(line.GetHelpText() == test.m_ExpectedHelpText);
+	}
+
+	// Colons, but not cvarlist's
+	CHECK(!CvarlistConvarLine::TryParse("Player1: hello : there", tfbd_clock_t::now()));
+	CHECK(!CvarlistConvarLine::TryParse("Connected to 1.2.3.4:27015", tfbd_clock_t::now()));
+}
+
+TEST_CASE("tf2bd_cl_parser_stats", "[ConsoleLines]")
+{
+	const auto FindStats = [](const std::string_view& typeName)
+	{
+		for (const auto& stats : IConsoleLine::GetParserStats())
+		{
+			if (stats.m_TypeName == typeName)
+				return stats;
+		}
+
+		FAIL("No parser stats for " << typeName);
+		return ConsoleLineParserStats{};
+	};
+
+	const auto before = FindStats("EdictUsageLine");
+
+	constexpr std::string_view HIT = "edicts  : 1032 used of 2048 max";
+	constexpr std::string_view MISS = "edicts  : garbage";
+	REQUIRE(IConsoleLine::ParseConsoleLine(HIT, tfbd_clock_t::now()));
+	REQUIRE(!IConsoleLine::ParseConsoleLine(MISS, tfbd_clock_t::now()));
+
+	const auto after = FindStats("EdictUsageLine");
+	REQUIRE(after.m_Attempts == before.m_Attempts + 2);
+	REQUIRE(after.m_Hits == before.m_Hits + 1);
+	REQUIRE(after.m_BytesExamined == before.m_BytesExamined + HIT.size() + MISS.size());
+	REQUIRE(after.m_MaxNanoseconds <= after.m_TotalNanoseconds);
+}
+
+TEST_CASE("tf2bd_cl_parse_mask", "[ConsoleLines]")
+{
+	const auto GetAttempts = []
+	{
+		for (const auto& stats : IConsoleLine::GetParserStats())
+		{
+			if (stats.m_TypeName == "EdictUsageLine")
+				return stats.m_Attempts;
+		}
+
+		FAIL("No parser stats for EdictUsageLine");
+		return uint64_t(0);
+	};
+
+	constexpr std::string_view LINE = "edicts  : 1032 used of 2048 max";
+	const auto attempts = GetAttempts();
+
+	REQUIRE(!IConsoleLine::ParseConsoleLine(LINE, tfbd_clock_t::now(), {}));
+	REQUIRE(!IConsoleLine::ParseConsoleLine(LINE, tfbd_clock_t::now(), { ConsoleLineType::Ping, ConsoleLineType::Chat }));
+	REQUIRE(GetAttempts() == attempts);
+
+	auto parsed = IConsoleLine::ParseConsoleLine(LINE, tfbd_clock_t::now(), { ConsoleLineType::EdictUsage });
+	REQUIRE(parsed);
+	REQUIRE(parsed->GetType() == ConsoleLineType::EdictUsage);
+	REQUIRE(GetAttempts() == attempts + 1);
+}
+
+TEST_CASE("tf2bd_cl_batch", "[ConsoleLines]")
+{
+	constexpr std::string_view s_Lines[] =
+	{
+		"Lobby updated",
+		"edicts  : 1032 used of 2048 max",
+		"Client reached server_spawn.",
+		"edicts  : 1033 used of 2048 max",
+		"Lobby destroyed",
+	};
+
+	std::vector<std::shared_ptr<IConsoleLine>> parsed;
+	ConsoleLineBatch batch;
+	for (const auto& line : s_Lines)
+	{
+		REQUIRE(parsed.emplace_back(IConsoleLine::ParseConsoleLine(line, tfbd_clock_t::now())));
+		batch.Add(*parsed.back());
+	}
+
+	const auto all = batch.GetLines();
+	REQUIRE(std::distance(all.begin(), all.end()) == std::ssize(s_Lines));
+	REQUIRE(&*all.begin() == parsed.front().get());
+
+	// Filtering keeps the original order
+	const auto filtered = all.Filter({ ConsoleLineType::LobbyChanged, ConsoleLineType::ClientReachedServerSpawn });
+	std::vector<IConsoleLine*> filteredLines;
+	for (IConsoleLine& line : filtered)
+		filteredLines.push_back(&line);
+
+	REQUIRE(filteredLines == std::vector<IConsoleLine*>{ parsed[0].get(), parsed[2].get(), parsed[4].get() });
+
+	const auto edicts = all.GetLines(ConsoleLineType::EdictUsage);
+	REQUIRE(edicts.size() == 2);
+	REQUIRE(edicts[0] == parsed[1].get());
+	REQUIRE(edicts[1] == parsed[3].get());
+
+	REQUIRE(filtered.GetLines(ConsoleLineType::EdictUsage).empty());
+	REQUIRE(all.Filter({ ConsoleLineType::Chat }).empty());
+}
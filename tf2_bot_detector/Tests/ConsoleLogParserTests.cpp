@@ -0,0 +1,199 @@
+#include "ConsoleLog/ConsoleLogBuffer.h"
+#include "ConsoleLog/ConsoleLogTimestamp.h"
+#include "Filesystem.h"
+#include "Log.h"
+
+#include <catch2/catch.hpp>
+#include <mh/text/format.hpp>
+
+#include <regex>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace tf2_bot_detector;
+
+namespace
+{
+	struct LineSplit
+	{
+		size_t m_Offset;
+		int m_Fields[6];
+
+		bool operator==(const LineSplit&) const = default;
+	};
+
+	std::vector<LineSplit> SplitWithRegex(const std::string_view& text)
+	{
+		static const std::regex s_TimestampRegex(R"regex(\n(\d\d)\/(\d\d)\/(\d\d\d\d) - (\d\d):(\d\d):(\d\d):[ \n])regex", std::regex::optimize);
+
+		std::vector<LineSplit> retVal;
+		std::match_results<std::string_view::const_iterator> match;
+		auto begin = text.begin();
+		while (std::regex_search(begin, text.end(), match, s_TimestampRegex))
+		{
+			LineSplit& split = retVal.emplace_back();
+			split.m_Offset = size_t(match[0].first - text.begin());
+			for (size_t i = 0; i < std::size(split.m_Fields); i++)
+				split.m_Fields[i] = std::stoi(match[i + 1].str());
+
+			begin = match[0].second;
+		}
+
+		return retVal;
+	}
+
+	std::vector<LineSplit> SplitWithScanner(const std::string_view& text)
+	{
+		std::vector<LineSplit> retVal;
+		size_t begin = 0;
+		while (auto match = FindConsoleLogTimestamp(text, begin))
+		{
+			retVal.push_back(LineSplit{ match->m_Offset,
+				{ match->m_Month, match->m_Day, match->m_Year, match->m_Hour, match->m_Minute, match->m_Second } });
+
+			begin = match->GetEnd();
+		}
+
+		return retVal;
+	}
+
+	std::string GenerateConsoleLog(size_t lineCount)
+	{
+		constexpr std::string_view LINES[] =
+		{
+			"#    348 \"2fort closed due to COVID\" [U:1:1118537734] 00:51  157    0 active",
+			"Player killed Other Player with scattergun. (crit)",
+			"CTFLobbyShared: ID:0001234567890abc  24 member(s), 0 pending",
+			"edicts  : 1034 used of 2048 max",
+			"",
+			"not a timestamp: 01/02/2020 - 03:04:05",
+			"\n01/02/20 - 03:04:05: truncated year",
+			"\n01/02/2020 - 03:04:05 missing colon",
+			"Connected to 123.123.123.123:27015",
+		};
+
+		std::string retVal;
+		for (size_t i = 0; i < lineCount; i++)
+		{
+			const int hour = int(i / 3600) % 24;
+			const int minute = int(i / 60) % 60;
+			const int second = int(i % 60);
+			retVal += mh::format("\n{:02}/{:02}/2020 - {:02}:{:02}:{:02}:{}{}", 1 + int(i % 12), 1 + int(i % 28),
+				hour, minute, second, LINES[i % std::size(LINES)].empty() ? '\n' : ' ', LINES[i % std::size(LINES)]);
+		}
+
+		return retVal;
+	}
+}
+
+TEST_CASE("tf2bd_conlog_timestamp_splits", "[ConsoleLogParser]")
+{
+	const std::string log = GenerateConsoleLog(5000);
+
+	const auto expected = SplitWithRegex(log);
+	REQUIRE(!expected.empty());
+	REQUIRE(SplitWithScanner(log) == expected);
+
+	// Chopping the buffer at arbitrary points (partial reads) must not change anything either
+	for (size_t length : { 0, 1, 23, 24, 25, 47, 100, 1000, 4096 })
+	{
+		const std::string_view partial = std::string_view(log).substr(0, length);
+		REQUIRE(SplitWithScanner(partial) == SplitWithRegex(partial));
+	}
+
+	// Back to back empty lines, where the trailing \n of one timestamp is the start of the next
+	{
+		constexpr std::string_view EMPTY_LINES = "\n01/02/2020 - 03:04:05:\n01/02/2020 - 03:04:06:\n01/02/2020 - 03:04:07: hi";
+		REQUIRE(SplitWithScanner(EMPTY_LINES) == SplitWithRegex(EMPTY_LINES));
+		REQUIRE(SplitWithScanner(EMPTY_LINES).size() == 2);
+	}
+}
+
+TEST_CASE("tf2bd_conlog_timestamp_converter", "[ConsoleLogParser]")
+{
+	ConsoleLogTimestampConverter converter;
+
+	for (int i = 0; i < 200; i++)
+	{
+		ConsoleLogTimestamp ts;
+		ts.m_Month = 1 + (i % 12);
+		ts.m_Day = 1 + (i % 28);
+		ts.m_Year = 2020;
+		ts.m_Hour = (i / 7) % 24;
+		ts.m_Minute = (i * 7) % 60;
+		ts.m_Second = (i * 13) % 60;
+
+		std::tm time{};
+		time.tm_isdst = -1;
+		time.tm_mon = ts.m_Month - 1;
+		time.tm_mday = ts.m_Day;
+		time.tm_year = ts.m_Year - 1900;
+		time.tm_hour = ts.m_Hour;
+		time.tm_min = ts.m_Minute;
+		time.tm_sec = ts.m_Second;
+
+		REQUIRE(converter.ToTimePoint(ts) == tfbd_clock_t::from_time_t(std::mktime(&time)));
+	}
+}
+
+TEST_CASE("tf2bd_conlog_timestamp_benchmark", "[.][ConsoleLogParser][benchmark]")
+{
+	std::string corpus;
+	for (const auto& entry : IFilesystem::Get().IterateDir(IFilesystem::Get().GetLogsDir() / "console", false))
+	{
+		if (entry.path().extension() == ".log")
+			corpus += IFilesystem::Get().ReadFile(entry.path());
+	}
+
+	if (corpus.empty())
+		corpus = GenerateConsoleLog(200'000);
+
+	const auto Measure = [&](const char* name, auto&& splitFunc)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const size_t lineCount = splitFunc(corpus).size();
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		Log("{}: {} lines in {:1.3f} ms ({:1.0f} lines/sec)", name, lineCount, elapsed * 1000, lineCount / elapsed);
+		return elapsed;
+	};
+
+	const auto regexTime = Measure("std::regex", SplitWithRegex);
+	const auto scannerTime = Measure("FindConsoleLogTimestamp", SplitWithScanner);
+	Log("Timestamp scanner speedup: {:1.1f}x", regexTime / scannerTime);
+
+	CHECK(SplitWithScanner(corpus) == SplitWithRegex(corpus));
+}
+
+TEST_CASE("tf2bd_conlog_buffer", "[ConsoleLogParser]")
+{
+	ConsoleLogBuffer buffer(64);
+
+	const auto Write = [&](const std::string_view& data)
+	{
+		auto span = buffer.PrepareWrite(data.size());
+		REQUIRE(span.size() >= data.size());
+		data.copy(span.data(), data.size());
+		buffer.CommitWrite(data.size());
+	};
+
+	Write("\n01/02/2020 - 03:04:05: first line");
+	Write("\n01/02/2020 - 03:04:06: sec");
+	REQUIRE(buffer.GetView().size() == 61);
+
+	// Consume the first line, the partial second line should be moved to the front
+	// when we run out of space rather than reallocating
+	buffer.Consume(34);
+	Write("ond line");
+	REQUIRE(buffer.capacity() == 64);
+	REQUIRE(buffer.GetView() == "\n01/02/2020 - 03:04:06: second line");
+
+	// A single line larger than the buffer forces it to grow
+	const std::string hugeLine(100, 'x');
+	Write(hugeLine);
+	REQUIRE(buffer.capacity() >= 135);
+	REQUIRE(buffer.GetView() == "\n01/02/2020 - 03:04:06: second line" + hugeLine);
+
+	buffer.Consume(buffer.size());
+	REQUIRE(buffer.empty());
+}
@@ -0,0 +1,79 @@
+#include "IPlayer.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <utility>
+
+using namespace tf2_bot_detector;
+
+namespace
+{
+	struct TestData
+	{
+		TestData(int value = 0) : m_Value(value) { s_LiveCount++; }
+		TestData(const TestData& other) : m_Value(other.m_Value) { s_LiveCount++; }
+		~TestData() { s_LiveCount--; }
+
+		int m_Value = 0;
+		static inline int s_LiveCount = 0;
+	};
+
+	struct OtherTestData
+	{
+		std::string m_Text;
+	};
+}
+
+TEST_CASE("tf2bd_player_data_storage", "[WorldState]")
+{
+	PlayerDataStorage storage;
+	CHECK(!storage.Get<TestData>());
+
+	SECTION("Store and fetch")
+	{
+		storage.Set(TestData(5));
+		REQUIRE(storage.Get<TestData>());
+		CHECK(storage.Get<TestData>()->m_Value == 5);
+		CHECK(!storage.Get<OtherTestData>()); // Other types have their own slots
+
+		storage.GetOrCreate<OtherTestData>().m_Text = "text";
+		CHECK(storage.GetOrCreate<OtherTestData>().m_Text == "text"); // Not created again
+		CHECK(storage.Get<TestData>()->m_Value == 5);
+
+		storage.Set(TestData(6));
+		CHECK(storage.Get<TestData>()->m_Value == 6);
+		CHECK(TestData::s_LiveCount == 1); // The old one is destroyed
+
+		PlayerDataStorage other;
+		CHECK(!other.Get<TestData>());
+	}
+
+	SECTION("Const and non-const share a slot")
+	{
+		const TestData value(7);
+		storage.Set(value); // Deduced as const TestData&
+		REQUIRE(storage.Get<TestData>());
+		CHECK(storage.Get<TestData>()->m_Value == 7);
+
+		const auto& constStorage = std::as_const(storage);
+		REQUIRE(constStorage.Get<TestData>());
+		CHECK(constStorage.Get<TestData>() == storage.Get<TestData>());
+		CHECK(storage.Get<const TestData>() == storage.Get<TestData>());
+		CHECK(&storage.GetOrCreate<const TestData>() == storage.Get<TestData>());
+
+		storage.Get<TestData>()->m_Value = 8;
+		CHECK(constStorage.Get<const TestData>()->m_Value == 8);
+	}
+
+	SECTION("Storage owns what's stored")
+	{
+		{
+			PlayerDataStorage temp;
+			temp.GetOrCreate<TestData>(3);
+			CHECK(TestData::s_LiveCount == 1);
+		}
+
+		CHECK(TestData::s_LiveCount == 0);
+	}
+}
@@ -0,0 +1,134 @@
+#include "PlayerNameIndex.h"
+#include "Log.h"
+
+#include <catch2/catch.hpp>
+#include <mh/text/format.hpp>
+
+#include <unordered_map>
+
+using namespace std::chrono_literals;
+using namespace std::string_view_literals;
+using namespace tf2_bot_detector;
+
+TEST_CASE("tf2bd_player_name_index", "[WorldState]")
+{
+	PlayerNameIndex index;
+
+	const SteamID player1(76561198003911389);
+	const SteamID player2(76561198003911390);
+	const SteamID player3(76561198003911391);
+	const time_point_t start{ 1000s };
+
+	index.Update(player1, "", "Player", start);
+	REQUIRE(index.Find("Player"sv) == player1);
+	REQUIRE(!index.Find("player"sv));
+
+	SECTION("Most recently updated player wins a stolen name")
+	{
+		index.Update(player2, "", "Player", start + 1s);
+		REQUIRE(index.Find("Player"sv) == player2);
+
+		index.Update(player1, "Player", "Player", start + 2s);
+		REQUIRE(index.Find("Player"sv) == player1);
+
+		// An older update doesn't take the name back
+		index.Update(player2, "Player", "Player", start + 1s);
+		REQUIRE(index.Find("Player"sv) == player1);
+	}
+
+	SECTION("Ties go to whoever was updated last")
+	{
+		index.Update(player2, "", "Player", start);
+		index.Update(player3, "", "Player", start);
+		REQUIRE(index.Find("Player"sv) == player3);
+
+		index.Update(player1, "Player", "Player", start);
+		REQUIRE(index.Find("Player"sv) == player1);
+	}
+
+	SECTION("Renames")
+	{
+		index.Update(player2, "", "Player", start + 1s);
+		index.Update(player2, "Player", "Someone Else", start + 2s);
+
+		REQUIRE(index.Find("Player"sv) == player1);
+		REQUIRE(index.Find("Someone Else"sv) == player2);
+
+		index.Update(player1, "Player", "Renamed", start + 3s);
+		REQUIRE(!index.Find("Player"sv));
+		REQUIRE(index.size() == 2);
+	}
+
+	SECTION("Clear")
+	{
+		index.Clear();
+		REQUIRE(!index.Find("Player"sv));
+		REQUIRE(index.size() == 0);
+	}
+}
+
+TEST_CASE("tf2bd_player_name_index_benchmark", "[.][WorldState][benchmark]")
+{
+	// A full 100 player community server, with a few name stealers thrown in
+	constexpr size_t PLAYER_COUNT = 100;
+	constexpr size_t LOOKUP_COUNT = 1'000'000;
+
+	struct PlayerData
+	{
+		std::string m_Name;
+		time_point_t m_LastStatusUpdateTime;
+	};
+
+	std::unordered_map<SteamID, PlayerData> players;
+	PlayerNameIndex index;
+	std::vector<std::string> names;
+
+	for (size_t i = 0; i < PLAYER_COUNT; i++)
+	{
+		const SteamID id(76561198000000000 + i);
+		auto name = mh::format("Community Server Regular #{}", (i % 90));
+		const time_point_t timestamp{ std::chrono::seconds(i) };
+
+		index.Update(id, "", name, timestamp);
+		players.emplace(id, PlayerData{ name, timestamp });
+		names.push_back(std::move(name));
+	}
+
+	// What WorldState::FindSteamIDForName used to do
+	const auto LinearScan = [&](const std::string_view& name)
+	{
+		std::optional<SteamID> retVal;
+		time_point_t lastUpdated{};
+		for (const auto& [id, data] : players)
+		{
+			if (data.m_Name == name && data.m_LastStatusUpdateTime > lastUpdated)
+			{
+				retVal = id;
+				lastUpdated = data.m_LastStatusUpdateTime;
+			}
+		}
+		return retVal;
+	};
+
+	const auto Measure = [&](const char* name, auto&& findFunc)
+	{
+		uint64_t checksum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < LOOKUP_COUNT; i++)
+		{
+			if (auto found = findFunc(names[i % names.size()]))
+				checksum += found->ID;
+		}
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		Log("{}: {} lookups in {:1.3f} ms ({:1.1f} ns/lookup, checksum {})",
+			name, LOOKUP_COUNT, elapsed * 1000, elapsed * 1e9 / LOOKUP_COUNT, checksum);
+		return std::make_pair(elapsed, checksum);
+	};
+
+	const auto [scanTime, scanChecksum] = Measure("Linear scan", LinearScan);
+	const auto [indexTime, indexChecksum] = Measure("PlayerNameIndex", [&](const std::string_view& name) { return index.Find(name); });
+	Log("PlayerNameIndex speedup: {:1.1f}x", scanTime / indexTime);
+
+	CHECK(scanChecksum == indexChecksum);
+}
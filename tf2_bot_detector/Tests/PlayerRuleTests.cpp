@@ -1,11 +1,18 @@
 #include "Config/Rules.h"
+#include "Networking/SteamAPI.h"
 #include "IPlayer.h"
+#include "Log.h"
 
 #include <mh/error/not_implemented_error.hpp>
 #include <mh/text/codecvt.hpp>
+#include <mh/text/format.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
 using namespace std::string_view_literals;
 using namespace tf2_bot_detector;
 
@@ -14,6 +21,7 @@ namespace
 	struct MockPlayer : IPlayer
 	{
 		std::string m_Name;
+		mh::expected<SteamAPI::PlayerSummary, std::error_condition> m_PlayerSummary = std::errc::operation_in_progress;
 
 		const IWorldState& GetWorld() const override { throw mh::not_implemented_error(); }
 
@@ -29,7 +37,7 @@ namespace
 		}
 		const mh::expected<SteamAPI::PlayerSummary, std::error_condition>& GetPlayerSummary() const override
 		{
-			throw mh::not_implemented_error();
+			return m_PlayerSummary;
 		}
 		const mh::expected<SteamAPI::PlayerBans, std::error_condition>& GetPlayerBans() const override
 		{
@@ -79,11 +87,7 @@ namespace
 		{
 			throw mh::not_implemented_error();
 		}
-		std::any& GetOrCreateDataStorage(const std::type_index& type) override
-		{
-			throw mh::not_implemented_error();
-		}
-		const std::any* FindDataStorage(const std::type_index& type) const override
+		const PlayerDataStorage& GetDataStorage() const override
 		{
 			throw mh::not_implemented_error();
 		}
@@ -98,6 +102,21 @@ namespace
 	};
 }
 
+static ModerationRule MakeRule(std::string description, std::optional<TextMatch> usernameMatch,
+	std::optional<TextMatch> chatMsgMatch = std::nullopt, std::vector<std::string_view> avatarHashes = {},
+	TriggerMatchMode mode = TriggerMatchMode::MatchAll)
+{
+	ModerationRule rule;
+	rule.m_Description = std::move(description);
+	rule.m_Triggers.m_Mode = mode;
+	rule.m_Triggers.m_UsernameTextMatch = std::move(usernameMatch);
+	rule.m_Triggers.m_ChatMsgTextMatch = std::move(chatMsgMatch);
+	for (const auto& hash : avatarHashes)
+		rule.m_Triggers.m_AvatarMatches.push_back(AvatarMatch{ std::string(hash) });
+
+	return rule;
+}
+
 TEST_CASE("Player Rules - ends_with", "[PlayerRuleTests]")
 {
 	MockPlayer player;
@@ -189,3 +208,267 @@ TEST_CASE("Player Rules - chatmsg word", "[PlayerRuleTests]")
 	textMatch.m_Patterns = { "smelly" };
 	REQUIRE(!rule.Match(player, chatMsg));
 }
+
+TEST_CASE("Player Rules - compiled rule set", "[PlayerRuleTests]")
+{
+	MockPlayer player;
+	player.m_Name = "Special Gamer";
+
+	const CompiledRuleSet rules({
+		MakeRule("equal", TextMatch{ TextMatchMode::Equal, { "special gamer" } }),
+		MakeRule("equal case sensitive", TextMatch{ TextMatchMode::Equal, { "special gamer" }, true }),
+		MakeRule("contains", TextMatch{ TextMatchMode::Contains, { "AL GA" } }),
+		MakeRule("starts_with", TextMatch{ TextMatchMode::StartsWith, { "spec" } }),
+		MakeRule("ends_with", TextMatch{ TextMatchMode::EndsWith, { "gamers" } }),
+		MakeRule("regex", TextMatch{ TextMatchMode::Regex, { "special\\s+g.*" } }),
+		MakeRule("regex case sensitive", TextMatch{ TextMatchMode::Regex, { "special\\s+g.*" }, true }),
+		MakeRule("invalid regex", TextMatch{ TextMatchMode::Regex, { "(unclosed", "Special.*" } }),
+		MakeRule("word", TextMatch{ TextMatchMode::Word, { "GAMER" } }),
+	});
+
+	REQUIRE(rules.GetInvalidPatternCount() == 1);
+	CHECK(!rules.HasAvatarTriggers());
+	CHECK(rules.GetGeneration() != CompiledRuleSet({}).GetGeneration());
+
+	std::vector<std::string> matches;
+	for (const ModerationRule& rule : rules.FindMatches(player))
+	{
+		// Must agree with the uncompiled rules, except where those would have thrown
+		if (rule.m_Description != "invalid regex")
+			CHECK(rule.Match(player));
+
+		CHECK(&rules.GetRules()[rules.GetRuleIndex(rule)] == &rule);
+		matches.push_back(rule.m_Description);
+	}
+
+	REQUIRE(matches == std::vector<std::string>{ "equal", "contains", "starts_with", "regex", "invalid regex", "word" });
+}
+
+TEST_CASE("Player Rules - compiled rule set triggers", "[PlayerRuleTests]")
+{
+	MockPlayer player;
+	player.m_Name = "Special Gamer";
+
+	std::vector<ModerationRule> ruleList
+	{
+		MakeRule("all", TextMatch{ TextMatchMode::Contains, { "gamer" } }, TextMatch{ TextMatchMode::Contains, { "buy" } }, {}, TriggerMatchMode::MatchAll),
+		MakeRule("all, wrong name", TextMatch{ TextMatchMode::Contains, { "bot" } }, TextMatch{ TextMatchMode::Contains, { "buy" } }, {}, TriggerMatchMode::MatchAll),
+		MakeRule("all, regex name", TextMatch{ TextMatchMode::Regex, { ".*gamer" } }, TextMatch{ TextMatchMode::EndsWith, { "now" } }, {}, TriggerMatchMode::MatchAll),
+		MakeRule("any, chat only", TextMatch{ TextMatchMode::Equal, { "bot" } }, TextMatch{ TextMatchMode::StartsWith, { "BUY" } }, {}, TriggerMatchMode::MatchAny),
+		MakeRule("any, neither", TextMatch{ TextMatchMode::Equal, { "bot" } }, TextMatch{ TextMatchMode::Contains, { "sell" } }, {}, TriggerMatchMode::MatchAny),
+		MakeRule("any, empty pattern", TextMatch{ TextMatchMode::Equal, { "bot" } }, TextMatch{ TextMatchMode::Contains, { "" } }, {}, TriggerMatchMode::MatchAny),
+		MakeRule("any, word", TextMatch{ TextMatchMode::Word, { "gam" } }, TextMatch{ TextMatchMode::Word, { "ITEMS", "ite" } }, {}, TriggerMatchMode::MatchAny),
+		MakeRule("all, words", TextMatch{ TextMatchMode::Word, { "special" } }, TextMatch{ TextMatchMode::Word, { "gg" } }, {}, TriggerMatchMode::MatchAll),
+	};
+
+	const CompiledRuleSet rules(ruleList);
+	const auto FindMatches = [&](const std::string_view& chatMsg)
+	{
+		std::vector<std::string> matches;
+		for (const ModerationRule& rule : rules.FindMatches(player, chatMsg))
+		{
+			CHECK(rule.Match(player, chatMsg));
+			matches.push_back(rule.m_Description);
+		}
+
+		for (const ModerationRule& rule : ruleList)
+		{
+			if (rule.Match(player, chatMsg))
+				CHECK(std::find(matches.begin(), matches.end(), rule.m_Description) != matches.end());
+		}
+
+		return matches;
+	};
+
+	CHECK(FindMatches("buy items now") == std::vector<std::string>{ "all", "all, regex name", "any, chat only", "any, empty pattern", "any, word" });
+	CHECK(FindMatches("gg") == std::vector<std::string>{ "any, empty pattern", "all, words" });
+	CHECK(FindMatches("(gg)ggg, Items!") == std::vector<std::string>{ "any, empty pattern", "any, word", "all, words" });
+	CHECK(FindMatches({}).empty());
+}
+
+TEST_CASE("Player Rules - compiled rule set avatars", "[PlayerRuleTests]")
+{
+	MockPlayer player;
+	player.m_Name = "Special Gamer";
+
+	constexpr auto AVATAR_HASH = "fef49e7fa7e1997310d705b2a6158ff8dc1cdfeb"sv;
+	constexpr auto OTHER_AVATAR_HASH = "0000000000000000000000000000000000000000"sv;
+
+	const std::vector<ModerationRule> ruleList
+	{
+		MakeRule("avatar", std::nullopt, std::nullopt, { OTHER_AVATAR_HASH, AVATAR_HASH }),
+		MakeRule("other avatar", std::nullopt, std::nullopt, { OTHER_AVATAR_HASH }),
+		MakeRule("avatar and name", TextMatch{ TextMatchMode::Contains, { "gamer" } }, std::nullopt, { AVATAR_HASH }),
+		MakeRule("avatar and wrong name", TextMatch{ TextMatchMode::Contains, { "bot" } }, std::nullopt, { AVATAR_HASH }),
+		MakeRule("not a hash", std::nullopt, std::nullopt, { "notahash" }),
+		MakeRule("upper case avatar", std::nullopt, std::nullopt, { "FEF49E7FA7E1997310D705B2A6158FF8DC1CDFEB" }),
+	};
+
+	const CompiledRuleSet rules(ruleList);
+	CHECK(rules.HasAvatarTriggers());
+	CHECK(rules.GetInvalidPatternCount() == 1);
+
+	const auto FindMatches = [&]
+	{
+		std::vector<std::string> matches;
+		for (const ModerationRule& rule : rules.FindMatches(player))
+		{
+			CHECK(rule.Match(player));
+			matches.push_back(rule.m_Description);
+		}
+
+		return matches;
+	};
+
+	// Summary hasn't loaded yet
+	CHECK(FindMatches().empty());
+
+	player.m_PlayerSummary = SteamAPI::PlayerSummary{};
+	auto& summary = player.m_PlayerSummary.value();
+	summary.m_AvatarHash = AVATAR_HASH;
+	CHECK(FindMatches() == std::vector<std::string>{ "avatar", "avatar and name", "upper case avatar" });
+
+	summary.m_AvatarHash = "FEF49E7FA7E1997310D705B2A6158ff8dc1cdfeb";
+	CHECK(FindMatches() == std::vector<std::string>{ "avatar", "avatar and name", "upper case avatar" });
+
+	summary.m_AvatarHash = "fef49e7fa7e1997310d705b2a6158ff8dc1cdfe"; // Too short
+	CHECK(FindMatches().empty());
+}
+
+TEST_CASE("Player Rules - cached rule matches", "[PlayerRuleTests]")
+{
+	MockPlayer player;
+	player.m_Name = "Special Gamer";
+
+	constexpr auto AVATAR_HASH = "fef49e7fa7e1997310d705b2a6158ff8dc1cdfeb"sv;
+
+	const std::vector<ModerationRule> ruleList
+	{
+		MakeRule("bot name", TextMatch{ TextMatchMode::Contains, { "bot" } }),
+		MakeRule("gamer name", TextMatch{ TextMatchMode::Contains, { "gamer" } }),
+		MakeRule("avatar", std::nullopt, std::nullopt, { AVATAR_HASH }),
+	};
+
+	const CompiledRuleSet rules(ruleList);
+
+	const auto GetMatches = [&](const PlayerRuleMatches& matches)
+	{
+		std::vector<std::string> descriptions;
+		for (size_t ruleIndex : matches.GetMatchedRules())
+			descriptions.push_back(rules.GetRules()[ruleIndex].m_Description);
+
+		return descriptions;
+	};
+
+	PlayerRuleMatches matches;
+	CHECK(!matches.Update(rules, player)); // Never checked before
+	CHECK(GetMatches(matches) == std::vector<std::string>{ "gamer name" });
+
+	// Nothing changed, the same rules are still there to be applied again
+	CHECK(matches.Update(rules, player));
+	CHECK(GetMatches(matches) == std::vector<std::string>{ "gamer name" });
+
+	SECTION("Name changed")
+	{
+		player.m_Name = "Special Bot";
+		CHECK(!matches.Update(rules, player));
+		CHECK(GetMatches(matches) == std::vector<std::string>{ "bot name" });
+		CHECK(matches.Update(rules, player));
+	}
+
+	SECTION("Avatar changed")
+	{
+		player.m_PlayerSummary = SteamAPI::PlayerSummary{};
+		player.m_PlayerSummary.value().m_AvatarHash = AVATAR_HASH;
+		CHECK(!matches.Update(rules, player));
+		CHECK(GetMatches(matches) == std::vector<std::string>{ "gamer name", "avatar" });
+		CHECK(matches.Update(rules, player));
+	}
+
+	SECTION("Rules changed")
+	{
+		// Same rules, but compiled again (like when a list finishes loading)
+		const CompiledRuleSet newRules(ruleList);
+		CHECK(!matches.Update(newRules, player));
+		CHECK(matches.Update(newRules, player));
+		CHECK(!matches.Update(rules, player));
+	}
+}
+
+TEST_CASE("Player Rules - compiled rule set benchmark", "[.][PlayerRuleTests][benchmark]")
+{
+	std::vector<ModerationRule> ruleList;
+	std::vector<std::string> messages;
+
+	SECTION("Regex rules")
+	{
+		// Roughly what a big third party rules list looks like: hundreds of regex rules for
+		// bot names and spam messages
+		for (size_t i = 0; i < 400; i++)
+		{
+			ruleList.push_back(MakeRule(mh::format("spam bot #{}", i),
+				TextMatch{ TextMatchMode::Regex, { mh::format("\\(\\d+\\)\\s*bot{}[_ ]?\\w*", i) } },
+				TextMatch{ TextMatchMode::Regex, { mh::format(".*(?:free|cheap) (?:items|keys) at site{}\\.(?:com|net).*", i) } },
+				{}, TriggerMatchMode::MatchAny));
+		}
+
+		for (size_t i = 0; i < 200; i++)
+			messages.push_back(mh::format("gg, that was a fun round {} (free items at site{}.com)", i, i * 3));
+	}
+
+	SECTION("Literal rules")
+	{
+		// Most rules in the wild are plain "contains" or "word" checks on names and chat messages
+		for (size_t i = 0; i < 2000; i++)
+		{
+			TextMatch chatMatch;
+			if (i % 3 == 0)
+				chatMatch = TextMatch{ TextMatchMode::Word, { mh::format("site{}", i) } };
+			else
+				chatMatch = TextMatch{ (i % 3 == 1) ? TextMatchMode::Contains : TextMatchMode::StartsWith, { mh::format("free items at site{}", i) } };
+
+			ruleList.push_back(MakeRule(mh::format("spam bot #{}", i),
+				TextMatch{ TextMatchMode::Contains, { mh::format("bot{}.tf", i), mh::format("BOT{}_", i) } },
+				std::move(chatMatch), {}, TriggerMatchMode::MatchAny));
+		}
+
+		for (size_t i = 0; i < 1000; i++)
+			messages.push_back(mh::format("gg, that was a fun round {} (FREE ITEMS AT SITE{}.com)", i, i * 3));
+	}
+
+	const CompiledRuleSet compiled(ruleList);
+	MockPlayer player;
+	player.m_Name = "just a regular player";
+
+	const auto Measure = [&](const char* name, auto&& matchFunc)
+	{
+		size_t matchCount = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& msg : messages)
+			matchCount += matchFunc(msg);
+
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		Log("{}: {} messages against {} rules in {:1.3f} ms ({:1.1f} us/message, {} matches)",
+			name, messages.size(), ruleList.size(), elapsed * 1000, elapsed * 1e6 / messages.size(), matchCount);
+		return std::make_pair(elapsed, matchCount);
+	};
+
+	const auto [uncompiledTime, uncompiledMatches] = Measure("ModerationRule::Match", [&](const std::string& msg)
+		{
+			size_t count = 0;
+			for (const auto& rule : ruleList)
+				count += rule.Match(player, msg);
+			return count;
+		});
+
+	const auto [compiledTime, compiledMatches] = Measure("CompiledRuleSet", [&](const std::string& msg)
+		{
+			size_t count = 0;
+			for ([[maybe_unused]] const auto& rule : compiled.FindMatches(player, msg))
+				count++;
+			return count;
+		});
+
+	Log("CompiledRuleSet speedup: {:1.1f}x", uncompiledTime / compiledTime);
+	CHECK(uncompiledMatches == compiledMatches);
+}
@@ -0,0 +1,59 @@
+#include "PlayerTable.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace std::chrono_literals;
+using namespace tf2_bot_detector;
+
+static void CheckRecencyOrder(const PlayerTable& table)
+{
+	size_t count = 0;
+	auto prevRow = PlayerTable::NO_ROW;
+	for (auto row = table.m_NewestRow; row != PlayerTable::NO_ROW; row = table.m_OlderRows[row])
+	{
+		REQUIRE(row < table.size());
+		REQUIRE(table.m_NewerRows[row] == prevRow);
+		if (prevRow != PlayerTable::NO_ROW)
+			REQUIRE(table.m_LastStatusUpdateTimes[prevRow] >= table.m_LastStatusUpdateTimes[row]);
+
+		prevRow = row;
+		count++;
+	}
+
+	REQUIRE(table.m_OldestRow == prevRow);
+	REQUIRE(count == table.size());
+}
+
+TEST_CASE("tf2bd_player_table_recency", "[PlayerTable]")
+{
+	PlayerTable table;
+	std::mt19937 random(1234);
+	const time_point_t startTime{ 1'600'000'000s };
+
+	for (uint64_t i = 0; i < 1000; i++)
+	{
+		const auto action = random() % 8;
+		if (action == 0 && !table.empty())
+		{
+			table.RemoveRow(PlayerTable::row_t(random() % table.size()));
+		}
+		else if (action < 3 || table.empty())
+		{
+			table.AddRow(SteamID(76561198000000000 + i), nullptr);
+		}
+		else
+		{
+			// Mostly in order, like status lines, but not always
+			const auto time = startTime + std::chrono::seconds(i) - std::chrono::seconds(random() % 4 == 0 ? random() % 100 : 0);
+			table.SetLastStatusUpdateTime(PlayerTable::row_t(random() % table.size()), time);
+		}
+
+		CheckRecencyOrder(table);
+	}
+
+	table.Clear();
+	CheckRecencyOrder(table);
+}
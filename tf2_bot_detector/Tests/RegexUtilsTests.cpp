@@ -0,0 +1,83 @@
+#include "Util/RegexUtils.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <string_view>
+
+using namespace tf2_bot_detector;
+
+namespace
+{
+	template<detail::ct_regex::fixed_string Pattern>
+	void RequireSameAsStdRegex(const std::initializer_list<std::string_view>& inputs)
+	{
+		static constexpr ct_regex<Pattern> s_CTRegex;
+		static const std::regex s_Regex(std::string(Pattern.view()));
+
+		for (const auto& input : inputs)
+		{
+			CAPTURE(Pattern.view(), input);
+
+			svmatch expected;
+			const bool expectedMatch = std::regex_match(input.begin(), input.end(), expected, s_Regex);
+
+			const auto actual = s_CTRegex.match(input);
+			REQUIRE(bool(actual) == expectedMatch);
+			if (!expectedMatch)
+				continue;
+
+			REQUIRE(actual.size() == expected.size());
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				CAPTURE(i);
+				REQUIRE(actual[i].matched == expected[i].matched);
+				if (expected[i].matched)
+					REQUIRE(to_string_view(actual[i]) == to_string_view(expected[i]));
+			}
+		}
+	}
+}
+
+TEST_CASE("tf2bd_ct_regex", "[RegexUtils]")
+{
+	// Greedy backtracking across several captures
+	RequireSameAsStdRegex<R"regex((.*) killed (.*) with (.*)\.( \(crit\))?)regex">({
+		"a killed b with c.",
+		"a killed b with c. (crit)",
+		"a killed b killed c with d with e.",
+		"a killed b with c",
+		"",
+		});
+
+	// Optional groups, character classes, newlines in captures
+	RequireSameAsStdRegex<R"regex(#\s+(\d+)\s+"((?:.|[\r\n])+)"\s+(\[.*\])\s+(?:(\d+):)?(\d+):(\d+)\s+(\d+)\s+(\d+)\s+(\w+)(?:\s+(\S+))?)regex">({
+		"#    348 \"2fort\x0A closed due to COVID\x0A\" [U:1:1118537734] 00:51  157    0 active",
+		"#    348 \"a \"quoted\" name\" [U:1:1118537734] 1:00:51  157    0 spawning 1.2.3.4:27005",
+		"#    348 \"name\" [U:1:1118537734] 00:51  157    active",
+		});
+
+	// Lazy repeats and alternation
+	RequireSameAsStdRegex<R"regex(Connecting to( matchmaking server)? (.*?)(\.\.\.)?)regex">({
+		"Connecting to matchmaking server 169.254.1.2:27015...",
+		"Connecting to 169.254.1.2:27015...",
+		"Connecting to 169.254.1.2:27015",
+		"Connecting to",
+		});
+	RequireSameAsStdRegex<R"regex(Msg from ((?:\d+\.\d+\.\d+\.\d+:\d+)|loopback): svc_UserMessage: type (\d+), bytes (\d+))regex">({
+		"Msg from 169.254.1.2:27015: svc_UserMessage: type 5, bytes 20",
+		"Msg from loopback: svc_UserMessage: type 5, bytes 20",
+		"Msg from somewhere: svc_UserMessage: type 5, bytes 20",
+		});
+
+	// Bounded repeats
+	RequireSameAsStdRegex<R"regex( *(\d+) ms : (.{1,32}))regex">({
+		"  52 ms : 12345678901234567890123456789012",
+		"  52 ms : 123456789012345678901234567890123",
+		"52 ms : ",
+		});
+	RequireSameAsStdRegex<R"regex(map     : (.*) at: ((?:-|\d)+) x, ((?:-|\d)+) y, ((?:-|\d)+) z)regex">({
+		"map     : cp_foo at: -10 x, 20 y, -3 z",
+		"map     : cp_foo at: 1.5 x, 20 y, -3 z",
+		});
+}
@@ -0,0 +1,246 @@
+#include "Config/Settings.h"
+#include "Networking/HTTPHelpers.h"
+#include "ModeratorLogic.h"
+#include "WorldJournal.h"
+
+#include <catch2/catch.hpp>
+#include <mh/text/format.hpp>
+#include <nlohmann/json.hpp>
+
+#include <sstream>
+#include <string>
+
+using namespace std::chrono_literals;
+using namespace std::string_view_literals;
+using namespace tf2_bot_detector;
+
+TEST_CASE("tf2bd_journal_roundtrip", "[Journal]")
+{
+	const time_point_t startTime{ 1'600'000'000s };
+	const std::string binaryData("\0\x80\xFF\n"sv);
+
+	std::stringstream stream;
+	{
+		JournalWriter writer(stream, startTime);
+		writer.Write(JournalRecordType::ConsoleLogText, "\n01/02/2020 - 03:04:05: Connected to 1.2.3.4:27015", {}, startTime + 1ms);
+		writer.Write(JournalRecordType::HTTPResponse, binaryData, "https://api.steampowered.com:443/", startTime + 2s);
+		writer.Write(JournalRecordType::GameCommandOutput, std::string(1000, 'x'), {}, startTime + 1s); // Clock went backwards
+		writer.Write(JournalRecordType::HTTPError, {}, "https://logs.tf:443/", startTime + 1s);
+	}
+
+	JournalReader reader(stream);
+	REQUIRE(reader.GetStartTime() == startTime);
+
+	JournalRecord record;
+	REQUIRE(reader.Read(record));
+	CHECK(record.m_Type == JournalRecordType::ConsoleLogText);
+	CHECK(record.m_Timestamp == startTime + 1ms);
+	CHECK(record.m_Key.empty());
+	CHECK(record.m_Data == "\n01/02/2020 - 03:04:05: Connected to 1.2.3.4:27015");
+
+	REQUIRE(reader.Read(record));
+	CHECK(record.m_Type == JournalRecordType::HTTPResponse);
+	CHECK(record.m_Timestamp == startTime + 2s);
+	CHECK(record.m_Key == "https://api.steampowered.com:443/");
+	CHECK(record.m_Data == binaryData);
+
+	REQUIRE(reader.Read(record));
+	CHECK(record.m_Type == JournalRecordType::GameCommandOutput);
+	CHECK(record.m_Timestamp == startTime + 1s);
+	CHECK(record.m_Data == std::string(1000, 'x'));
+
+	REQUIRE(reader.Read(record));
+	CHECK(record.m_Type == JournalRecordType::HTTPError);
+	CHECK(record.m_Key == "https://logs.tf:443/");
+	CHECK(record.m_Data.empty());
+
+	REQUIRE(!reader.Read(record));
+
+	SECTION("Truncated journal")
+	{
+		// What's left of a journal when we crash partway through writing a record
+		const std::string truncated = stream.str().substr(0, stream.str().size() - 10);
+		std::stringstream truncatedStream(truncated);
+
+		JournalReader truncatedReader(truncatedStream);
+		size_t count = 0;
+		while (truncatedReader.Read(record))
+			count++;
+
+		CHECK(count == 3);
+	}
+
+	SECTION("Not a journal")
+	{
+		std::stringstream notAJournal("\n01/02/2020 - 03:04:05: Connected to 1.2.3.4:27015");
+		REQUIRE_THROWS_AS(JournalReader(notAJournal), std::runtime_error);
+	}
+}
+
+TEST_CASE("tf2bd_journal_url_key", "[Journal]")
+{
+	CHECK(GetJournalKey("https://logs.tf/api/v1/log?player=76561197960287930&limit=0") ==
+		"https://logs.tf:443/api/v1/log?player=76561197960287930&limit=0");
+	CHECK(GetJournalKey("https://api.steampowered.com/ISteamUser/GetPlayerBans/v0001/?key=SECRET&steamids=1,2") ==
+		"https://api.steampowered.com:443/ISteamUser/GetPlayerBans/v0001/?steamids=1,2");
+	CHECK(GetJournalKey("https://api.steampowered.com/ISteamUser/GetFriendList/v0001/?steamid=1&key=SECRET") ==
+		"https://api.steampowered.com:443/ISteamUser/GetFriendList/v0001/?steamid=1");
+	CHECK(GetJournalKey("https://api.steampowered.com/?key=SECRET") == "https://api.steampowered.com:443/");
+}
+
+TEST_CASE("tf2bd_journal_replay", "[Journal]")
+{
+	const time_point_t startTime{ 1'600'000'000s };
+	const auto MakeSteamID = [](uint32_t id) { return SteamID(id, SteamAccountType::Individual, SteamAccountUniverse::Public); };
+
+	// What the recording machine was running with
+	JournalModeratorHeader header;
+	header.m_LocalSteamID = MakeSteamID(1);
+	header.m_AutoMark = false;
+	header.m_AutoVotekick = false;
+	header.m_HasSteamAPIKey = true;
+	header.m_LazyLoadAPIData = false; // Look everyone up
+
+	const auto MakeSummary = [&](uint32_t id)
+	{
+		return nlohmann::json{
+			{ "steamid", std::to_string(MakeSteamID(id).ID64) },
+			{ "personaname", mh::format("Player {}", id) },
+			{ "personastate", 0 },
+			{ "communityvisibilitystate", 3 },
+			{ "avatarhash", "" },
+			{ "profileurl", "" },
+		};
+	};
+	const auto MakeBans = [&](uint32_t id)
+	{
+		return nlohmann::json{
+			{ "SteamId", std::to_string(MakeSteamID(id).ID64) },
+			{ "CommunityBanned", false },
+			{ "NumberOfVACBans", 0 },
+			{ "NumberOfGameBans", 0 },
+			{ "DaysSinceLastBan", 0 },
+			{ "EconomyBan", "none" },
+		};
+	};
+
+	std::stringstream stream;
+	size_t recordCount = 0;
+	{
+		JournalWriter writer(stream, startTime);
+		const auto Write = [&](JournalRecordType type, const std::string_view& data, const std::string_view& key, time_point_t timestamp)
+		{
+			writer.Write(type, data, key, timestamp);
+			recordCount++;
+		};
+
+		Write(JournalRecordType::ModeratorHeader, nlohmann::json(header).dump(), {}, startTime);
+		Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:00: tick\n", {}, startTime + 1s);
+		Write(JournalRecordType::HTTPResponse, R"({"friendslist":{"friends":[]}})",
+			GetJournalKey(mh::format("https://api.steampowered.com/ISteamUser/GetFriendList/v0001/?steamid={}", header.m_LocalSteamID.ID64)),
+			startTime + 1s);
+
+		std::string status;
+		for (uint32_t id = 1; id <= 3; id++)
+			status += mh::format("#    {} \"Player {}\" {} 00:10  50    0 active\n", id, id, MakeSteamID(id));
+
+		Write(JournalRecordType::GameCommandOutput, status, {}, startTime + 2s);
+		Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:05: tick\n", {}, startTime + 5s);
+
+		// Batched differently than the replay will ask for them, since that depends on hash order
+		const auto WriteBatch = [&](const std::string_view& path, const std::string_view& playersPointer,
+			const auto& makeEntry, std::initializer_list<uint32_t> ids)
+		{
+			std::string steamIDs;
+			nlohmann::json players = nlohmann::json::array();
+			for (uint32_t id : ids)
+			{
+				steamIDs += mh::format("{}{}", steamIDs.empty() ? "" : ",", MakeSteamID(id).ID64);
+				players.push_back(makeEntry(id));
+			}
+
+			nlohmann::json response;
+			response[nlohmann::json::json_pointer(std::string(playersPointer))] = std::move(players);
+			Write(JournalRecordType::HTTPResponse, response.dump(),
+				GetJournalKey(mh::format("https://api.steampowered.com{}?steamids={}", path, steamIDs)), startTime + 6s);
+		};
+		WriteBatch("/ISteamUser/GetPlayerSummaries/v0002/", "/response/players", MakeSummary, { 1, 2 });
+		WriteBatch("/ISteamUser/GetPlayerSummaries/v0002/", "/response/players", MakeSummary, { 3 });
+		WriteBatch("/ISteamUser/GetPlayerBans/v0001/", "/players", MakeBans, { 3, 1, 2 });
+
+		for (uint32_t id = 1; id <= 3; id++)
+		{
+			const auto steamID = MakeSteamID(id).ID64;
+			Write(JournalRecordType::HTTPResponse, R"({"response":{"game_count":1,"games":[{"appid":440,"playtime_forever":600}]}})",
+				GetJournalKey(mh::format("https://api.steampowered.com/IPlayerService/GetOwnedGames/v0001/?input_json=%7B%22appids_filter%22%3A%5B440%5D,%22include_played_free_games%22%3Atrue,%22steamid%22%3A{}%7D", steamID)),
+				startTime + 6s);
+			Write(JournalRecordType::HTTPResponse, R"({"total":5})",
+				GetJournalKey(mh::format("https://logs.tf/api/v1/log?player={}&limit=0", steamID)), startTime + 6s);
+		}
+
+		Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:06: tick\n", {}, startTime + 6s);
+		Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:07: tick\n", {}, startTime + 7s);
+	}
+
+	// What the replaying machine would otherwise use
+	Settings settings(nullptr);
+	settings.m_LocalSteamIDOverride = MakeSteamID(1000);
+	settings.m_AutoMark = true;
+	settings.m_AutoVotekick = true;
+	settings.m_LazyLoadAPIData = true;
+
+	// Nothing from this machine's cfg/
+	const ModeratorConfig moderatorConfig{ R"({"rules":[]})", R"({"players":[]})" };
+
+	const auto result = ReplayJournal(stream, settings, &moderatorConfig);
+	CHECK(result.m_RecordCount == recordCount);
+	CHECK(result.m_GameCommandOutputCount == 1);
+	CHECK(result.m_RecordedDuration == 7s);
+	CHECK(result.m_PlayerCount == 3);
+	CHECK(result.m_QueuedActionCount == 0); // Nobody is marked, so there's nothing to do
+
+	// Friends, one summaries and one bans request for all 3 players, and playtime and logs.tf for each
+	CHECK(result.m_HTTPResponseCount == 10);
+	CHECK(result.m_HTTPRequestCount == 9);
+	CHECK(result.m_HTTPUnansweredCount == 0);
+
+	CHECK(settings.GetLocalSteamID() == header.m_LocalSteamID);
+	CHECK(!settings.m_AutoMark);
+	CHECK(!settings.m_AutoVotekick);
+	CHECK(!settings.m_LazyLoadAPIData);
+	CHECK(!settings.GetSteamAPIKey().empty());
+}
+
+TEST_CASE("tf2bd_journal_replay_empty_output", "[Journal]")
+{
+	const time_point_t startTime{ 1'600'000'000s };
+	const SteamID playerID(2, SteamAccountType::Individual, SteamAccountUniverse::Public);
+
+	JournalModeratorHeader header;
+	header.m_LocalSteamID = SteamID(1, SteamAccountType::Individual, SteamAccountUniverse::Public);
+
+	// Commands that came back with nothing, or with nothing but whitespace
+	constexpr std::string_view EMPTY_OUTPUTS[] = { "", "\n", " \n\t\n", "Unknown command \"tf_bd_nothing\"" };
+
+	std::stringstream stream;
+	{
+		JournalWriter writer(stream, startTime);
+		writer.Write(JournalRecordType::ModeratorHeader, nlohmann::json(header).dump(), {}, startTime);
+		writer.Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:00: tick\n", {}, startTime + 1s);
+
+		for (const auto& output : EMPTY_OUTPUTS)
+			writer.Write(JournalRecordType::GameCommandOutput, output, {}, startTime + 2s);
+
+		writer.Write(JournalRecordType::GameCommandOutput,
+			mh::format("#    2 \"Player 2\" {} 00:10  50    0 active\n", playerID), {}, startTime + 3s);
+		writer.Write(JournalRecordType::ConsoleLogText, "01/01/2020 - 12:00:04: tick\n", {}, startTime + 4s);
+	}
+
+	Settings settings(nullptr);
+	const ModeratorConfig moderatorConfig{ R"({"rules":[]})", R"({"players":[]})" };
+
+	const auto result = ReplayJournal(stream, settings, &moderatorConfig);
+	CHECK(result.m_GameCommandOutputCount == std::size(EMPTY_OUTPUTS) + 1);
+	CHECK(result.m_DeliveryTimeoutCount == 0);
+	CHECK(result.m_PlayerCount == 1); // Whatever came after still made it through
+}
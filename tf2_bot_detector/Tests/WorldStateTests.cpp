@@ -0,0 +1,809 @@
+#include "Config/Settings.h"
+#include "ConsoleLog/ConsoleLogParser.h"
+#include "Networking/HTTPClient.h"
+#include "Networking/HTTPHelpers.h"
+#include "Networking/SteamAPI.h"
+#include "GlobalDispatcher.h"
+#include "IPlayer.h"
+#include "LobbyMember.h"
+#include "WorldState.h"
+#include "WorldStateSnapshot.h"
+
+#include <catch2/catch.hpp>
+#include <mh/text/format.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_view_literals;
+using namespace tf2_bot_detector;
+
+// Game command output, as if it came back over RCON. Returns once listeners have seen it.
+static void AddOutput(IWorldState& world, const std::string_view& output)
+{
+	const size_t chunkCount = world.GetConsoleOutputStats().m_ChunkCount;
+	world.AddConsoleOutputChunk(output);
+	while (world.GetConsoleOutputStats().m_ChunkCount == chunkCount)
+		GetDispatcher().run_for(1ms);
+}
+
+static SteamID MakeSteamID(uint32_t id)
+{
+	return SteamID(id, SteamAccountType::Individual, SteamAccountUniverse::Public);
+}
+
+static std::string MakeStatusLine(const SteamID& id)
+{
+	return mh::format("#    {} \"Player {}\" {} 00:10  50    0 active\n", id.ID % 100, id.ID, id);
+}
+
+// One line of tf_lobby_debug output
+static std::string MakeLobbyMemberLine(bool pending, size_t index, const SteamID& id, LobbyMemberTeam team)
+{
+	return mh::format("  {}[{}] {}  team = {}  type = MATCH_PLAYER\n", pending ? "Pending" : "Member", index, id,
+		team == LobbyMemberTeam::Defenders ? "TF_GC_TEAM_DEFENDERS" : "TF_GC_TEAM_INVADERS");
+}
+
+namespace
+{
+	// A WorldState fed the same way the game feeds it: console.log text (which is where
+	// world time comes from) and game command output
+	class TestWorld final
+	{
+	public:
+		static constexpr uint32_t LOCAL_PLAYER = 1;
+
+		TestWorld()
+		{
+			m_Settings.m_LocalSteamIDOverride = MakeSteamID(LOCAL_PLAYER);
+			m_Settings.m_AllowInternetUsage = false;
+			m_Settings.m_LazyLoadAPIData = true;
+			m_Settings.m_AutoMark = false;
+			m_Settings.m_MaxCachedPlayers = Settings::MIN_MAX_CACHED_PLAYERS;
+
+			m_World = IWorldState::Create(m_Settings, [this] { return m_WallClock; });
+			m_Parser.emplace(*m_World, m_Settings);
+		}
+
+		// Moves world time to some number of seconds after the start of the test
+		void SetTime(std::chrono::seconds time)
+		{
+			AddLog(MakeLogLine(time, "tick"));
+		}
+
+		// Appends to console.log. Returns once listeners have seen it.
+		void AddLog(const std::string_view& text)
+		{
+			m_Parser->AddText(text);
+
+			while (!m_Parser->IsIdle())
+				GetDispatcher().run_for(1ms);
+
+			m_Parser->Update();
+		}
+
+		static std::string MakeLogLine(std::chrono::seconds time, const std::string_view& text)
+		{
+			const auto seconds = time.count();
+			return mh::format("01/01/2020 - {:02}:{:02}:{:02}: {}\n",
+				12 + seconds / 3600, (seconds / 60) % 60, seconds % 60, text);
+		}
+
+		void AddStatus(uint32_t firstID, uint32_t count = 1)
+		{
+			std::string output;
+			for (uint32_t id = firstID; id < (firstID + count); id++)
+				output += MakeStatusLine(MakeSteamID(id));
+
+			AddOutput(*m_World, output);
+		}
+
+		// Queues summaries for the given players, and updates until they've all arrived
+		bool FetchSummaries(uint32_t firstID, uint32_t count)
+		{
+			std::vector<const IPlayer*> players;
+			for (uint32_t id = firstID; id < (firstID + count); id++)
+			{
+				if (const IPlayer* player = m_World->FindPlayer(MakeSteamID(id)))
+				{
+					player->GetPlayerSummary();
+					players.push_back(player);
+				}
+			}
+
+			// One batch of 100 each time Steam API requests are allowed
+			for (size_t i = 0; i <= (players.size() / 100 + 1); i++)
+			{
+				m_WallClock += 5s;
+				m_World->Update();
+			}
+
+			return std::all_of(players.begin(), players.end(),
+				[](const IPlayer* player) { return !!player->GetPlayerSummary(); });
+		}
+
+		Settings m_Settings{ nullptr };
+		time_point_t m_WallClock{ 1'600'000'000s }; // Paces Steam API requests, world time comes from console.log
+		std::shared_ptr<IWorldState> m_World;
+		std::optional<ConsoleLogParser> m_Parser;
+	};
+
+	// Answers Steam API summaries, bans and playtime requests, and logs.tf player requests.
+	// Remembers who each one was for, in the order they were made.
+	class TestHTTPClient final : public IHTTPClient
+	{
+	public:
+		enum class RequestType
+		{
+			Summaries,
+			Bans,
+			Playtime,
+			LogsTF,
+		};
+
+		struct Request
+		{
+			RequestType m_Type;
+			std::vector<SteamID> m_Players;
+		};
+
+		std::string GetString(const URL& url) const override
+		{
+			const auto urlStr = mh::format("{}", url);
+			if (urlStr.find("GetPlayerSummaries") != urlStr.npos)
+			{
+				m_SummaryRequestCount++;
+
+				nlohmann::json players = nlohmann::json::array();
+				for (const SteamID& id : RecordRequest(RequestType::Summaries, GetSteamIDs(urlStr, "steamids=")))
+				{
+					players.push_back(
+						{
+							{ "steamid", std::to_string(id.ID64) },
+							{ "personaname", "Summary" },
+							{ "personastate", 0 },
+							{ "communityvisibilitystate", 3 },
+							{ "avatarhash", "fef49e7fa7e1997310d705b2a6158ff8dc1cdfeb" },
+							{ "profileurl", "https://steamcommunity.com/" },
+						});
+				}
+
+				return nlohmann::json{ { "response", { { "players", players } } } }.dump();
+			}
+			else if (urlStr.find("GetPlayerBans") != urlStr.npos)
+			{
+				nlohmann::json players = nlohmann::json::array();
+				for (const SteamID& id : RecordRequest(RequestType::Bans, GetSteamIDs(urlStr, "steamids=")))
+				{
+					players.push_back(
+						{
+							{ "SteamId", std::to_string(id.ID64) },
+							{ "CommunityBanned", false },
+							{ "NumberOfVACBans", 0 },
+							{ "NumberOfGameBans", 0 },
+							{ "DaysSinceLastBan", 0 },
+							{ "EconomyBan", "none" },
+						});
+				}
+
+				return nlohmann::json{ { "players", players } }.dump();
+			}
+			else if (urlStr.find("GetOwnedGames") != urlStr.npos)
+			{
+				// ...%22steamid%22%3Aid%7D
+				RecordRequest(RequestType::Playtime, GetSteamIDs(urlStr, "%22steamid%22%3A"));
+				return R"({ "response": { "game_count": 1, "games": [ { "appid": 440, "playtime_forever": 60 } ] } })";
+			}
+			else if (urlStr.find("logs.tf") != urlStr.npos)
+			{
+				RecordRequest(RequestType::LogsTF, GetSteamIDs(urlStr, "player="));
+				return R"({ "total": 3 })";
+			}
+
+			throw std::runtime_error("Unexpected request");
+		}
+		mh::task<std::string> GetStringAsync(URL url) const override
+		{
+			co_return GetString(url);
+		}
+
+		uint32_t GetTotalRequestCount() const override { return m_SummaryRequestCount; }
+
+		// Everything requested since the last call
+		std::vector<Request> TakeRequests()
+		{
+			std::lock_guard lock(m_RequestsMutex);
+			return std::exchange(m_Requests, {});
+		}
+
+		mutable std::atomic_uint32_t m_SummaryRequestCount = 0;
+
+	private:
+		// The comma separated ID64s following a parameter
+		static std::vector<SteamID> GetSteamIDs(const std::string_view& url, const std::string_view& param)
+		{
+			std::vector<SteamID> ids;
+			for (size_t begin = url.find(param) + param.size(); begin < url.size(); )
+			{
+				const auto end = std::min(url.find_first_not_of("0123456789", begin), url.size());
+				ids.push_back(SteamID(std::stoull(std::string(url.substr(begin, end - begin)))));
+				if (end >= url.size() || url[end] != ',')
+					break;
+
+				begin = end + 1;
+			}
+
+			return ids;
+		}
+
+		std::vector<SteamID> RecordRequest(RequestType type, std::vector<SteamID> ids) const
+		{
+			std::lock_guard lock(m_RequestsMutex);
+			m_Requests.push_back(Request{ type, ids });
+			return ids;
+		}
+
+		mutable std::mutex m_RequestsMutex;
+		mutable std::vector<Request> m_Requests;
+	};
+}
+
+TEST_CASE("tf2bd_world_snapshot", "[WorldState]")
+{
+	Settings settings(nullptr);
+	const auto world = IWorldState::Create(settings);
+	CHECK(world->GetSnapshot()->m_Version == 0);
+
+	// Published on the next update, and only if something changed
+	AddOutput(*world, "#      2 \"Player1\" [U:1:1001] 00:52  57    0 active\n");
+	CHECK(world->GetSnapshot()->m_Version == 0);
+	world->Update();
+	const auto held = world->GetSnapshot();
+	REQUIRE(held->m_Version == 1);
+	REQUIRE(held->m_Players.size() == 1);
+	CHECK(held->m_Players[0].m_Status.m_Name == "Player1");
+
+	world->Update();
+	CHECK(world->GetSnapshot() == held);
+
+	// Several chunks in one frame are one snapshot
+	AddOutput(*world, "#      2 \"Player1 renamed\" [U:1:1001] 00:53  57    0 active\n");
+	AddOutput(*world, "#      3 \"Player2\" [U:1:1002] 00:10  68    0 active\n");
+	world->Update();
+	const auto latest = world->GetSnapshot();
+	REQUIRE(latest->m_Version == 2);
+	REQUIRE(latest->m_Players.size() == 2);
+	REQUIRE(latest->FindPlayer(SteamID("[U:1:1001]")));
+	CHECK(latest->FindPlayer(SteamID("[U:1:1001]"))->m_Status.m_Name == "Player1 renamed");
+	CHECK(latest->FindPlayer(SteamID("[U:1:1002]")));
+
+	// Published since, but what we're holding on to hasn't changed underneath us
+	CHECK(held->m_Version == 1);
+	REQUIRE(held->m_Players.size() == 1);
+	CHECK(held->m_Players[0].m_Status.m_Name == "Player1");
+}
+
+TEST_CASE("tf2bd_world_eviction", "[WorldState]")
+{
+	TestWorld test;
+	auto& world = *test.m_World;
+	const size_t maxPlayers = test.m_Settings.m_MaxCachedPlayers;
+
+	constexpr uint32_t LOBBY_MEMBER = 2;
+	constexpr uint32_t FIRST_PLAYER = 100;
+	constexpr uint32_t PLAYER_COUNT = 50;
+
+	test.SetTime(0s);
+	AddOutput(world, mh::format(
+		"CTFLobbyShared: ID:00001234  1 member(s), 0 pending\n"
+		"  Member[0] {}  team = TF_GC_TEAM_DEFENDERS  type = MATCH_PLAYER\n", MakeSteamID(LOBBY_MEMBER)));
+	test.AddStatus(TestWorld::LOCAL_PLAYER);
+	test.AddStatus(FIRST_PLAYER, PLAYER_COUNT);
+	REQUIRE(world.GetPlayerStoreStats().m_PlayerCount == PLAYER_COUNT + 2);
+
+	// Over the cap, but everyone has been on the scoreboard too recently
+	test.SetTime(30s);
+	test.AddStatus(FIRST_PLAYER + PLAYER_COUNT);
+	world.Update();
+	CHECK(world.GetPlayerStoreStats().m_EvictionCount == 0);
+
+	// Long enough ago for everyone but the last one
+	test.SetTime(120s);
+	test.AddStatus(FIRST_PLAYER + PLAYER_COUNT);
+	world.Update();
+
+	const auto stats = world.GetPlayerStoreStats();
+	CHECK(stats.m_PlayerCount == maxPlayers);
+	CHECK(stats.m_EvictionCount == PLAYER_COUNT + 3 - maxPlayers);
+	CHECK(stats.m_ColdPlayerCount == 0); // Nobody had anything fetched, so nothing was worth keeping
+	CHECK(world.FindPlayer(MakeSteamID(TestWorld::LOCAL_PLAYER)));
+	CHECK(world.FindPlayer(MakeSteamID(LOBBY_MEMBER)));
+	CHECK(world.FindPlayer(MakeSteamID(FIRST_PLAYER + PLAYER_COUNT)));
+
+	// Oldest first
+	CHECK(!world.FindPlayer(MakeSteamID(FIRST_PLAYER)));
+	CHECK(world.FindPlayer(MakeSteamID(FIRST_PLAYER + PLAYER_COUNT - 1)));
+
+	SECTION("Evicted players come back")
+	{
+		test.AddStatus(FIRST_PLAYER);
+		CHECK(world.FindPlayer(MakeSteamID(FIRST_PLAYER)));
+		CHECK(world.GetPlayerStoreStats().m_ColdRestoreCount == 0);
+	}
+
+	SECTION("Lobby resets aren't evictions")
+	{
+		AddOutput(world, "Failed to find lobby shared object\n");
+		CHECK(world.GetPlayerStoreStats().m_PlayerCount == 0);
+		CHECK(world.GetPlayerStoreStats().m_EvictionCount == stats.m_EvictionCount);
+		CHECK(world.GetPlayerStoreStats().m_ColdPlayerCount == 0);
+	}
+}
+
+TEST_CASE("tf2bd_world_eviction_cold_data", "[WorldState]")
+{
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	const auto httpClient = std::make_shared<TestHTTPClient>();
+	test.m_Settings.m_AllowInternetUsage = true;
+	test.m_Settings.SetHTTPClient(httpClient);
+	test.m_Settings.SetSteamAPIKey("TEST_API_KEY");
+
+	constexpr uint32_t FIRST_PLAYER = 100;
+	const uint32_t playerCount = uint32_t(test.m_Settings.m_MaxCachedPlayers) + 10;
+	const SteamID fetchedID = MakeSteamID(FIRST_PLAYER);
+
+	test.SetTime(0s);
+	test.AddStatus(FIRST_PLAYER, playerCount);
+
+	const auto& summary = world.FindPlayer(fetchedID)->GetPlayerSummary();
+	for (int i = 0; i < 1000 && !summary; i++)
+	{
+		world.Update();
+		GetDispatcher().run_for(1ms);
+	}
+	REQUIRE(summary);
+	REQUIRE(httpClient->m_SummaryRequestCount == 1);
+
+	SECTION("Restored on rejoin")
+	{
+		test.SetTime(120s);
+		test.AddStatus(FIRST_PLAYER + playerCount);
+		world.Update();
+		REQUIRE(!world.FindPlayer(fetchedID));
+
+		test.AddStatus(FIRST_PLAYER);
+		const IPlayer* player = world.FindPlayer(fetchedID);
+		REQUIRE(player);
+		REQUIRE(player->GetPlayerSummary());
+		CHECK(player->GetPlayerSummary()->m_Nickname == "Summary");
+		CHECK(httpClient->m_SummaryRequestCount == 1); // Nothing fetched again
+	}
+
+	SECTION("Kept across lobby resets")
+	{
+		AddOutput(world, mh::format(
+			"CTFLobbyShared: ID:00001234  1 member(s), 0 pending\n"
+			"  Member[0] {}  team = TF_GC_TEAM_DEFENDERS  type = MATCH_PLAYER\n", MakeSteamID(2)));
+		AddOutput(world, "Failed to find lobby shared object\n");
+		CHECK(world.GetPlayerStoreStats().m_ColdPlayerCount == 1); // Only the one with a summary
+		CHECK(world.GetPlayerStoreStats().m_EvictionCount == 0);
+
+		test.AddStatus(FIRST_PLAYER);
+		REQUIRE(world.FindPlayer(fetchedID)->GetPlayerSummary());
+		CHECK(httpClient->m_SummaryRequestCount == 1);
+	}
+}
+
+// Hidden by default, since it takes thousands of players (with summaries, so they're worth
+// keeping) to overflow the cold tier
+TEST_CASE("tf2bd_world_eviction_cold_trim", "[WorldState][.]")
+{
+	TestWorld test;
+	auto& world = *test.m_World;
+	const uint32_t maxPlayers = test.m_Settings.m_MaxCachedPlayers;
+
+	test.m_Settings.m_AllowInternetUsage = true;
+	test.m_Settings.SetHTTPClient(std::make_shared<TestHTTPClient>());
+	test.m_Settings.SetSteamAPIKey("TEST_API_KEY");
+
+	// Evicting everyone but maxPlayers - 1 of these overflows the cold tier (4096) by exactly
+	// the players seen a second earlier, so all of those should be trimmed and nobody else
+	constexpr uint32_t OLD_FIRST = 10'000;
+	constexpr uint32_t OLD_COUNT = 600;
+	constexpr uint32_t NEW_FIRST = 20'000;
+	const uint32_t newCount = 3584 + maxPlayers - 1;
+
+	test.SetTime(0s);
+	test.AddStatus(OLD_FIRST, OLD_COUNT);
+	test.SetTime(1s);
+	test.AddStatus(NEW_FIRST, newCount);
+	REQUIRE(test.FetchSummaries(OLD_FIRST, OLD_COUNT));
+	REQUIRE(test.FetchSummaries(NEW_FIRST, newCount));
+
+	test.SetTime(120s);
+	test.AddStatus(1'000);
+	world.Update();
+
+	const auto stats = world.GetPlayerStoreStats();
+	CHECK(stats.m_EvictionCount == OLD_COUNT + newCount + 1 - maxPlayers);
+	CHECK(stats.m_ColdPlayerCount == 3584);
+
+	// Seen longest ago, so trimmed first
+	test.AddStatus(OLD_FIRST);
+	CHECK(world.GetPlayerStoreStats().m_ColdRestoreCount == 0);
+
+	test.AddStatus(NEW_FIRST);
+	CHECK(world.GetPlayerStoreStats().m_ColdRestoreCount == 1);
+}
+
+TEST_CASE("tf2bd_world_lobby_members", "[WorldState]")
+{
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	const auto GetLobbyMemberIDs = [&]
+	{
+		std::vector<SteamID> ids;
+		for (const IPlayer& player : std::as_const(world).GetLobbyMembers())
+			ids.push_back(player.GetSteamID());
+
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	};
+
+	// 2 is still listed as pending after joining, on the other team
+	AddOutput(world,
+		"CTFLobbyShared: ID:00001234  2 member(s), 2 pending\n" +
+		MakeLobbyMemberLine(false, 0, MakeSteamID(2), LobbyMemberTeam::Defenders) +
+		MakeLobbyMemberLine(false, 1, MakeSteamID(3), LobbyMemberTeam::Invaders) +
+		MakeLobbyMemberLine(true, 0, MakeSteamID(4), LobbyMemberTeam::Invaders) +
+		MakeLobbyMemberLine(true, 1, MakeSteamID(2), LobbyMemberTeam::Invaders));
+
+	CHECK(world.FindLobbyMemberTeam(MakeSteamID(2)) == LobbyMemberTeam::Defenders); // Current slot wins
+	CHECK(world.FindLobbyMemberTeam(MakeSteamID(3)) == LobbyMemberTeam::Invaders);
+	CHECK(world.FindLobbyMemberTeam(MakeSteamID(4)) == LobbyMemberTeam::Invaders);
+	CHECK(!world.FindLobbyMemberTeam(MakeSteamID(5)));
+
+	REQUIRE(world.FindPlayer(MakeSteamID(2)));
+	REQUIRE(world.FindPlayer(MakeSteamID(2))->GetLobbyMember());
+	CHECK(!world.FindPlayer(MakeSteamID(2))->GetLobbyMember()->m_Pending);
+	REQUIRE(world.FindPlayer(MakeSteamID(4)));
+	REQUIRE(world.FindPlayer(MakeSteamID(4))->GetLobbyMember());
+	CHECK(world.FindPlayer(MakeSteamID(4))->GetLobbyMember()->m_Pending);
+
+	CHECK(GetLobbyMemberIDs() == std::vector{ MakeSteamID(2), MakeSteamID(3), MakeSteamID(4) }); // 2 only once
+
+	SECTION("Members leaving")
+	{
+		// 5 took 3's slot, and nobody is pending anymore
+		AddOutput(world,
+			"CTFLobbyShared: ID:00001234  2 member(s), 0 pending\n" +
+			MakeLobbyMemberLine(false, 0, MakeSteamID(2), LobbyMemberTeam::Defenders) +
+			MakeLobbyMemberLine(false, 1, MakeSteamID(5), LobbyMemberTeam::Invaders));
+
+		CHECK(world.FindLobbyMemberTeam(MakeSteamID(2)) == LobbyMemberTeam::Defenders);
+		CHECK(!world.FindLobbyMemberTeam(MakeSteamID(3)));
+		CHECK(!world.FindLobbyMemberTeam(MakeSteamID(4)));
+		CHECK(world.FindLobbyMemberTeam(MakeSteamID(5)) == LobbyMemberTeam::Invaders);
+		CHECK(GetLobbyMemberIDs() == std::vector{ MakeSteamID(2), MakeSteamID(5) });
+	}
+
+	SECTION("Lobby reset")
+	{
+		AddOutput(world, "Failed to find lobby shared object\n");
+
+		for (uint32_t id = 2; id <= 4; id++)
+			CHECK(!world.FindLobbyMemberTeam(MakeSteamID(id)));
+
+		CHECK(GetLobbyMemberIDs().empty());
+	}
+}
+
+TEST_CASE("tf2bd_world_listener_order", "[WorldState][ConsoleLogParser]")
+{
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	// Counts kills, and another listener (added later) looks at that count for each kill it sees
+	struct KillCounter final : AutoConsoleLineListener
+	{
+		using AutoConsoleLineListener::AutoConsoleLineListener;
+		void OnConsoleLinesParsed(IWorldState&, const ConsoleLineSpan& lines) override
+		{
+			for ([[maybe_unused]] auto& line : lines)
+				m_Kills++;
+		}
+
+		size_t m_Kills = 0;
+
+	} counter(world, { ConsoleLineType::KillNotification });
+
+	struct KillObserver final : AutoConsoleLineListener
+	{
+		KillObserver(IWorldState& world, const KillCounter& counter) :
+			AutoConsoleLineListener(world, { ConsoleLineType::KillNotification }), m_Counter(counter)
+		{
+		}
+
+		void OnConsoleLinesParsed(IWorldState&, const ConsoleLineSpan& lines) override
+		{
+			for ([[maybe_unused]] auto& line : lines)
+				m_SeenCounts.push_back(m_Counter.m_Kills);
+		}
+
+		const KillCounter& m_Counter;
+		std::vector<size_t> m_SeenCounts;
+
+	} observer(world, counter);
+
+	constexpr auto KILL = "Player1 killed Player2 with scattergun."sv;
+	std::string log;
+	log += TestWorld::MakeLogLine(1s, KILL);
+	log += TestWorld::MakeLogLine(1s, KILL);
+	log += TestWorld::MakeLogLine(2s, KILL);
+	log += TestWorld::MakeLogLine(2s, "something nobody parses");
+	log += TestWorld::MakeLogLine(2s, KILL);
+	test.AddLog(log);
+
+	// The counter has always seen the whole run (same timestamp, nothing unparsed in between)
+	// that the observer is looking at, and nothing past it
+	CHECK(counter.m_Kills == 4);
+	CHECK(observer.m_SeenCounts == std::vector<size_t>{ 2, 2, 3, 4 });
+}
+
+// Everyone requested per player (playtime or logs.tf) in one batch of requests, in order
+static std::vector<SteamID> GetPerPlayerRequests(const std::vector<TestHTTPClient::Request>& requests,
+	TestHTTPClient::RequestType type)
+{
+	std::vector<SteamID> ids;
+	for (const auto& request : requests)
+	{
+		if (request.m_Type == type)
+			ids.insert(ids.end(), request.m_Players.begin(), request.m_Players.end());
+	}
+
+	return ids;
+}
+
+TEST_CASE("tf2bd_world_prefetch_order", "[WorldState]")
+{
+	using RequestType = TestHTTPClient::RequestType;
+
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	const auto httpClient = std::make_shared<TestHTTPClient>();
+	test.m_Settings.m_AllowInternetUsage = true;
+	test.m_Settings.m_LazyLoadAPIData = false;
+	test.m_Settings.SetHTTPClient(httpClient);
+	test.m_Settings.SetSteamAPIKey("TEST_API_KEY");
+
+	const SteamID markedID = MakeSteamID(10);
+	const SteamID visibleIDs[] = { MakeSteamID(20), MakeSteamID(21) };
+	const SteamID lobbyID = MakeSteamID(30); // Hasn't made it onto the server yet
+	constexpr uint32_t FIRST_RECENT = 40;
+	constexpr uint32_t RECENT_COUNT = 10;
+	const SteamID leftID = MakeSteamID(50);
+
+	test.SetTime(0s);
+	test.AddStatus(leftID.ID);
+	test.SetTime(60s);
+	AddOutput(world, "CTFLobbyShared: ID:00001234  1 member(s), 0 pending\n" +
+		MakeLobbyMemberLine(false, 0, lobbyID, LobbyMemberTeam::Defenders));
+	test.AddStatus(FIRST_RECENT, RECENT_COUNT);
+	test.AddStatus(visibleIDs[0].ID, 2);
+	test.AddStatus(markedID.ID);
+
+	world.SetPlayerMarked(markedID, true);
+	world.SetVisiblePlayers(visibleIDs);
+
+	const auto GetPriority = [&](const SteamID& id)
+	{
+		if (id == markedID)
+			return 3;
+		if (std::find(std::begin(visibleIDs), std::end(visibleIDs), id) != std::end(visibleIDs))
+			return 2;
+		if (id == lobbyID)
+			return 1;
+
+		return 0;
+	};
+
+	const auto IsInPriorityOrder = [&](const std::vector<SteamID>& ids)
+	{
+		return std::is_sorted(ids.begin(), ids.end(),
+			[&](const SteamID& a, const SteamID& b) { return GetPriority(a) > GetPriority(b); });
+	};
+
+	const size_t playerCount = 1 + std::size(visibleIDs) + 1 + RECENT_COUNT;
+
+	// Prefetching runs once a second, and each pass starts as many per-player requests as the
+	// host allows in a second. Summaries and bans are one request each, for everyone.
+	const size_t steamAPISlots = size_t(1s / GetMinRequestInterval("api.steampowered.com"));
+	const size_t logsTFSlots = size_t(1s / GetMinRequestInterval("logs.tf"));
+	REQUIRE(steamAPISlots > 2);
+	REQUIRE(logsTFSlots < playerCount);
+
+	test.m_WallClock += 1s;
+	world.Update();
+	{
+		const auto requests = httpClient->TakeRequests();
+
+		std::vector<SteamID> summaryIDs, banIDs;
+		for (const auto& request : requests)
+		{
+			if (request.m_Type == RequestType::Summaries)
+				summaryIDs.insert(summaryIDs.end(), request.m_Players.begin(), request.m_Players.end());
+			else if (request.m_Type == RequestType::Bans)
+				banIDs.insert(banIDs.end(), request.m_Players.begin(), request.m_Players.end());
+		}
+
+		std::sort(summaryIDs.begin(), summaryIDs.end());
+		std::sort(banIDs.begin(), banIDs.end());
+		CHECK(summaryIDs.size() == playerCount);
+		CHECK(banIDs == summaryIDs);
+		CHECK(!std::binary_search(summaryIDs.begin(), summaryIDs.end(), leftID));
+
+		const auto playtimeIDs = GetPerPlayerRequests(requests, RequestType::Playtime);
+		CHECK(playtimeIDs.size() == steamAPISlots - 2);
+		CHECK(IsInPriorityOrder(playtimeIDs));
+
+		const auto logsIDs = GetPerPlayerRequests(requests, RequestType::LogsTF);
+		REQUIRE(logsIDs.size() == logsTFSlots);
+		CHECK(logsIDs.front() == markedID);
+		CHECK(IsInPriorityOrder(logsIDs));
+	}
+
+	// Not time for another pass yet
+	GetDispatcher().run_for(10ms);
+	world.Update();
+	CHECK(httpClient->TakeRequests().empty());
+
+	// Everyone else, most important first, and never more than the budget allows
+	std::vector<SteamID> allPlaytimeIDs, allLogsIDs;
+	for (size_t i = 0; i < playerCount && allLogsIDs.size() < (playerCount - logsTFSlots); i++)
+	{
+		test.m_WallClock += 1s;
+		world.Update();
+		GetDispatcher().run_for(10ms);
+
+		const auto requests = httpClient->TakeRequests();
+		const auto playtimeIDs = GetPerPlayerRequests(requests, RequestType::Playtime);
+		const auto logsIDs = GetPerPlayerRequests(requests, RequestType::LogsTF);
+		CHECK(playtimeIDs.size() <= steamAPISlots);
+		CHECK(logsIDs.size() <= logsTFSlots);
+
+		allPlaytimeIDs.insert(allPlaytimeIDs.end(), playtimeIDs.begin(), playtimeIDs.end());
+		allLogsIDs.insert(allLogsIDs.end(), logsIDs.begin(), logsIDs.end());
+	}
+
+	CHECK(allPlaytimeIDs.size() == playerCount - (steamAPISlots - 2));
+	CHECK(allLogsIDs.size() == playerCount - logsTFSlots);
+	CHECK(IsInPriorityOrder(allLogsIDs));
+	CHECK(std::find(allPlaytimeIDs.begin(), allPlaytimeIDs.end(), leftID) == allPlaytimeIDs.end());
+	CHECK(std::find(allLogsIDs.begin(), allLogsIDs.end(), leftID) == allLogsIDs.end());
+}
+
+TEST_CASE("tf2bd_world_prefetch_lazy", "[WorldState]")
+{
+	using RequestType = TestHTTPClient::RequestType;
+
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	const auto httpClient = std::make_shared<TestHTTPClient>();
+	test.m_Settings.m_AllowInternetUsage = true;
+	test.m_Settings.SetHTTPClient(httpClient);
+	test.m_Settings.SetSteamAPIKey("TEST_API_KEY");
+	REQUIRE(test.m_Settings.m_LazyLoadAPIData);
+
+	const SteamID markedID = MakeSteamID(10);
+	const SteamID visibleIDs[] = { MakeSteamID(20), MakeSteamID(21) };
+	const SteamID lobbyID = MakeSteamID(30);
+
+	test.SetTime(0s);
+	AddOutput(world, "CTFLobbyShared: ID:00001234  1 member(s), 0 pending\n" +
+		MakeLobbyMemberLine(false, 0, lobbyID, LobbyMemberTeam::Defenders));
+	test.AddStatus(40, 10);
+	test.AddStatus(visibleIDs[0].ID, 2);
+	test.AddStatus(markedID.ID);
+
+	world.SetPlayerMarked(markedID, true);
+	world.SetVisiblePlayers(visibleIDs);
+
+	// Summaries and bans for the scoreboard, everything for marked players, and nothing else
+	test.m_WallClock += 1s;
+	world.Update();
+	const auto requests = httpClient->TakeRequests();
+
+	std::vector<SteamID> summaryIDs;
+	for (const auto& request : requests)
+	{
+		if (request.m_Type == RequestType::Summaries)
+			summaryIDs.insert(summaryIDs.end(), request.m_Players.begin(), request.m_Players.end());
+	}
+
+	std::sort(summaryIDs.begin(), summaryIDs.end());
+	CHECK(summaryIDs == std::vector{ markedID, visibleIDs[0], visibleIDs[1] });
+	CHECK(GetPerPlayerRequests(requests, RequestType::Playtime) == std::vector{ markedID });
+	CHECK(GetPerPlayerRequests(requests, RequestType::LogsTF) == std::vector{ markedID });
+
+	for (int i = 0; i < 5; i++)
+	{
+		GetDispatcher().run_for(10ms);
+		test.m_WallClock += 1s;
+		world.Update();
+	}
+
+	for (const auto& request : httpClient->TakeRequests())
+		CHECK((request.m_Type == RequestType::Summaries || request.m_Type == RequestType::Bans));
+}
+
+TEST_CASE("tf2bd_world_prefetch_left_players", "[WorldState]")
+{
+	using RequestType = TestHTTPClient::RequestType;
+
+	TestWorld test;
+	auto& world = *test.m_World;
+
+	const auto httpClient = std::make_shared<TestHTTPClient>();
+	test.m_Settings.m_AllowInternetUsage = true;
+	test.m_Settings.SetHTTPClient(httpClient);
+	test.m_Settings.SetSteamAPIKey("TEST_API_KEY");
+
+	const SteamID stayingID = MakeSteamID(40);
+	const SteamID leavingID = MakeSteamID(50);
+
+	const auto GetBatchedRequests = [&]
+	{
+		std::vector<SteamID> ids;
+		for (const auto& request : httpClient->TakeRequests())
+		{
+			CHECK((request.m_Type == RequestType::Summaries || request.m_Type == RequestType::Bans));
+			ids.insert(ids.end(), request.m_Players.begin(), request.m_Players.end());
+		}
+
+		return ids;
+	};
+
+	test.SetTime(0s);
+	test.AddStatus(stayingID.ID);
+	test.AddStatus(leavingID.ID);
+
+	world.SetVisiblePlayers(std::span(&stayingID, 1));
+	test.m_WallClock += 1s;
+	world.Update();
+	CHECK(GetBatchedRequests() == std::vector{ stayingID, stayingID });
+	GetDispatcher().run_for(10ms);
+
+	// Queued, but too soon after the last batch to be sent
+	const SteamID bothIDs[] = { stayingID, leavingID };
+	world.SetVisiblePlayers(bothIDs);
+	test.m_WallClock += 1s;
+	world.Update();
+	CHECK(GetBatchedRequests().empty());
+
+	// Gone by the time the next batch can go out, and there aren't anywhere near enough
+	// players for eviction
+	test.SetTime(60s);
+	test.AddStatus(stayingID.ID);
+	test.m_WallClock += 5s;
+	world.Update();
+	CHECK(GetBatchedRequests().empty());
+	REQUIRE(world.FindPlayer(leavingID));
+	CHECK(world.GetPlayerStoreStats().m_EvictionCount == 0);
+
+	// Fetched again when they come back
+	test.AddStatus(leavingID.ID);
+	test.m_WallClock += 5s;
+	world.Update();
+	CHECK(GetBatchedRequests() == std::vector{ leavingID, leavingID });
+}
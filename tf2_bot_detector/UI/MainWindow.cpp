@@ -12,6 +12,7 @@
 #include "GenericErrors.h"
 #include "Log.h"
 #include "IPlayer.h"
+#include "PlayerTable.h"
 #include "ReleaseChannel.h"
 #include "TextureManager.h"
 #include "UpdateManager.h"
@@ -27,6 +28,7 @@
 #include <imgui.h>
 #include <libzippp/libzippp.h>
 #include <misc/cpp/imgui_stdlib.h>
+#include <SDL2/SDL_events.h>
 #include <mh/math/interpolation.hpp>
 #include <mh/text/case_insensitive_string.hpp>
 #include <mh/text/formatters/error_code.hpp>
@@ -35,6 +37,7 @@
 #include <mh/text/stringops.hpp>
 #include <srcon/async_client.h>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <filesystem>
@@ -52,6 +55,82 @@ namespace tf2_bot_detector
 		static mh::dispatcher s_Dispatcher;
 		return s_Dispatcher;
 	}
+
+	void WakeMainThread()
+	{
+		// The window sleeps in SDL's event loop while unfocused, any event gets it out again
+		static const Uint32 s_WakeEventType = SDL_RegisterEvents(1);
+		if (s_WakeEventType == Uint32(-1))
+			return;
+
+		SDL_Event event{};
+		event.type = s_WakeEventType;
+		SDL_PushEvent(&event);
+	}
+}
+
+namespace
+{
+	// Most expensive parsers first
+	std::vector<ConsoleLineParserStats> GetSortedParserStats()
+	{
+		auto stats = IConsoleLine::GetParserStats();
+		std::sort(stats.begin(), stats.end(), [](const auto& lhs, const auto& rhs)
+			{
+				return lhs.m_TotalNanoseconds > rhs.m_TotalNanoseconds;
+			});
+
+		return stats;
+	}
+
+	std::string FormatParserStats()
+	{
+		std::string retVal = mh::format("{:<32} {:>10} {:>10} {:>12} {:>10} {:>10} {:>14}\n",
+			"Type", "Attempts", "Hits", "Total (ms)", "Avg (ns)", "Max (us)", "Bytes");
+
+		for (const auto& stats : GetSortedParserStats())
+		{
+			retVal += mh::format("{:<32} {:>10} {:>10} {:>12.3f} {:>10} {:>10.1f} {:>14}\n",
+				stats.m_TypeName, stats.m_Attempts, stats.m_Hits, stats.m_TotalNanoseconds / 1'000'000.0,
+				stats.m_Attempts ? (stats.m_TotalNanoseconds / stats.m_Attempts) : 0,
+				stats.m_MaxNanoseconds / 1'000.0, stats.m_BytesExamined);
+		}
+
+		return retVal;
+	}
+
+	std::string FormatPlayerStoreStats(const PlayerStoreStats& stats)
+	{
+		return mh::format(
+			"Players:          {} ({} max), ~{} KB\n"
+			"Evicted players:  {}, ~{} KB\n"
+			"Total evictions:  {}\n"
+			"Evicted players that came back: {}\n",
+			stats.m_PlayerCount, stats.m_MaxPlayerCount, stats.m_PlayerBytes / 1024,
+			stats.m_ColdPlayerCount, stats.m_ColdPlayerBytes / 1024,
+			stats.m_EvictionCount,
+			stats.m_ColdRestoreCount);
+	}
+
+	std::string FormatConsoleOutputStats(const ConsoleOutputStats& stats)
+	{
+		using ms = std::chrono::duration<double, std::milli>;
+		return mh::format(
+			"Game command output: {} responses, {} lines\n"
+			"Parse time:    {:1.3f} ms total, {:1.3f} ms avg\n"
+			"Latency:       {:1.3f} ms avg, {:1.3f} ms max, {:1.3f} ms last\n",
+			stats.m_ChunkCount, stats.m_LineCount,
+			ms(stats.m_TotalParseTime).count(), stats.m_ChunkCount ? ms(stats.m_TotalParseTime).count() / stats.m_ChunkCount : 0,
+			stats.m_ChunkCount ? ms(stats.m_TotalLatency).count() / stats.m_ChunkCount : 0,
+			ms(stats.m_MaxLatency).count(), ms(stats.m_LastLatency).count());
+	}
+
+	std::string FormatRuleMatchCacheStats(const RuleMatchCacheStats& stats)
+	{
+		const size_t total = stats.m_Hits + stats.m_Misses;
+		return mh::format("Rule matches:  {} cached, {} evaluated ({:1.1f}% cached)\n",
+			stats.m_Hits, stats.m_Misses, total ? (100.0 * stats.m_Hits / total) : 0);
+	}
 }
 
 MainWindow::MainWindow(ImGuiDesktop::Application& app) :
@@ -67,7 +146,15 @@ MainWindow::MainWindow(ImGuiDesktop::Application& app) :
 
 	ILogManager::GetInstance().CleanupLogFiles();
 
-	GetWorld().AddConsoleLineListener(this);
+	// Everything that can show up in the chat log, plus what OnConsoleLineParsed() looks at
+	GetWorld().AddConsoleLineListener(this,
+		{
+			ConsoleLineType::Chat,
+			ConsoleLineType::EdictUsage,
+			ConsoleLineType::LobbyChanged,
+			ConsoleLineType::SVC_UserMessage,
+			ConsoleLineType::TeamsSwitched,
+		});
 	GetWorld().AddWorldEventListener(this);
 
 	PrintDebugInfo();
@@ -386,6 +473,11 @@ void MainWindow::GenerateDebugReport() try
 
 	{
 		using namespace libzippp;
+		const std::string parserStats = FormatParserStats(); // Must outlive archive.close()
+		const std::string playerStoreStats = FormatPlayerStoreStats(GetWorld().GetPlayerStoreStats());
+		const std::string consoleOutputStats = FormatConsoleOutputStats(GetWorld().GetConsoleOutputStats());
+		const std::string ruleMatchCacheStats = FormatRuleMatchCacheStats(
+			m_MainState ? GetModLogic().GetRuleMatchCacheStats() : RuleMatchCacheStats{});
 		ZipArchive archive(dbgReportLocation.string());
 		archive.open(ZipArchive::New);
 
@@ -403,6 +495,15 @@ void MainWindow::GenerateDebugReport() try
 				LogWarning("Failed to add file to debug report: {}", path);
 		}
 
+		if (!archive.addData("parser_stats.txt", parserStats.data(), parserStats.size()))
+			LogWarning("Failed to add parser stats to debug report");
+		if (!archive.addData("player_store_stats.txt", playerStoreStats.data(), playerStoreStats.size()))
+			LogWarning("Failed to add player store stats to debug report");
+		if (!archive.addData("console_output_stats.txt", consoleOutputStats.data(), consoleOutputStats.size()))
+			LogWarning("Failed to add console output stats to debug report");
+		if (!archive.addData("rule_match_cache_stats.txt", ruleMatchCacheStats.data(), ruleMatchCacheStats.size()))
+			LogWarning("Failed to add rule match cache stats to debug report");
+
 		if (auto err = archive.close(); err != LIBZIPPP_OK)
 		{
 			LogError("Failed to close debug report zip archive: close() returned {}", err);
@@ -449,6 +550,52 @@ void MainWindow::OnDrawServerStats()
 	//OnDrawNetGraph();
 }
 
+void MainWindow::OnDrawParserStats()
+{
+	if (!m_ParserStatsWindowOpen)
+		return;
+
+	ImGui::SetNextWindowSize({ 700, 400 }, ImGuiCond_FirstUseEver);
+	if (ImGui::Begin("Parser Stats", &m_ParserStatsWindowOpen))
+	{
+		if (ImGui::Button("Reset"))
+			IConsoleLine::ResetParserStats();
+
+		ImGui::TextFmt("{}", FormatConsoleOutputStats(GetWorld().GetConsoleOutputStats()));
+		if (m_MainState)
+			ImGui::TextFmt("{}", FormatRuleMatchCacheStats(GetModLogic().GetRuleMatchCacheStats()));
+
+		ImGui::Columns(7, "ParserStatsColumns");
+		for (const char* header : { "Type", "Attempts", "Hits", "Total (ms)", "Avg (ns)", "Max (us)", "Bytes" })
+		{
+			ImGui::TextUnformatted(header);
+			ImGui::NextColumn();
+		}
+		ImGui::Separator();
+
+		for (const auto& stats : GetSortedParserStats())
+		{
+			ImGui::TextFmt("{}", stats.m_TypeName);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{}", stats.m_Attempts);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{}", stats.m_Hits);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{:1.3f}", stats.m_TotalNanoseconds / 1'000'000.0);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{}", stats.m_Attempts ? (stats.m_TotalNanoseconds / stats.m_Attempts) : 0);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{:1.1f}", stats.m_MaxNanoseconds / 1'000.0);
+			ImGui::NextColumn();
+			ImGui::TextFmt("{}", stats.m_BytesExamined);
+			ImGui::NextColumn();
+		}
+
+		ImGui::Columns(1);
+	}
+	ImGui::End();
+}
+
 void MainWindow::OnDraw()
 {
 	ImGui::GetIO().FontDefault = GetFontPointer(m_Settings.m_Theme.m_Font);
@@ -458,6 +605,7 @@ void MainWindow::OnDraw()
 
 	OnDrawUpdateCheckPopup();
 	OnDrawAboutPopup();
+	OnDrawParserStats();
 
 	{
 		ISetupFlowPage::DrawState ds;
@@ -536,7 +684,7 @@ void MainWindow::OnDraw()
 	if (m_MainState)
 	{
 		auto& world = GetWorld();
-		const auto parsedLineCount = m_ParsedLineCount;
+		const auto parsedLineCount = m_MainState->m_Parser.GetDeliveredLineCount();
 		const auto parseProgress = m_MainState->m_Parser.GetParseProgress();
 
 		if (parseProgress < 0.95f)
@@ -620,12 +768,14 @@ void MainWindow::OnDrawMenuBar()
 		}
 		ImGui::EndMenu();
 	}
+#endif
 
 #ifdef _DEBUG
 	static bool s_ImGuiDemoWindow = false;
 #endif
 	if (ImGui::BeginMenu("Window"))
 	{
+		ImGui::MenuItem("Parser Stats", nullptr, &m_ParserStatsWindowOpen);
 #ifdef _DEBUG
 		ImGui::MenuItem("ImGui Demo Window", nullptr, &s_ImGuiDemoWindow);
 #endif
@@ -635,7 +785,6 @@ void MainWindow::OnDrawMenuBar()
 #ifdef _DEBUG
 	if (s_ImGuiDemoWindow)
 		ImGui::ShowDemoWindow(&s_ImGuiDemoWindow);
-#endif
 #endif
 
 	if (!isInSetupFlow || m_SetupFlow.GetCurrentPage() == SetupFlowPage::TF2CommandLine)
@@ -740,10 +889,14 @@ float MainWindow::TimeSine(float interval, float min, float max) const
 	return mh::remap(std::sin(progress * 6.28318530717958647693f), -1.0f, 1.0f, min, max);
 }
 
-void MainWindow::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
+void MainWindow::OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines)
 {
-	m_ParsedLineCount++;
+	for (IConsoleLine& line : lines)
+		OnConsoleLineParsed(line);
+}
 
+void MainWindow::OnConsoleLineParsed(IConsoleLine& parsed)
+{
 	if (parsed.ShouldPrint() && m_MainState)
 	{
 		while (m_MainState->m_PrintingLines.size() > m_MainState->MAX_PRINTING_LINES)
@@ -781,80 +934,72 @@ void MainWindow::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 
 void MainWindow::OnConsoleLineUnparsed(IWorldState& world, const std::string_view& text)
 {
-	m_ParsedLineCount++;
 }
 
 mh::generator<IPlayer&> MainWindow::PostSetupFlowState::GeneratePlayerPrintData()
 {
-	IPlayer* printData[33]{};
-	auto begin = std::begin(printData);
-	auto end = std::end(printData);
-	assert(begin <= end);
 	auto& world = m_Parent->m_WorldState;
-	assert(static_cast<size_t>(end - begin) >= world->GetApproxLobbyMemberCount());
+	const PlayerTable& table = world->GetPlayerTable();
+	assert(world->GetApproxLobbyMemberCount() <= 33);
 
-	std::fill(begin, end, nullptr);
+	PlayerTable::row_t rows[33]{};
+	size_t rowCount = 0;
 
+	for (size_t i = 0; i < table.size() && rowCount < std::size(rows); i++)
 	{
-		auto* current = begin;
-		for (IPlayer& member : world->GetLobbyMembers())
-		{
-			*current = &member;
-			current++;
-		}
+		if (table.m_LobbyTeams[i])
+			rows[rowCount++] = PlayerTable::row_t(i);
+	}
 
-		if (current == begin)
+	if (rowCount == 0)
+	{
+		// We seem to have either an empty lobby or we're playing on a community server.
+		// Just find the most recent status updates.
+		const auto recentStatusTime = world->GetLastStatusUpdateTime() - 15s;
+		for (auto row = table.m_NewestRow; row != PlayerTable::NO_ROW; row = table.m_OlderRows[row])
 		{
-			// We seem to have either an empty lobby or we're playing on a community server.
-			// Just find the most recent status updates.
-			for (IPlayer& playerData : world->GetPlayers())
-			{
-				if (playerData.GetLastStatusUpdateTime() >= (world->GetLastStatusUpdateTime() - 15s))
-				{
-					*current = &playerData;
-					current++;
+			if (table.m_LastStatusUpdateTimes[row] < recentStatusTime)
+				break;
 
-					if (current >= end)
-						break; // This might happen, but we're not in a lobby so everything has to be approximate
-				}
-			}
-		}
+			rows[rowCount++] = row;
 
-		end = current;
+			if (rowCount >= std::size(rows))
+				break; // This might happen, but we're not in a lobby so everything has to be approximate
+		}
 	}
 
-	std::sort(begin, end, [](const IPlayer* lhs, const IPlayer* rhs) -> bool
+	std::sort(std::begin(rows), std::begin(rows) + rowCount, [&](PlayerTable::row_t lhs, PlayerTable::row_t rhs) -> bool
 		{
-			assert(lhs);
-			assert(rhs);
-			//if (!lhs && !rhs)
-			//	return false;
-			//if (auto result = !!rhs <=> !!lhs; !std::is_eq(result))
-			//	return result < 0;
-
 			// Intentionally reversed, we want descending kill order
-			if (auto killsResult = rhs->GetScores().m_Kills <=> lhs->GetScores().m_Kills; !std::is_eq(killsResult))
+			if (auto killsResult = table.m_Kills[rhs] <=> table.m_Kills[lhs]; !std::is_eq(killsResult))
 				return std::is_lt(killsResult);
 
-			if (auto deathsResult = lhs->GetScores().m_Deaths <=> rhs->GetScores().m_Deaths; !std::is_eq(deathsResult))
+			if (auto deathsResult = table.m_Deaths[lhs] <=> table.m_Deaths[rhs]; !std::is_eq(deathsResult))
 				return std::is_lt(deathsResult);
 
 			// Sort by ascending userid
+			if (const auto luid = table.m_UserIDs[lhs], ruid = table.m_UserIDs[rhs]; luid > 0 && ruid > 0)
 			{
-				auto luid = lhs->GetUserID();
-				auto ruid = rhs->GetUserID();
-				if (luid && ruid)
-				{
-					if (auto result = *luid <=> *ruid; !std::is_eq(result))
-						return std::is_lt(result);
-				}
+				if (auto result = luid <=> ruid; !std::is_eq(result))
+					return std::is_lt(result);
 			}
 
 			return false;
 		});
 
-	for (auto it = begin; it != end; ++it)
-		co_yield **it;
+	// Rows can move around once we start yielding, players can't
+	IPlayer* printData[33]{};
+	SteamID visibleIDs[33]{};
+	for (size_t i = 0; i < rowCount; i++)
+	{
+		printData[i] = table.m_Players[rows[i]];
+		visibleIDs[i] = table.m_SteamIDs[rows[i]];
+	}
+
+	world->SetVisiblePlayers(std::span<const SteamID>(visibleIDs, rowCount));
+
+	for (size_t i = 0; i < rowCount; i++)
+		co_yield *printData[i];
 }
 
 void MainWindow::UpdateServerPing(time_point_t timestamp)
@@ -865,11 +1010,14 @@ void MainWindow::UpdateServerPing(time_point_t timestamp)
 	float totalPing = 0;
 	uint16_t samples = 0;
 
-	for (IPlayer& player : GetWorld().GetPlayers())
+	const PlayerTable& table = GetWorld().GetPlayerTable();
+	const auto minStatusTime = timestamp - 20s;
+	for (auto row = table.m_NewestRow; row != PlayerTable::NO_ROW; row = table.m_OlderRows[row])
 	{
-		if (player.GetLastStatusUpdateTime() < (timestamp - 20s))
-			continue;
+		if (table.m_LastStatusUpdateTimes[row] < minStatusTime)
+			break;
 
+		IPlayer& player = *table.m_Players[row];
 		auto& data = player.GetOrCreateData<PlayerExtraData>(player);
 		totalPing += data.GetAveragePing();
 		samples++;
@@ -81,6 +81,9 @@ namespace tf2_bot_detector
 		bool m_AboutPopupOpen = false;
 		void OpenAboutPopup() { m_AboutPopupOpen = true; }
 
+		void OnDrawParserStats();
+		bool m_ParserStatsWindowOpen = false;
+
 		void PrintDebugInfo();
 		void GenerateDebugReport();
 
@@ -97,10 +100,10 @@ namespace tf2_bot_detector
 		ImFont* m_ProggyClean26Font{};
 
 		// IConsoleLineListener
-		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) override;
+		void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override;
+		void OnConsoleLineParsed(IConsoleLine& line);
 		void OnConsoleLineUnparsed(IWorldState& world, const std::string_view& text) override;
 		void OnConsoleLogChunkParsed(IWorldState& world, bool consoleLinesParsed) override;
-		size_t m_ParsedLineCount = 0;
 
 		// IWorldEventListener
 		//void OnChatMsg(WorldState& world, const IPlayer& player, const std::string_view& msg) override;
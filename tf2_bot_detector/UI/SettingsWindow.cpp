@@ -101,7 +101,7 @@ void SettingsWindow::OnDraw()
 #ifdef _DEBUG
 		if (ImGui::Checkbox("Lazy Load API Data", &m_Settings.m_LazyLoadAPIData))
 			m_Settings.SaveFile();
-		ImGui::SetHoverTooltip("If enabled, waits until data is actually needed by the UI before requesting it, saving system resources. Otherwise, instantly loads all data from integration APIs as soon as a player joins the server.");
+		ImGui::SetHoverTooltip("If enabled, only requests Steam summaries and bans for players on the scoreboard, and waits until everything else is actually needed by the UI (unless the player is marked), saving system resources. Otherwise, loads all data from integration APIs for everyone on the server, marked players and players on the scoreboard first.");
 #endif
 
 		if (bool allowInternet = m_Settings.m_AllowInternetUsage.value_or(false);
@@ -0,0 +1,88 @@
+#include "AhoCorasick.h"
+
+#include <deque>
+#include <utility>
+
+using namespace tf2_bot_detector;
+
+AhoCorasick::AhoCorasick(const std::vector<std::string_view>& patterns)
+{
+	// Build the trie with whatever's easiest to insert into, then flatten it
+	std::vector<std::vector<Edge>> edges(1);
+	std::vector<std::pair<node_index_t, pattern_index_t>> outputs;
+
+	m_PatternLengths.reserve(patterns.size());
+	for (pattern_index_t p = 0; p < patterns.size(); p++)
+	{
+		const std::string_view pattern = patterns[p];
+		m_PatternLengths.push_back(uint32_t(pattern.size()));
+		if (pattern.empty())
+			continue;
+
+		node_index_t node = ROOT;
+		for (const char c : pattern)
+		{
+			auto& nodeEdges = edges[node];
+			auto found = std::find_if(nodeEdges.begin(), nodeEdges.end(), [&](const Edge& e) { return e.m_Char == c; });
+			if (found != nodeEdges.end())
+			{
+				node = found->m_Target;
+			}
+			else
+			{
+				const auto next = node_index_t(edges.size());
+				nodeEdges.push_back({ c, next });
+				edges.emplace_back(); // Invalidates nodeEdges
+				node = next;
+			}
+		}
+
+		outputs.emplace_back(node, p);
+	}
+
+	m_Nodes.resize(edges.size());
+	for (node_index_t n = 0; n < edges.size(); n++)
+	{
+		auto& nodeEdges = edges[n];
+		std::sort(nodeEdges.begin(), nodeEdges.end(), [](const Edge& a, const Edge& b) { return a.m_Char < b.m_Char; });
+
+		m_Nodes[n].m_FirstEdge = uint32_t(m_Edges.size());
+		m_Nodes[n].m_EdgeCount = uint32_t(nodeEdges.size());
+		m_Edges.insert(m_Edges.end(), nodeEdges.begin(), nodeEdges.end());
+	}
+
+	std::sort(outputs.begin(), outputs.end());
+	m_Outputs.reserve(outputs.size());
+	for (const auto& [node, pattern] : outputs)
+	{
+		if (m_Nodes[node].m_OutputCount++ == 0)
+			m_Nodes[node].m_FirstOutput = uint32_t(m_Outputs.size());
+
+		m_Outputs.push_back(pattern);
+	}
+
+	// Failure links, breadth first so every node's suffixes are done before it is
+	for (const Edge& e : edges[ROOT])
+		m_RootTransitions[static_cast<unsigned char>(e.m_Char)] = e.m_Target;
+
+	std::deque<node_index_t> queue;
+	for (const Edge& e : edges[ROOT])
+		queue.push_back(e.m_Target); // Fail to the root, which is the default
+
+	while (!queue.empty())
+	{
+		const node_index_t node = queue.front();
+		queue.pop_front();
+
+		for (const Edge& e : edges[node])
+		{
+			Node& child = m_Nodes[e.m_Target];
+			child.m_Fail = Step(m_Nodes[node].m_Fail, e.m_Char);
+
+			const Node& fail = m_Nodes[child.m_Fail];
+			child.m_OutputLink = fail.m_OutputCount ? child.m_Fail : fail.m_OutputLink;
+
+			queue.push_back(e.m_Target);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace tf2_bot_detector
+{
+	// Finds every occurrence of every one of a fixed set of patterns in a single pass over
+	// the text, no matter how many patterns there are. Matching is byte for byte, so fold
+	// the patterns and the text the same way beforehand if you want case insensitivity.
+	class AhoCorasick final
+	{
+	public:
+		using pattern_index_t = uint32_t;
+
+		AhoCorasick() = default;
+		explicit AhoCorasick(const std::vector<std::string_view>& patterns);
+
+		size_t GetPatternCount() const { return m_PatternLengths.size(); }
+		size_t GetPatternLength(pattern_index_t pattern) const { return m_PatternLengths[pattern]; }
+
+		// Calls func(pattern_index_t pattern, size_t end) for every occurrence of every pattern,
+		// where end is one past the last character of the occurrence. Empty patterns are never
+		// reported.
+		template<typename TFunc>
+		void FindAll(const std::string_view& text, TFunc&& func) const
+		{
+			if (m_Nodes.empty())
+				return;
+
+			node_index_t state = ROOT;
+			for (size_t i = 0; i < text.size(); i++)
+			{
+				state = Step(state, text[i]);
+
+				for (node_index_t out = m_Nodes[state].m_OutputCount ? state : m_Nodes[state].m_OutputLink;
+					out != NO_NODE; out = m_Nodes[out].m_OutputLink)
+				{
+					const Node& node = m_Nodes[out];
+					for (uint32_t o = 0; o < node.m_OutputCount; o++)
+						func(m_Outputs[node.m_FirstOutput + o], i + 1);
+				}
+			}
+		}
+
+	private:
+		using node_index_t = uint32_t;
+		static constexpr node_index_t ROOT = 0;
+		static constexpr node_index_t NO_NODE = node_index_t(-1);
+
+		struct Edge
+		{
+			char m_Char;
+			node_index_t m_Target;
+		};
+
+		struct Node
+		{
+			uint32_t m_FirstEdge = 0;
+			uint32_t m_EdgeCount = 0;       // m_Edges[m_FirstEdge...], sorted by m_Char
+			node_index_t m_Fail = ROOT;     // Longest proper suffix of this node that's also in the trie
+			node_index_t m_OutputLink = NO_NODE; // Nearest node along the m_Fail chain that ends a pattern
+			uint32_t m_FirstOutput = 0;
+			uint32_t m_OutputCount = 0;     // m_Outputs[m_FirstOutput...]
+		};
+
+		node_index_t FindEdge(node_index_t node, char c) const
+		{
+			const Node& n = m_Nodes[node];
+			const auto begin = m_Edges.begin() + n.m_FirstEdge;
+			const auto end = begin + n.m_EdgeCount;
+			const auto found = std::lower_bound(begin, end, c, [](const Edge& e, char ch) { return e.m_Char < ch; });
+			return (found != end && found->m_Char == c) ? found->m_Target : NO_NODE;
+		}
+
+		node_index_t Step(node_index_t state, char c) const
+		{
+			while (state != ROOT)
+			{
+				if (const node_index_t next = FindEdge(state, c); next != NO_NODE)
+					return next;
+
+				state = m_Nodes[state].m_Fail;
+			}
+
+			// Almost every step starts over from the root, so it gets a full table
+			return m_RootTransitions[static_cast<unsigned char>(c)];
+		}
+
+		std::vector<Node> m_Nodes;
+		std::vector<Edge> m_Edges;
+		std::vector<pattern_index_t> m_Outputs;
+		std::vector<uint32_t> m_PatternLengths;
+		std::array<node_index_t, 256> m_RootTransitions{};
+	};
+}
@@ -3,9 +3,13 @@
 #include <mh/text/charconv_helper.hpp>
 #include <mh/text/format.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <iomanip>
 #include <regex>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 
 namespace tf2_bot_detector
@@ -34,4 +38,670 @@ namespace tf2_bot_detector
 			throw std::runtime_error(mh::format("Failed to parse {} as {}", std::quoted(sv), typeid(T).name()));
 		}
 	}
+
+	// A capture group of a ct_regex match. Mirrors the parts of std::sub_match we actually use,
+	// but is just a pair of pointers into the text that was matched.
+	struct ct_sub_match
+	{
+		const char* first = nullptr;
+		const char* second = nullptr;
+		bool matched = false;
+
+		size_t length() const { return matched ? size_t(second - first) : 0; }
+		std::string_view view() const { return matched ? std::string_view(first, length()) : std::string_view{}; }
+		std::string str() const { return std::string(view()); }
+		operator std::string_view() const { return view(); }
+	};
+
+	template<size_t N>
+	struct ct_match_results
+	{
+		const ct_sub_match& operator[](size_t index) const { return m_Matches[index]; }
+		static constexpr size_t size() { return N; }
+		explicit operator bool() const { return m_Matches[0].matched; }
+
+		std::array<ct_sub_match, N> m_Matches{};
+	};
+
+	inline std::string_view to_string_view(const ct_sub_match& match)
+	{
+		return match.view();
+	}
+
+	template<typename T>
+	inline auto from_chars(const ct_sub_match& match, T& out)
+	{
+		return mh::from_chars(match.view(), out);
+	}
+
+	template<typename T, typename... TArgs>
+	inline void from_chars_throw(const ct_sub_match& match, T& out, TArgs&&... args)
+	{
+		const auto sv = match.view();
+		auto result = mh::from_chars(sv, out, std::forward<TArgs>(args)...);
+		if (!result)
+		{
+			throw std::runtime_error(mh::format("Failed to parse {} as {}", std::quoted(sv), typeid(T).name()));
+		}
+	}
+
+	namespace detail::ct_regex
+	{
+		template<size_t N>
+		struct fixed_string
+		{
+			constexpr fixed_string(const char(&str)[N]) { std::copy_n(str, N, m_Data); }
+
+			static constexpr size_t size() { return N - 1; }
+			constexpr std::string_view view() const { return std::string_view(m_Data, N - 1); }
+
+			char m_Data[N]{};
+		};
+
+		inline constexpr size_t npos = size_t(-1);
+		inline constexpr size_t unbounded = size_t(-1);
+
+		struct char_set
+		{
+			constexpr void set(unsigned char c) { m_Bits[c >> 6] |= uint64_t(1) << (c & 63); }
+			constexpr void set_range(unsigned char first, unsigned char last)
+			{
+				for (unsigned c = first; c <= last; c++)
+					set(static_cast<unsigned char>(c));
+			}
+			constexpr void merge(const char_set& other)
+			{
+				for (size_t i = 0; i < std::size(m_Bits); i++)
+					m_Bits[i] |= other.m_Bits[i];
+			}
+			constexpr void invert()
+			{
+				for (auto& bits : m_Bits)
+					bits = ~bits;
+			}
+			constexpr bool test(char c) const
+			{
+				const auto uc = static_cast<unsigned char>(c);
+				return (m_Bits[uc >> 6] >> (uc & 63)) & 1;
+			}
+
+			uint64_t m_Bits[4]{};
+		};
+
+		enum class node_type : uint8_t
+		{
+			sequence,    // children, one after the other
+			alternation, // children, first one that leads to a match wins
+			literal,     // m_Length characters of m_Literals starting at m_Offset
+			char_set,    // one character out of m_Sets[m_Offset]
+			repeat,      // first child, [m_Min, m_Max] times
+			capture,     // first child, recorded as capture group m_CaptureIndex
+		};
+
+		struct node
+		{
+			node_type m_Type = node_type::sequence;
+			size_t m_FirstChild = npos;
+			size_t m_NextSibling = npos;
+
+			size_t m_Offset = 0;
+			size_t m_Length = 0;
+
+			size_t m_Min = 0;
+			size_t m_Max = 0;
+			bool m_Lazy = false;
+
+			size_t m_CaptureIndex = 0;
+		};
+
+		// Every pattern character produces at most one node, plus one sequence node
+		// for each group/alternative.
+		template<size_t PatternLength>
+		struct program
+		{
+			node m_Nodes[PatternLength * 2 + 2]{};
+			size_t m_NodeCount = 0;
+			char_set m_Sets[PatternLength + 1]{};
+			size_t m_SetCount = 0;
+			char m_Literals[PatternLength + 1]{};
+			size_t m_LiteralCount = 0;
+
+			size_t m_CaptureCount = 0;
+			size_t m_Root = npos;
+		};
+
+		// Recursive descent parser for the subset of ECMAScript regex syntax we use. Only ever
+		// runs at compile time, so "throwing" just turns a bad pattern into a compile error.
+		template<size_t PatternLength>
+		class parser
+		{
+		public:
+			constexpr parser(std::string_view pattern) : m_Pattern(pattern) {}
+
+			constexpr program<PatternLength> parse()
+			{
+				m_Program.m_Root = parse_alternation();
+				if (m_Pos != m_Pattern.size())
+					throw std::invalid_argument("Unbalanced ')' in pattern");
+
+				return m_Program;
+			}
+
+		private:
+			std::string_view m_Pattern;
+			size_t m_Pos = 0;
+			program<PatternLength> m_Program{};
+
+			constexpr bool at_end() const { return m_Pos >= m_Pattern.size(); }
+			constexpr bool peek(char c) const { return !at_end() && m_Pattern[m_Pos] == c; }
+			constexpr bool consume(char c)
+			{
+				if (!peek(c))
+					return false;
+
+				m_Pos++;
+				return true;
+			}
+			constexpr char next()
+			{
+				if (at_end())
+					throw std::invalid_argument("Unexpected end of pattern");
+
+				return m_Pattern[m_Pos++];
+			}
+
+			constexpr size_t add_node(node_type type)
+			{
+				auto& n = m_Program.m_Nodes[m_Program.m_NodeCount];
+				n.m_Type = type;
+				return m_Program.m_NodeCount++;
+			}
+			constexpr size_t add_literal(char c)
+			{
+				const size_t index = add_node(node_type::literal);
+				m_Program.m_Nodes[index].m_Offset = m_Program.m_LiteralCount;
+				m_Program.m_Nodes[index].m_Length = 1;
+				m_Program.m_Literals[m_Program.m_LiteralCount++] = c;
+				return index;
+			}
+			constexpr size_t add_set(const char_set& set)
+			{
+				const size_t index = add_node(node_type::char_set);
+				m_Program.m_Nodes[index].m_Offset = m_Program.m_SetCount;
+				m_Program.m_Sets[m_Program.m_SetCount++] = set;
+				return index;
+			}
+
+			constexpr size_t parse_alternation()
+			{
+				const size_t first = parse_sequence();
+				if (!peek('|'))
+					return first;
+
+				const size_t alternation = add_node(node_type::alternation);
+				m_Program.m_Nodes[alternation].m_FirstChild = first;
+
+				size_t last = first;
+				while (consume('|'))
+				{
+					const size_t alternative = parse_sequence();
+					m_Program.m_Nodes[last].m_NextSibling = alternative;
+					last = alternative;
+				}
+
+				return alternation;
+			}
+
+			constexpr size_t parse_sequence()
+			{
+				const size_t sequence = add_node(node_type::sequence);
+
+				size_t last = npos;
+				while (!at_end() && !peek('|') && !peek(')'))
+				{
+					const size_t atom = parse_quantifier(parse_atom());
+
+					// Merge runs of plain characters into a single literal
+					if (last != npos)
+					{
+						auto& lastNode = m_Program.m_Nodes[last];
+						const auto& atomNode = m_Program.m_Nodes[atom];
+						if (lastNode.m_Type == node_type::literal && atomNode.m_Type == node_type::literal &&
+							(lastNode.m_Offset + lastNode.m_Length) == atomNode.m_Offset)
+						{
+							lastNode.m_Length += atomNode.m_Length;
+							m_Program.m_NodeCount--; // atom is always the most recently added node
+							continue;
+						}
+					}
+
+					if (last == npos)
+						m_Program.m_Nodes[sequence].m_FirstChild = atom;
+					else
+						m_Program.m_Nodes[last].m_NextSibling = atom;
+
+					last = atom;
+				}
+
+				return sequence;
+			}
+
+			constexpr size_t parse_atom()
+			{
+				const char c = next();
+				switch (c)
+				{
+				case '(':
+				{
+					if (consume('?'))
+					{
+						if (!consume(':'))
+							throw std::invalid_argument("Only (?:) groups are supported");
+
+						const size_t inner = parse_alternation();
+						if (!consume(')'))
+							throw std::invalid_argument("Missing ')'");
+
+						return inner;
+					}
+
+					const size_t capture = add_node(node_type::capture);
+					m_Program.m_Nodes[capture].m_CaptureIndex = ++m_Program.m_CaptureCount;
+					const size_t inner = parse_alternation();
+					m_Program.m_Nodes[capture].m_FirstChild = inner;
+					if (!consume(')'))
+						throw std::invalid_argument("Missing ')'");
+
+					return capture;
+				}
+
+				case '[':
+					return parse_class();
+
+				case '.':
+				{
+					char_set set;
+					set.set('\n');
+					set.set('\r');
+					set.invert();
+					return add_set(set);
+				}
+
+				case '\\':
+				{
+					char_set set;
+					char literal{};
+					if (parse_escape(set, literal))
+						return add_set(set);
+					else
+						return add_literal(literal);
+				}
+
+				case '*':
+				case '+':
+				case '?':
+				case '{':
+					throw std::invalid_argument("Nothing to repeat");
+
+				case '^':
+				case '$':
+					throw std::invalid_argument("Assertions are not supported");
+
+				default:
+					return add_literal(c);
+				}
+			}
+
+			// Returns true if the escape was a character class, false if it was a single character
+			constexpr bool parse_escape(char_set& set, char& literal)
+			{
+				const char c = next();
+				switch (c)
+				{
+				case 'd':
+				case 'D':
+					set.set_range('0', '9');
+					break;
+				case 's':
+				case 'S':
+					for (char ws : { ' ', '\t', '\n', '\v', '\f', '\r' })
+						set.set(ws);
+					break;
+				case 'w':
+				case 'W':
+					set.set_range('a', 'z');
+					set.set_range('A', 'Z');
+					set.set_range('0', '9');
+					set.set('_');
+					break;
+
+				case 'n': literal = '\n'; return false;
+				case 'r': literal = '\r'; return false;
+				case 't': literal = '\t'; return false;
+				case 'f': literal = '\f'; return false;
+				case 'v': literal = '\v'; return false;
+
+				default:
+					if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+						throw std::invalid_argument("Unsupported escape sequence");
+
+					literal = c;
+					return false;
+				}
+
+				if (c == 'D' || c == 'S' || c == 'W')
+					set.invert();
+
+				return true;
+			}
+
+			constexpr size_t parse_class()
+			{
+				char_set set;
+				const bool negate = consume('^');
+
+				while (true)
+				{
+					char c = next();
+					if (c == ']')
+						break;
+
+					if (c == '\\')
+					{
+						if (char_set escaped; parse_escape(escaped, c))
+						{
+							set.merge(escaped);
+							continue;
+						}
+					}
+
+					if (peek('-') && (m_Pos + 1) < m_Pattern.size() && m_Pattern[m_Pos + 1] != ']')
+					{
+						m_Pos++;
+
+						char last = next();
+						if (last == '\\')
+						{
+							if (char_set escaped; parse_escape(escaped, last))
+								throw std::invalid_argument("Character class can't be the end of a range");
+						}
+
+						if (static_cast<unsigned char>(last) < static_cast<unsigned char>(c))
+							throw std::invalid_argument("Invalid range in character class");
+
+						set.set_range(static_cast<unsigned char>(c), static_cast<unsigned char>(last));
+					}
+					else
+					{
+						set.set(static_cast<unsigned char>(c));
+					}
+				}
+
+				if (negate)
+					set.invert();
+
+				return add_set(set);
+			}
+
+			constexpr size_t parse_number()
+			{
+				if (at_end() || m_Pattern[m_Pos] < '0' || m_Pattern[m_Pos] > '9')
+					throw std::invalid_argument("Expected a number");
+
+				size_t value = 0;
+				while (!at_end() && m_Pattern[m_Pos] >= '0' && m_Pattern[m_Pos] <= '9')
+					value = (value * 10) + (m_Pattern[m_Pos++] - '0');
+
+				return value;
+			}
+
+			constexpr size_t parse_quantifier(size_t atom)
+			{
+				size_t min, max;
+				if (consume('*'))
+				{
+					min = 0;
+					max = unbounded;
+				}
+				else if (consume('+'))
+				{
+					min = 1;
+					max = unbounded;
+				}
+				else if (consume('?'))
+				{
+					min = 0;
+					max = 1;
+				}
+				else if (consume('{'))
+				{
+					min = max = parse_number();
+					if (consume(','))
+						max = peek('}') ? unbounded : parse_number();
+
+					if (!consume('}'))
+						throw std::invalid_argument("Missing '}'");
+					if (max < min)
+						throw std::invalid_argument("Invalid repeat count");
+				}
+				else
+				{
+					return atom;
+				}
+
+				const size_t repeat = add_node(node_type::repeat);
+				auto& n = m_Program.m_Nodes[repeat];
+				n.m_FirstChild = atom;
+				n.m_Min = min;
+				n.m_Max = max;
+				n.m_Lazy = consume('?');
+				return repeat;
+			}
+		};
+	}
+
+	// Regular expressions that are parsed at compile time and turned into dedicated matching
+	// code, rather than interpreted at runtime like std::regex. Matching never allocates and
+	// captures point straight into the matched text.
+	//
+	// Supports the parts of ECMAScript syntax the console line parsers use: literals and
+	// escapes, '.', \d \s \w (and their negations), [] classes with ranges, capturing and (?:)
+	// groups, alternation, and greedy/lazy * + ? {n} {n,} {n,m}. Anything else is a compile
+	// error. Backtracking follows the same rules as std::regex, so captures come out the same.
+	template<detail::ct_regex::fixed_string Pattern>
+	class ct_regex final
+	{
+		using node = detail::ct_regex::node;
+		using node_type = detail::ct_regex::node_type;
+		static constexpr size_t npos = detail::ct_regex::npos;
+
+		static constexpr auto s_Program = detail::ct_regex::parser<Pattern.size()>(Pattern.view()).parse();
+
+	public:
+		using match_results = ct_match_results<s_Program.m_CaptureCount + 1>;
+
+		static constexpr size_t mark_count() { return s_Program.m_CaptureCount; }
+
+		// Equivalent to std::regex_match: the entire text must match the pattern.
+		static match_results match(const std::string_view& text)
+		{
+			match_results results;
+			const char* begin = text.data();
+			state st{ begin + text.size(), results };
+
+			if (match_node<s_Program.m_Root>(begin, st, [&](const char* end) { return end == st.m_End; }))
+				results.m_Matches[0] = { begin, st.m_End, true };
+
+			return results;
+		}
+
+	private:
+		struct state
+		{
+			const char* m_End;
+			match_results& m_Results;
+		};
+
+		// Every match_* function either calls cont with the position right after what it
+		// matched, or returns false. Returning cont's result is what lets an earlier part of
+		// the pattern try a different (shorter, longer, other alternative) match when a later
+		// one fails.
+
+		template<size_t Index>
+		static bool match_char(char c)
+		{
+			constexpr node n = s_Program.m_Nodes[Index];
+			if constexpr (n.m_Type == node_type::literal)
+				return c == s_Program.m_Literals[n.m_Offset];
+			else
+				return s_Program.m_Sets[n.m_Offset].test(c);
+		}
+
+		template<size_t Index, typename TCont>
+		static bool match_node(const char* it, state& st, const TCont& cont)
+		{
+			constexpr node n = s_Program.m_Nodes[Index];
+
+			if constexpr (n.m_Type == node_type::literal)
+			{
+				constexpr std::string_view literal(s_Program.m_Literals + n.m_Offset, n.m_Length);
+				if (size_t(st.m_End - it) < literal.size() || std::string_view(it, literal.size()) != literal)
+					return false;
+
+				return cont(it + literal.size());
+			}
+			else if constexpr (n.m_Type == node_type::char_set)
+			{
+				if (it == st.m_End || !match_char<Index>(*it))
+					return false;
+
+				return cont(it + 1);
+			}
+			else if constexpr (n.m_Type == node_type::sequence)
+			{
+				return match_sequence<n.m_FirstChild>(it, st, cont);
+			}
+			else if constexpr (n.m_Type == node_type::alternation)
+			{
+				return match_alternation<n.m_FirstChild>(it, st, cont);
+			}
+			else if constexpr (n.m_Type == node_type::capture)
+			{
+				auto& sub = st.m_Results.m_Matches[n.m_CaptureIndex];
+				const ct_sub_match saved = sub;
+
+				const bool matched = match_node<n.m_FirstChild>(it, st, [&](const char* end)
+					{
+						const ct_sub_match inner = sub;
+						sub = { it, end, true };
+						if (cont(end))
+							return true;
+
+						sub = inner;
+						return false;
+					});
+
+				if (!matched)
+					sub = saved;
+
+				return matched;
+			}
+			else if constexpr (n.m_Type == node_type::repeat)
+			{
+				constexpr node child = s_Program.m_Nodes[n.m_FirstChild];
+				if constexpr (child.m_Type == node_type::char_set ||
+					(child.m_Type == node_type::literal && child.m_Length == 1))
+				{
+					// Single character repeats (.*, \d+, \s+...) are by far the most common, and
+					// don't need the recursion below.
+					const size_t limit = std::min(size_t(st.m_End - it), n.m_Max);
+
+					if constexpr (n.m_Lazy)
+					{
+						for (size_t count = 0; ; count++)
+						{
+							if (count >= n.m_Min && cont(it + count))
+								return true;
+							if (count >= limit || !match_char<n.m_FirstChild>(it[count]))
+								return false;
+						}
+					}
+					else
+					{
+						size_t count = 0;
+						while (count < limit && match_char<n.m_FirstChild>(it[count]))
+							count++;
+
+						if (count < n.m_Min)
+							return false;
+
+						for (size_t i = count; ; i--)
+						{
+							if (cont(it + i))
+								return true;
+							if (i == n.m_Min)
+								return false;
+						}
+					}
+				}
+				else
+				{
+					return match_repeat<Index>(it, st, cont, 0);
+				}
+			}
+		}
+
+		template<size_t Index, typename TCont>
+		static bool match_sequence(const char* it, state& st, const TCont& cont)
+		{
+			if constexpr (Index == npos)
+			{
+				return cont(it);
+			}
+			else
+			{
+				constexpr size_t next = s_Program.m_Nodes[Index].m_NextSibling;
+				if constexpr (next == npos)
+					return match_node<Index>(it, st, cont);
+				else
+					return match_node<Index>(it, st, [&](const char* p) { return match_sequence<next>(p, st, cont); });
+			}
+		}
+
+		template<size_t Index, typename TCont>
+		static bool match_alternation(const char* it, state& st, const TCont& cont)
+		{
+			if (match_node<Index>(it, st, cont))
+				return true;
+
+			constexpr size_t next = s_Program.m_Nodes[Index].m_NextSibling;
+			if constexpr (next == npos)
+				return false;
+			else
+				return match_alternation<next>(it, st, cont);
+		}
+
+		template<size_t Index, typename TCont>
+		static bool match_repeat(const char* it, state& st, const TCont& cont, size_t count)
+		{
+			constexpr node n = s_Program.m_Nodes[Index];
+
+			const auto TryOneMore = [&]
+			{
+				return count < n.m_Max && match_node<n.m_FirstChild>(it, st, [&](const char* p)
+					{
+						// An iteration that matched nothing can't get us anywhere new
+						if (p == it && count >= n.m_Min)
+							return false;
+
+						return match_repeat<Index>(p, st, cont, count + 1);
+					});
+			};
+
+			if constexpr (n.m_Lazy)
+				return (count >= n.m_Min && cont(it)) || TryOneMore();
+			else
+				return TryOneMore() || (count >= n.m_Min && cont(it));
+		}
+	};
 }
@@ -0,0 +1,750 @@
+#include "WorldJournal.h"
+#include "Actions/RCONActionManager.h"
+#include "Config/ChatWrappers.h"
+#include "Config/Settings.h"
+#include "Util/JSONUtils.h"
+#include "ConsoleLog/ConsoleLogParser.h"
+#include "Networking/HTTPClient.h"
+#include "Networking/HTTPHelpers.h"
+#include "Filesystem.h"
+#include "GlobalDispatcher.h"
+#include "Log.h"
+#include "ModeratorLogic.h"
+#include "WorldState.h"
+
+#include <mh/text/fmtstr.hpp>
+#include <mh/text/format.hpp>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+using namespace tf2_bot_detector;
+
+// How long a replay waits for parsed lines that never seem to arrive before moving on
+static constexpr auto REPLAY_DELIVERY_TIMEOUT = 10s;
+
+namespace
+{
+	constexpr char JOURNAL_MAGIC[8] = { 'T', 'F', '2', 'B', 'D', 'J', 'N', 'L' };
+	constexpr uint32_t JOURNAL_VERSION = 2;
+
+	using journal_duration_t = std::chrono::microseconds;
+
+	void WriteVarInt(std::ostream& output, uint64_t value)
+	{
+		char buf[10];
+		size_t length = 0;
+		do
+		{
+			buf[length] = char(value & 0x7F);
+			value >>= 7;
+			if (value)
+				buf[length] |= 0x80;
+
+			length++;
+
+		} while (value);
+
+		output.write(buf, length);
+	}
+
+	// Returns false if we hit the end of the input before the end of the varint
+	bool ReadVarInt(std::istream& input, uint64_t& value)
+	{
+		value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			const auto c = input.get();
+			if (c == std::istream::traits_type::eof())
+				return false;
+
+			value |= uint64_t(c & 0x7F) << shift;
+			if (!(c & 0x80))
+				return true;
+		}
+
+		throw std::runtime_error("Journal is corrupt: varint is too long");
+	}
+
+	// The wall clock can go backwards, so time deltas are signed
+	uint64_t ZigZagEncode(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+	int64_t ZigZagDecode(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+	void WriteString(std::ostream& output, const std::string_view& str)
+	{
+		WriteVarInt(output, str.size());
+		output.write(str.data(), str.size());
+	}
+
+	bool ReadString(std::istream& input, std::string& str)
+	{
+		uint64_t length;
+		if (!ReadVarInt(input, length))
+			return false;
+
+		str.resize(size_t(length));
+		input.read(str.data(), str.size());
+		return size_t(input.gcount()) == str.size();
+	}
+}
+
+JournalWriter::JournalWriter(std::ostream& output, time_point_t startTime) :
+	m_Output(&output), m_LastTimestamp(startTime)
+{
+	const uint32_t version = JOURNAL_VERSION;
+	const int64_t startTimeUS = std::chrono::duration_cast<journal_duration_t>(startTime.time_since_epoch()).count();
+
+	m_Output->write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+	m_Output->write(reinterpret_cast<const char*>(&version), sizeof(version));
+	m_Output->write(reinterpret_cast<const char*>(&startTimeUS), sizeof(startTimeUS));
+}
+
+void JournalWriter::Write(JournalRecordType type, const std::string_view& data, const std::string_view& key,
+	time_point_t timestamp)
+{
+	const auto delta = std::chrono::duration_cast<journal_duration_t>(timestamp - m_LastTimestamp);
+	m_LastTimestamp += delta; // Rounded, so the error doesn't accumulate
+
+	m_Output->put(char(type));
+	WriteVarInt(*m_Output, ZigZagEncode(delta.count()));
+	WriteString(*m_Output, key);
+	WriteString(*m_Output, data);
+}
+
+JournalReader::JournalReader(std::istream& input) :
+	m_Input(&input)
+{
+	char magic[sizeof(JOURNAL_MAGIC)];
+	uint32_t version;
+	int64_t startTimeUS;
+
+	m_Input->read(magic, sizeof(magic));
+	m_Input->read(reinterpret_cast<char*>(&version), sizeof(version));
+	m_Input->read(reinterpret_cast<char*>(&startTimeUS), sizeof(startTimeUS));
+
+	if (!*m_Input || !std::equal(std::begin(magic), std::end(magic), std::begin(JOURNAL_MAGIC)))
+		throw std::runtime_error("Not a journal file");
+	if (version != JOURNAL_VERSION)
+		throw std::runtime_error(mh::format("Unsupported journal version {} (expected {})", version, JOURNAL_VERSION));
+
+	m_StartTime = time_point_t(std::chrono::duration_cast<duration_t>(journal_duration_t(startTimeUS)));
+	m_LastTimestamp = m_StartTime;
+}
+
+bool JournalReader::Read(JournalRecord& record)
+{
+	const auto type = m_Input->get();
+	if (type == std::istream::traits_type::eof())
+		return false;
+
+	if (type < int(JournalRecordType::ConsoleLogText) || type > int(JournalRecordType::ModeratorHeader))
+		throw std::runtime_error(mh::format("Journal is corrupt: unknown record type {}", type));
+
+	uint64_t delta;
+	if (!ReadVarInt(*m_Input, delta) || !ReadString(*m_Input, record.m_Key) || !ReadString(*m_Input, record.m_Data))
+	{
+		LogWarning("Journal ends with a truncated record, ignoring it");
+		return false;
+	}
+
+	m_LastTimestamp += std::chrono::duration_cast<duration_t>(journal_duration_t(ZigZagDecode(delta)));
+	record.m_Type = JournalRecordType(type);
+	record.m_Timestamp = m_LastTimestamp;
+	return true;
+}
+
+JournalModeratorHeader::JournalModeratorHeader(const Settings& settings, size_t ruleCount, size_t playerListCount) :
+	m_LocalSteamID(settings.GetLocalSteamID()),
+	m_AutoChatWarnings(settings.m_AutoChatWarnings),
+	m_AutoChatWarningsConnecting(settings.m_AutoChatWarningsConnecting),
+	m_AutoVotekick(settings.m_AutoVotekick),
+	m_AutoVotekickDelay(settings.m_AutoVotekickDelay),
+	m_AutoMark(settings.m_AutoMark),
+	m_AutoTempMute(settings.m_AutoTempMute),
+	m_HasSteamAPIKey(!settings.GetSteamAPIKey().empty()),
+	m_LazyLoadAPIData(settings.m_LazyLoadAPIData),
+	m_RuleCount(ruleCount),
+	m_PlayerListCount(playerListCount)
+{
+}
+
+void JournalModeratorHeader::ApplyTo(Settings& settings) const
+{
+	settings.m_LocalSteamIDOverride = m_LocalSteamID;
+	settings.m_AutoChatWarnings = m_AutoChatWarnings;
+	settings.m_AutoChatWarningsConnecting = m_AutoChatWarningsConnecting;
+	settings.m_AutoVotekick = m_AutoVotekick;
+	settings.m_AutoVotekickDelay = m_AutoVotekickDelay;
+	settings.m_AutoMark = m_AutoMark;
+	settings.m_AutoTempMute = m_AutoTempMute;
+	settings.m_LazyLoadAPIData = m_LazyLoadAPIData; // Decides who gets looked up
+
+	// Without a key nothing goes to the Steam API, so there wouldn't be anything to replay.
+	// Any key will do, requests are answered from the journal.
+	if (!m_HasSteamAPIKey)
+		settings.SetSteamAPIKey({});
+	else if (settings.GetSteamAPIKey().empty())
+		settings.SetSteamAPIKey("REPLAY");
+}
+
+void tf2_bot_detector::to_json(nlohmann::json& j, const JournalModeratorHeader& d)
+{
+	j =
+	{
+		{ "local_steamid", d.m_LocalSteamID },
+		{ "auto_chat_warnings", d.m_AutoChatWarnings },
+		{ "auto_chat_warnings_connecting", d.m_AutoChatWarningsConnecting },
+		{ "auto_votekick", d.m_AutoVotekick },
+		{ "auto_votekick_delay", d.m_AutoVotekickDelay },
+		{ "auto_mark", d.m_AutoMark },
+		{ "auto_temp_mute", d.m_AutoTempMute },
+		{ "has_steam_api_key", d.m_HasSteamAPIKey },
+		{ "lazy_load_api_data", d.m_LazyLoadAPIData },
+		{ "rule_count", d.m_RuleCount },
+		{ "player_list_count", d.m_PlayerListCount },
+	};
+}
+
+void tf2_bot_detector::from_json(const nlohmann::json& j, JournalModeratorHeader& d)
+{
+	try_get_to_defaulted(j, d.m_LocalSteamID, "local_steamid");
+	try_get_to_defaulted(j, d.m_AutoChatWarnings, "auto_chat_warnings");
+	try_get_to_defaulted(j, d.m_AutoChatWarningsConnecting, "auto_chat_warnings_connecting");
+	try_get_to_defaulted(j, d.m_AutoVotekick, "auto_votekick");
+	try_get_to_defaulted(j, d.m_AutoVotekickDelay, "auto_votekick_delay");
+	try_get_to_defaulted(j, d.m_AutoMark, "auto_mark");
+	try_get_to_defaulted(j, d.m_AutoTempMute, "auto_temp_mute");
+	try_get_to_defaulted(j, d.m_HasSteamAPIKey, "has_steam_api_key");
+	try_get_to_defaulted(j, d.m_LazyLoadAPIData, "lazy_load_api_data", true);
+	try_get_to_defaulted(j, d.m_RuleCount, "rule_count");
+	try_get_to_defaulted(j, d.m_PlayerListCount, "player_list_count");
+}
+
+std::string tf2_bot_detector::GetJournalKey(const URL& url)
+{
+	const std::string str = mh::format("{}", url);
+
+	const auto queryStart = str.find('?');
+	if (queryStart == str.npos)
+		return str;
+
+	std::string key = str.substr(0, queryStart);
+	char separator = '?';
+	for (size_t begin = queryStart + 1; begin < str.size(); )
+	{
+		const auto end = std::min(str.find('&', begin), str.size());
+		const std::string_view param = std::string_view(str).substr(begin, end - begin);
+		if (!param.empty() && !param.starts_with("key="))
+		{
+			key += separator;
+			key += param;
+			separator = '&';
+		}
+
+		begin = end + 1;
+	}
+
+	return key;
+}
+
+namespace
+{
+	class JournalRecorder final : public IJournalRecorder
+	{
+	public:
+		bool Start() override;
+		void Stop() override;
+		bool IsRecording() const override { return m_IsRecording; }
+		uint32_t GetSessionID() const override { return m_SessionID; }
+
+		void Record(JournalRecordType type, const std::string_view& data, const std::string_view& key) override;
+
+	private:
+		std::atomic<bool> m_IsRecording = false;
+		std::atomic<uint32_t> m_SessionID = 0;
+
+		std::mutex m_Mutex;
+		std::ofstream m_File;
+		std::optional<JournalWriter> m_Writer;
+	};
+}
+
+IJournalRecorder& IJournalRecorder::GetInstance()
+{
+	static JournalRecorder s_Recorder;
+	return s_Recorder;
+}
+
+bool JournalRecorder::Start() try
+{
+	std::lock_guard lock(m_Mutex);
+	if (m_IsRecording)
+		return true;
+
+	const auto journalDir = IFilesystem::Get().GetLogsDir() / "journal";
+	std::filesystem::create_directories(journalDir);
+
+	const auto t = ToTM(tfbd_clock_t::now());
+	const mh::fmtstr<128> timestampStr("{}", std::put_time(&t, "%Y-%m-%d_%H-%M-%S"));
+	const auto path = journalDir / mh::fmtstr<128>("journal_{}.tf2bdj", timestampStr).view();
+
+	m_File = std::ofstream(path, std::ofstream::binary | std::ofstream::trunc);
+	if (!m_File.good())
+	{
+		LogError("Failed to open {} for writing, journal will not be recorded", path);
+		return false;
+	}
+
+	m_Writer.emplace(m_File);
+	m_SessionID++;
+	m_IsRecording = true;
+	Log("Recording journal to {}", path);
+	return true;
+}
+catch (const std::filesystem::filesystem_error& e)
+{
+	LogError(MH_SOURCE_LOCATION_CURRENT(), e.what());
+	return false;
+}
+
+void JournalRecorder::Stop()
+{
+	std::lock_guard lock(m_Mutex);
+	m_IsRecording = false;
+	m_Writer.reset();
+	m_File.close();
+}
+
+void JournalRecorder::Record(JournalRecordType type, const std::string_view& data, const std::string_view& key)
+{
+	std::lock_guard lock(m_Mutex);
+	if (!m_IsRecording)
+		return;
+
+	m_Writer->Write(type, data, key);
+
+	// Flushed every record so a crash doesn't cost us the part of the session we care about most
+	m_File.flush();
+}
+
+namespace
+{
+	// Steam API calls that look up a batch of players at once (steamids=a,b,c), and where to find
+	// each player's entry in the response
+	struct BatchedEndpoint
+	{
+		std::string_view m_Path;
+		std::string_view m_PlayersPointer;
+		std::string_view m_SteamIDField;
+	};
+
+	constexpr BatchedEndpoint BATCHED_ENDPOINTS[] =
+	{
+		{ "/ISteamUser/GetPlayerSummaries/", "/response/players", "steamid" },
+		{ "/ISteamUser/GetPlayerBans/", "/players", "SteamId" },
+	};
+
+	struct BatchedRequest
+	{
+		const BatchedEndpoint* m_Endpoint = nullptr;
+		std::string m_BaseKey; // The journal key minus the steamids parameter
+		std::vector<std::string> m_SteamIDs;
+
+		std::string GetPlayerKey(const std::string_view& steamID) const
+		{
+			return mh::format("{}#{}", m_BaseKey, steamID);
+		}
+	};
+
+	std::optional<BatchedRequest> ParseBatchedRequest(const std::string_view& key)
+	{
+		const auto queryStart = key.find('?');
+		if (queryStart == key.npos)
+			return std::nullopt;
+
+		BatchedRequest request;
+		for (const auto& endpoint : BATCHED_ENDPOINTS)
+		{
+			if (key.substr(0, queryStart).find(endpoint.m_Path) != key.npos)
+				request.m_Endpoint = &endpoint;
+		}
+
+		if (!request.m_Endpoint)
+			return std::nullopt;
+
+		request.m_BaseKey = key.substr(0, queryStart);
+		char separator = '?';
+		for (size_t begin = queryStart + 1; begin < key.size(); )
+		{
+			const auto end = std::min(key.find('&', begin), key.size());
+			const std::string_view param = key.substr(begin, end - begin);
+			if (param.starts_with("steamids="))
+			{
+				const auto ids = param.substr(9);
+				for (size_t idBegin = 0; idBegin < ids.size(); )
+				{
+					const auto idEnd = std::min(ids.find(',', idBegin), ids.size());
+					if (idEnd > idBegin)
+						request.m_SteamIDs.emplace_back(ids.substr(idBegin, idEnd - idBegin));
+
+					idBegin = idEnd + 1;
+				}
+			}
+			else if (!param.empty())
+			{
+				request.m_BaseKey += separator;
+				request.m_BaseKey += param;
+				separator = '&';
+			}
+
+			begin = end + 1;
+		}
+
+		if (request.m_SteamIDs.empty())
+			return std::nullopt;
+
+		return request;
+	}
+
+	// Answers HTTP requests with the responses recorded for the same URL, in the order they were
+	// recorded. Batched Steam API responses are split up per player when they're added, and put
+	// back together for whichever players are asked for.
+	class ReplayHTTPClient final : public IHTTPClient
+	{
+	public:
+		void AddResponse(const JournalRecord& record)
+		{
+			std::lock_guard lock(m_Mutex);
+			if (auto batch = ParseBatchedRequest(record.m_Key); batch && AddBatchedResponse(*batch, record))
+				return;
+
+			m_Responses[record.m_Key].push_back(record);
+		}
+
+		std::string GetString(const URL& url) const override
+		{
+			++m_TotalRequestCount;
+
+			const auto key = GetJournalKey(url);
+			if (auto batch = ParseBatchedRequest(key))
+				return GetBatchedResponse(url, *batch);
+
+			JournalRecord record;
+			{
+				std::lock_guard lock(m_Mutex);
+				auto found = m_Responses.find(key);
+				if (found == m_Responses.end() || found->second.empty())
+				{
+					++m_UnansweredCount;
+					throw std::runtime_error(mh::format("No recorded response for {}", key));
+				}
+
+				record = std::move(found->second.front());
+				found->second.pop_front();
+			}
+
+			if (record.m_Type == JournalRecordType::HTTPError)
+				ThrowRecordedError(url, key, record.m_Data);
+
+			return record.m_Data;
+		}
+		mh::task<std::string> GetStringAsync(URL url) const override
+		{
+			co_return GetString(url);
+		}
+
+		uint32_t GetTotalRequestCount() const override { return m_TotalRequestCount; }
+		uint32_t GetUnansweredCount() const { return m_UnansweredCount; }
+
+	private:
+		// One player's share of a recorded batch
+		struct PlayerResponse
+		{
+			JournalRecordType m_Type{};
+			std::string m_Data; // The player's entry (empty if the response left them out), or the error
+		};
+
+		// Returns false if the response isn't in the shape we expect, so it can be served whole
+		bool AddBatchedResponse(const BatchedRequest& batch, const JournalRecord& record)
+		{
+			std::map<std::string, std::string, std::less<>> entries;
+			if (record.m_Type == JournalRecordType::HTTPResponse)
+			{
+				try
+				{
+					const auto json = nlohmann::json::parse(record.m_Data);
+					const nlohmann::json::json_pointer pointer{ std::string(batch.m_Endpoint->m_PlayersPointer) };
+					for (const auto& player : json.at(pointer))
+						entries[player.at(batch.m_Endpoint->m_SteamIDField).get<std::string>()] = player.dump();
+				}
+				catch (const std::exception& e)
+				{
+					LogWarning("Recorded response for {} couldn't be split up per player, it will only be served whole: {}",
+						record.m_Key, e.what());
+					return false;
+				}
+			}
+
+			for (const auto& steamID : batch.m_SteamIDs)
+			{
+				PlayerResponse response{ record.m_Type };
+				if (record.m_Type == JournalRecordType::HTTPError)
+					response.m_Data = record.m_Data;
+				else if (auto found = entries.find(steamID); found != entries.end())
+					response.m_Data = std::move(found->second);
+
+				m_PlayerResponses[batch.GetPlayerKey(steamID)].push_back(std::move(response));
+			}
+
+			return true;
+		}
+
+		std::string GetBatchedResponse(const URL& url, const BatchedRequest& batch) const
+		{
+			const auto key = GetJournalKey(url);
+
+			// Everyone in the batch uses up a response, even if someone else's makes it fail
+			std::vector<PlayerResponse> responses;
+			std::optional<JournalRecord> wholeRecord;
+			size_t unanswered = 0;
+			{
+				std::lock_guard lock(m_Mutex);
+				for (const auto& steamID : batch.m_SteamIDs)
+				{
+					auto found = m_PlayerResponses.find(batch.GetPlayerKey(steamID));
+					if (found == m_PlayerResponses.end() || found->second.empty())
+					{
+						unanswered++;
+						continue;
+					}
+
+					responses.push_back(std::move(found->second.front()));
+					found->second.pop_front();
+				}
+
+				// Might have been one we couldn't split up
+				if (auto found = m_Responses.find(key);
+					responses.empty() && found != m_Responses.end() && !found->second.empty())
+				{
+					wholeRecord = std::move(found->second.front());
+					found->second.pop_front();
+				}
+			}
+
+			if (wholeRecord)
+			{
+				if (wholeRecord->m_Type == JournalRecordType::HTTPError)
+					ThrowRecordedError(url, key, wholeRecord->m_Data);
+
+				return wholeRecord->m_Data;
+			}
+
+			m_UnansweredCount += uint32_t(unanswered);
+			if (responses.empty())
+				throw std::runtime_error(mh::format("No recorded response for any of the players in {}", key));
+
+			nlohmann::json players = nlohmann::json::array();
+			for (const auto& response : responses)
+			{
+				if (response.m_Type == JournalRecordType::HTTPError)
+					ThrowRecordedError(url, key, response.m_Data);
+
+				if (!response.m_Data.empty())
+					players.push_back(nlohmann::json::parse(response.m_Data));
+			}
+
+			nlohmann::json json;
+			json[nlohmann::json::json_pointer(std::string(batch.m_Endpoint->m_PlayersPointer))] = std::move(players);
+			return json.dump();
+		}
+
+		[[noreturn]] static void ThrowRecordedError(const URL& url, const std::string_view& key, const std::string_view& data)
+		{
+			if (data.empty())
+				throw std::runtime_error(mh::format("Recorded error for {}", key));
+
+			ThrowRecordedHTTPError(url, data);
+		}
+
+		mutable std::mutex m_Mutex;
+		mutable std::map<std::string, std::deque<JournalRecord>, std::less<>> m_Responses;
+		mutable std::map<std::string, std::deque<PlayerResponse>, std::less<>> m_PlayerResponses;
+		mutable std::atomic_uint32_t m_TotalRequestCount = 0;
+		mutable std::atomic_uint32_t m_UnansweredCount = 0;
+	};
+
+	// Discards everything, the game isn't there to send it to
+	class ReplayActionManager final : public IRCONActionManager
+	{
+	public:
+		void Update() override {}
+		bool QueueAction(std::unique_ptr<IAction>&& action) override
+		{
+			m_QueuedActionCount++;
+			return true;
+		}
+		void AddPeriodicActionGenerator(std::unique_ptr<IPeriodicActionGenerator>&& action) override {}
+
+		size_t m_QueuedActionCount = 0;
+	};
+}
+
+JournalReplayResult tf2_bot_detector::ReplayJournal(std::istream& journal, Settings& settings,
+	const ModeratorConfig* moderatorConfig)
+{
+	JournalReplayResult result;
+
+	JournalReader reader(journal);
+	std::vector<JournalRecord> records;
+	std::optional<JournalModeratorHeader> header;
+	auto httpClient = std::make_shared<ReplayHTTPClient>();
+	for (JournalRecord record; reader.Read(record); )
+	{
+		result.m_RecordCount++;
+		result.m_RecordedDuration = record.m_Timestamp - reader.GetStartTime();
+
+		if (record.m_Type == JournalRecordType::HTTPResponse || record.m_Type == JournalRecordType::HTTPError)
+		{
+			// Requests won't go out at the same time they did live, so these are handed out on demand
+			result.m_HTTPResponseCount++;
+			httpClient->AddResponse(record);
+		}
+		else if (record.m_Type == JournalRecordType::ModeratorHeader)
+		{
+			// Everything reads settings as it goes, so these need to be in place before we start
+			if (!header)
+				header = nlohmann::json::parse(record.m_Data).get<JournalModeratorHeader>();
+		}
+		else
+		{
+			records.push_back(std::move(record));
+		}
+	}
+
+	// Auto-mark saves to the player lists ModeratorLogic loads, so never hand it the real ones
+	std::optional<ModeratorConfig> copiedConfig;
+	if (!moderatorConfig)
+		moderatorConfig = &copiedConfig.emplace(ModeratorConfig::CopyFromConfigFiles());
+
+	if (header)
+		header->ApplyTo(settings);
+	else
+		LogWarning("Journal has no moderator header, replaying with this machine's settings");
+
+	settings.m_AllowInternetUsage = true;
+	settings.SetHTTPClient(httpClient);
+
+	const auto startTime = std::chrono::steady_clock::now();
+	{
+		time_point_t wallClock = reader.GetStartTime();
+
+		const auto world = IWorldState::Create(settings, [&] { return wallClock; });
+		ReplayActionManager actionManager;
+		const auto modLogic = IModeratorLogic::Create(*world, settings, actionManager, [&] { return wallClock; },
+			moderatorConfig);
+		ConsoleLogParser parser(*world, settings, [&] { return wallClock; });
+
+		if (header && (header->m_RuleCount != modLogic->GetRuleCount() ||
+			header->m_PlayerListCount != modLogic->GetBlacklistedPlayerCount()))
+		{
+			LogWarning("Journal was recorded with {} rules and {} player list entries, but {} rules and {} player list entries are loaded here. Results may differ.",
+				header->m_RuleCount, header->m_PlayerListCount, modLogic->GetRuleCount(), modLogic->GetBlacklistedPlayerCount());
+		}
+
+		// expectedOutputChunks is our guess at what the world will deliver, so if it's ever
+		// wrong, give up once nothing has been delivered for a while rather than hang forever
+		size_t expectedOutputChunks = 0;
+		const auto WaitForDelivery = [&]
+		{
+			size_t lastChunkCount = world->GetConsoleOutputStats().m_ChunkCount;
+			size_t lastLineCount = parser.GetDeliveredLineCount();
+			auto lastProgressTime = std::chrono::steady_clock::now();
+
+			while (!parser.IsIdle() || world->GetConsoleOutputStats().m_ChunkCount < expectedOutputChunks)
+			{
+				GetDispatcher().run_for(1ms);
+
+				const size_t chunkCount = world->GetConsoleOutputStats().m_ChunkCount;
+				const size_t lineCount = parser.GetDeliveredLineCount();
+				const auto now = std::chrono::steady_clock::now();
+				if (chunkCount != lastChunkCount || lineCount != lastLineCount)
+				{
+					lastChunkCount = chunkCount;
+					lastLineCount = lineCount;
+					lastProgressTime = now;
+				}
+				else if ((now - lastProgressTime) >= REPLAY_DELIVERY_TIMEOUT)
+				{
+					LogWarning("Nothing was delivered for {} seconds while replaying (game command output: {} of {} chunks, console log parser idle: {}), moving on. Results may differ.",
+						std::chrono::duration_cast<std::chrono::seconds>(REPLAY_DELIVERY_TIMEOUT).count(),
+						chunkCount, expectedOutputChunks, parser.IsIdle());
+
+					expectedOutputChunks = std::min(expectedOutputChunks, chunkCount);
+					result.m_DeliveryTimeoutCount++;
+					break;
+				}
+			}
+		};
+
+		std::optional<JournalRecordType> lastType;
+		for (const JournalRecord& record : records)
+		{
+			// The console log and game command output are parsed separately, so let one finish
+			// before starting on the other to deliver things in the same order every time
+			if (lastType != record.m_Type)
+				WaitForDelivery();
+
+			lastType = record.m_Type;
+			wallClock = record.m_Timestamp;
+
+			switch (record.m_Type)
+			{
+			case JournalRecordType::ConsoleLogText:
+				result.m_ConsoleLogBytes += record.m_Data.size();
+				parser.AddText(record.m_Data);
+				break;
+
+			case JournalRecordType::GameCommandOutput:
+				result.m_GameCommandOutputCount++;
+				if (record.m_Data.find('\n') != record.m_Data.npos) // Otherwise there are no complete lines
+					expectedOutputChunks++;
+
+				world->AddConsoleOutputChunk(record.m_Data);
+				break;
+
+			case JournalRecordType::ChatWrappers:
+				settings.m_Unsaved.m_ChatMsgWrappers = nlohmann::json::parse(record.m_Data).get<ChatWrappers>();
+				break;
+
+			default:
+				break;
+			}
+
+			GetDispatcher().run_for(0ms);
+			parser.Update();
+			world->Update();
+			modLogic->Update();
+		}
+
+		WaitForDelivery();
+		result.m_HTTPRequestCount = httpClient->GetTotalRequestCount();
+		result.m_HTTPUnansweredCount = httpClient->GetUnansweredCount();
+		result.m_QueuedActionCount = actionManager.m_QueuedActionCount;
+		result.m_PlayerCount = world->GetPlayerStoreStats().m_PlayerCount;
+	}
+	result.m_ReplayDuration = std::chrono::steady_clock::now() - startTime;
+
+	return result;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Clock.h"
+#include "SteamID.h"
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace tf2_bot_detector
+{
+	class Settings;
+	class URL;
+	struct ModeratorConfig;
+
+	// Everything WorldState and ModeratorLogic act on that can't be recovered from the
+	// logs/console mirror alone
+	enum class JournalRecordType : uint8_t
+	{
+		ConsoleLogText = 1,    // console.log text, exactly as it was handed to ConsoleLogParser
+		GameCommandOutput = 2, // Game command (RCON) responses, as handed to IWorldState::AddConsoleOutputChunk()
+		HTTPResponse = 3,      // Key is the URL (see GetJournalKey()), data is the response body
+		HTTPError = 4,         // Key is the URL (see GetJournalKey()), data is SerializeHTTPError(), or empty if it wasn't an http_error
+		ChatWrappers = 5,      // Data is the chat wrappers in use, as json
+		ModeratorHeader = 6,   // Data is a JournalModeratorHeader, as json
+	};
+
+	// Written by ModeratorLogic when it starts: the settings it makes its decisions with, and
+	// how many rules and player list entries it loaded. The rules and player lists themselves
+	// aren't recorded, but the counts are enough to tell when a replay is using different ones.
+	struct JournalModeratorHeader
+	{
+		JournalModeratorHeader() = default;
+		JournalModeratorHeader(const Settings& settings, size_t ruleCount, size_t playerListCount);
+
+		void ApplyTo(Settings& settings) const;
+
+		SteamID m_LocalSteamID;
+		bool m_AutoChatWarnings = false;
+		bool m_AutoChatWarningsConnecting = false;
+		bool m_AutoVotekick = false;
+		float m_AutoVotekickDelay = 0;
+		bool m_AutoMark = false;
+		bool m_AutoTempMute = false;
+		bool m_HasSteamAPIKey = false; // The key itself is never recorded
+		bool m_LazyLoadAPIData = true;
+
+		size_t m_RuleCount = 0;
+		size_t m_PlayerListCount = 0;
+	};
+
+	void to_json(nlohmann::json& j, const JournalModeratorHeader& d);
+	void from_json(const nlohmann::json& j, JournalModeratorHeader& d);
+
+	struct JournalRecord
+	{
+		JournalRecordType m_Type{};
+		time_point_t m_Timestamp{}; // Wall clock time the record was written
+		std::string m_Key;
+		std::string m_Data;
+	};
+
+	// A journal starts with a magic number, a format version and the time recording started.
+	// Every record after that is its type (1 byte), the time since the previous record in
+	// microseconds (zigzag varint), then the key and the data (each a varint length followed
+	// by the bytes themselves).
+	class JournalWriter final
+	{
+	public:
+		explicit JournalWriter(std::ostream& output, time_point_t startTime = clock_t::now());
+
+		void Write(JournalRecordType type, const std::string_view& data, const std::string_view& key = {},
+			time_point_t timestamp = clock_t::now());
+
+	private:
+		std::ostream* m_Output = nullptr;
+		time_point_t m_LastTimestamp{};
+	};
+
+	class JournalReader final
+	{
+	public:
+		// Throws std::runtime_error if input isn't a journal we can read
+		explicit JournalReader(std::istream& input);
+
+		// Returns false once there are no more records. Throws std::runtime_error if the
+		// journal is corrupt. A truncated final record (the program crashed mid-write) is
+		// treated as the end of the journal.
+		bool Read(JournalRecord& record);
+
+		time_point_t GetStartTime() const { return m_StartTime; }
+
+	private:
+		std::istream* m_Input = nullptr;
+		time_point_t m_StartTime{};
+		time_point_t m_LastTimestamp{};
+	};
+
+	// HTTP records are keyed on the URL, minus the Steam API key, which has no business being
+	// in a file people are going to attach to bug reports
+	std::string GetJournalKey(const URL& url);
+
+	// Writes journal records to logs/journal while started. Thread safe.
+	class IJournalRecorder
+	{
+	public:
+		virtual ~IJournalRecorder() = default;
+
+		static IJournalRecorder& GetInstance();
+
+		virtual bool Start() = 0;
+		virtual void Stop() = 0;
+		virtual bool IsRecording() const = 0;
+		// Changes every time recording starts, so anything recorded once per journal
+		// (ChatWrappers) can tell it needs to be recorded again
+		virtual uint32_t GetSessionID() const = 0;
+
+		virtual void Record(JournalRecordType type, const std::string_view& data, const std::string_view& key = {}) = 0;
+	};
+
+	struct JournalReplayResult
+	{
+		size_t m_RecordCount = 0;
+		size_t m_ConsoleLogBytes = 0;
+		size_t m_GameCommandOutputCount = 0;
+		size_t m_HTTPResponseCount = 0;
+		size_t m_HTTPRequestCount = 0;    // Requests made during the replay
+		size_t m_HTTPUnansweredCount = 0; // Requests (or players in batched requests) nothing was recorded for
+		size_t m_QueuedActionCount = 0; // Kicks, chat warnings etc ModeratorLogic tried to send
+		size_t m_PlayerCount = 0;       // Players in the world state once the journal ran out
+		size_t m_DeliveryTimeoutCount = 0; // Times the replay gave up waiting for parsed lines to be delivered
+
+		duration_t m_RecordedDuration{};
+		std::chrono::nanoseconds m_ReplayDuration{};
+	};
+
+	// Feeds a journal into a fresh WorldState and ModeratorLogic as fast as it can. World time
+	// follows the timestamps in the recorded console log, the wall clock follows the times
+	// records were written, HTTP requests are answered with the recorded responses, and actions
+	// are discarded. Call on the main thread. Settings are modified to match the recorded
+	// JournalModeratorHeader and to serve the recorded HTTP responses, so don't pass the ones
+	// the UI is using. ModeratorLogic uses moderatorConfig if given, otherwise copies of the
+	// lists in cfg/ (see ModeratorConfig::CopyFromConfigFiles()).
+	//
+	// A replay never persists anything. Players marked during it (auto-mark is restored from the
+	// header like everything else) only end up in the copies, and nothing in cfg/ is written.
+	//
+	// Steam API requests for a batch of players are answered per player, since which players
+	// end up in which batch depends on timing that a replay can't reproduce exactly.
+	JournalReplayResult ReplayJournal(std::istream& journal, Settings& settings,
+		const ModeratorConfig* moderatorConfig = nullptr);
+}
@@ -1,11 +1,13 @@
 #include "WorldState.h"
 #include "Actions/Actions.h"
 #include "Config/Settings.h"
+#include "ConsoleLog/ConsoleLineArena.h"
 #include "ConsoleLog/ConsoleLineListener.h"
 #include "ConsoleLog/ConsoleLines.h"
 #include "ConsoleLog/ConsoleLogParser.h"
 #include "GameData/TFClassType.h"
 #include "GameData/UserMessageType.h"
+#include "Networking/HTTPClient.h"
 #include "Networking/HTTPHelpers.h"
 #include "Networking/SteamAPI.h"
 #include "Networking/LogsTFAPI.h"
@@ -15,7 +17,11 @@
 #include "GenericErrors.h"
 #include "IPlayer.h"
 #include "Log.h"
+#include "PlayerNameIndex.h"
+#include "PlayerTable.h"
 #include "WorldEventListener.h"
+#include "WorldJournal.h"
+#include "WorldStateSnapshot.h"
 #include "Config/AccountAges.h"
 #include "GlobalDispatcher.h"
 
@@ -27,6 +33,8 @@
 #include <mh/future.hpp>
 #include <mh/coroutine/future.hpp>
 
+#include <atomic>
+
 #undef GetCurrentTime
 #undef max
 #undef min
@@ -40,10 +48,31 @@ namespace
 {
 	class Player;
 
+	// What's kept of a player after they're evicted: just the results that cost us web requests
+	struct ColdPlayerData
+	{
+		mh::expected<SteamAPI::PlayerSummary> m_PlayerSummary = ErrorCode::LazyValueUninitialized;
+		mh::expected<SteamAPI::PlayerBans> m_PlayerSteamBans = ErrorCode::LazyValueUninitialized;
+		mh::expected<duration_t> m_TF2Playtime = ErrorCode::LazyValueUninitialized;
+		mh::expected<LogsTFAPI::PlayerLogsInfo> m_LogsInfo = ErrorCode::LazyValueUninitialized;
+
+		time_point_t m_LastStatusUpdateTime{}; // World time, the same clock eviction goes by
+
+		bool HasData() const;
+		size_t GetApproxMemoryUsage() const;
+	};
+
+	// Per-player requests, counted by the host that serves them
+	struct PerHostRequests
+	{
+		size_t m_SteamAPI = 0; // TF2 playtime
+		size_t m_LogsTF = 0;
+	};
+
 	class WorldState final : public IWorldState, BaseConsoleLineListener
 	{
 	public:
-		WorldState(const Settings& settings);
+		WorldState(const Settings& settings, WallClockFunc wallClock);
 		~WorldState();
 
 		std::shared_ptr<WorldState> shared_from_this() { return std::static_pointer_cast<WorldState>(IWorldState::shared_from_this()); }
@@ -57,7 +86,7 @@ namespace
 
 		void AddWorldEventListener(IWorldEventListener* listener) override;
 		void RemoveWorldEventListener(IWorldEventListener* listener) override;
-		void AddConsoleLineListener(IConsoleLineListener* listener) override;
+		void AddConsoleLineListener(IConsoleLineListener* listener, const ConsoleLineTypeMask& interests) override;
 		void RemoveConsoleLineListener(IConsoleLineListener* listener) override;
 
 		void AddConsoleOutputChunk(const std::string_view& chunk) override;
@@ -70,8 +99,7 @@ namespace
 		TeamShareResult GetTeamShareResult(const SteamID& id) const override;
 		TeamShareResult GetTeamShareResult(const SteamID& id0, const SteamID& id1) const override;
 		TeamShareResult GetTeamShareResult(const std::optional<LobbyMemberTeam>& team0, const SteamID& id1) const override;
-		static TeamShareResult GetTeamShareResult(
-			const std::optional<LobbyMemberTeam>& team0, const std::optional<LobbyMemberTeam>& team1);
+		using IWorldState::GetTeamShareResult;
 
 		using IWorldState::FindPlayer;
 		const IPlayer* FindPlayer(const SteamID& id) const override;
@@ -80,6 +108,9 @@ namespace
 		mh::generator<const IPlayer&> GetPlayers() const;
 		std::vector<const IPlayer*> GetRecentPlayers(size_t recentPlayerCount = 32) const;
 		std::vector<IPlayer*> GetRecentPlayers(size_t recentPlayerCount = 32);
+		const PlayerTable& GetPlayerTable() const override { return m_PlayerTable; }
+		void SetVisiblePlayers(const std::span<const SteamID>& ids) override;
+		void SetPlayerMarked(const SteamID& id, bool marked) override;
 
 		time_point_t GetLastStatusUpdateTime() const { return m_LastStatusUpdateTime; }
 
@@ -87,12 +118,19 @@ namespace
 		bool IsLocalPlayerInitialized() const override { return m_IsLocalPlayerInitialized; }
 		bool IsVoteInProgress() const override { return m_IsVoteInProgress; }
 
+		PlayerStoreStats GetPlayerStoreStats() const override;
+		ConsoleOutputStats GetConsoleOutputStats() const override { return m_ConsoleOutputStats; }
+		std::shared_ptr<const WorldStateSnapshot> GetSnapshot() const override;
+
 		void QueuePlayerSummaryUpdate(const SteamID& id);
 		void QueuePlayerBansUpdate(const SteamID& id);
+		void UpdatePlayerName(const SteamID& id, const std::string_view& oldName, const std::string_view& newName,
+			time_point_t timestamp);
 
 		const Settings& GetSettings() const { return m_Settings; }
 		const std::vector<LobbyMember>& GetCurrentLobbyMembers() const { return m_CurrentLobbyMembers; }
 		const std::vector<LobbyMember>& GetPendingLobbyMembers() const { return m_PendingLobbyMembers; }
+		const LobbyMember* FindLobbyMember(const SteamID& id) const;
 		const std::unordered_set<SteamID>& GetFriends() const { return m_Friends; }
 
 		IAccountAges& GetAccountAges() { return *m_AccountAges; }
@@ -100,13 +138,40 @@ namespace
 
 	protected:
 		virtual IConsoleLineListener& GetConsoleLineListenerBroadcaster() { return m_ConsoleLineListenerBroadcaster; }
+		ConsoleLineTypeMask GetConsoleLineInterests() const override { return m_ConsoleLineInterests; }
 
 	private:
 		const Settings& m_Settings;
+		WallClockFunc m_WallClock;
 
 		CompensatedTS m_CurrentTimestamp;
 
-		void OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed) override;
+		static constexpr ConsoleLineTypeMask CONSOLE_LINE_INTERESTS =
+		{
+			ConsoleLineType::Chat,
+			ConsoleLineType::ClientReachedServerSpawn,
+			ConsoleLineType::ConfigExec,
+			ConsoleLineType::Connecting,
+			ConsoleLineType::HostNewGame,
+			ConsoleLineType::KillNotification,
+			ConsoleLineType::LobbyChanged,
+			ConsoleLineType::LobbyHeader,
+			ConsoleLineType::LobbyMember,
+			ConsoleLineType::LobbyStatusFailed,
+			ConsoleLineType::NetDataTotal,
+			ConsoleLineType::NetLatency,
+			ConsoleLineType::NetLoss,
+			ConsoleLineType::NetPacketsTotal,
+			ConsoleLineType::Ping,
+			ConsoleLineType::PlayerStatus,
+			ConsoleLineType::PlayerStatusShort,
+			ConsoleLineType::SVC_UserMessage,
+			ConsoleLineType::ServerDroppedPlayer,
+			ConsoleLineType::VoiceReceive,
+		};
+		void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override;
+		void OnConsoleLogChunkParsed(IWorldState& world, bool consoleLinesParsed) override;
+		void OnConsoleLineParsed(IConsoleLine& parsed);
 		void OnConfigExecLineParsed(const ConfigExecLine& execLine);
 
 		void UpdateFriends();
@@ -115,6 +180,7 @@ namespace
 		time_point_t m_LastFriendsUpdate{};
 
 		Player& FindOrCreatePlayer(const SteamID& id);
+		ColdPlayerData* FindColdPlayerData(const SteamID& id);
 
 		struct PlayerSummaryUpdateAction final :
 			BatchedAction<WorldState*, SteamID, std::vector<SteamAPI::PlayerSummary>>
@@ -138,7 +204,58 @@ namespace
 
 		std::vector<LobbyMember> m_CurrentLobbyMembers;
 		std::vector<LobbyMember> m_PendingLobbyMembers;
+
+		// Where each SteamID can be found in m_CurrentLobbyMembers/m_PendingLobbyMembers. If a
+		// player is in both, this points at their current lobby slot. Rebuilt whenever either
+		// list changes, which only happens a few dozen times per tf_lobby_debug.
+		struct LobbyMemberSlot
+		{
+			unsigned m_Index{};
+			bool m_Pending{};
+		};
+		std::unordered_map<SteamID, LobbyMemberSlot> m_LobbyMemberSlots;
+		void RebuildLobbyMemberSlots();
+		void ClearLobbyMembers();
+
 		std::unordered_map<SteamID, std::shared_ptr<Player>> m_CurrentPlayerData;
+		PlayerNameIndex m_PlayerNames; // Must be kept in sync with m_CurrentPlayerData
+		PlayerTable m_PlayerTable;     // Must be kept in sync with m_CurrentPlayerData
+		void ClearPlayerData();
+		void SyncPlayerTableRow(const Player& player);
+		void SyncPlayerTableLobbyTeams();
+
+		// Players that are no longer in the lobby or on the scoreboard are evicted to the cold
+		// tier once there are more than Settings::m_MaxCachedPlayers of them
+		static constexpr duration_t PLAYER_EVICTION_DELAY = 60s;
+		static constexpr size_t MAX_COLD_PLAYERS = 4096;
+		void EvictPlayers();
+		void EvictPlayer(const Player& player);
+		void TrimColdPlayerData();
+		std::unordered_map<SteamID, ColdPlayerData> m_ColdPlayerData;
+		size_t m_EvictionCount = 0;
+		size_t m_ColdRestoreCount = 0;
+
+		// Fetches per-player web data ahead of time, most important players first, rather than
+		// whenever something happens to call a getter. Summaries and bans are batched 100
+		// players per request, so those are queued for everyone we care about. Playtime and
+		// logs.tf info are one request per player, so each pass only starts as many as the
+		// HTTP client's per-host throttle will let through before the next pass.
+		static constexpr duration_t PREFETCH_INTERVAL = 1s;
+		void UpdatePlayerDataPrefetch();
+		PerHostRequests GetPrefetchBudget(const PerHostRequests& inFlight) const;
+		void CancelQueuedFetches(const Player& player);
+		time_point_t m_LastPrefetchUpdate{};
+		std::vector<SteamID> m_VisiblePlayerIDs; // As last given to SetVisiblePlayers
+		std::unordered_set<SteamID> m_VisiblePlayers;
+		std::unordered_set<SteamID> m_MarkedPlayers;
+		std::vector<std::pair<uint8_t, Player*>> m_PrefetchCandidates;
+
+		// Building a snapshot copies every player, so chunks only mark it dirty, and Update()
+		// publishes at most one per frame
+		void PublishSnapshot();
+		std::atomic<std::shared_ptr<const WorldStateSnapshot>> m_Snapshot = std::make_shared<const WorldStateSnapshot>();
+		bool m_SnapshotDirty = false;
+		uint64_t m_SnapshotVersion = 0;
 		bool m_IsLocalPlayerInitialized = false;
 		bool m_IsVoteInProgress = false;
 
@@ -146,30 +263,42 @@ namespace
 
 		time_point_t m_LastStatusUpdateTime{};
 
-		std::unordered_set<IConsoleLineListener*> m_ConsoleLineListeners;
+		struct ConsoleLineListenerEntry
+		{
+			IConsoleLineListener* m_Listener;
+			ConsoleLineTypeMask m_Interests;
+		};
+		std::vector<ConsoleLineListenerEntry> m_ConsoleLineListeners;
+		ConsoleLineTypeMask m_ConsoleLineInterests; // Union of everything in m_ConsoleLineListeners
+		void UpdateConsoleLineInterests();
 		std::unordered_set<IWorldEventListener*> m_EventListeners;
 
 		mh::thread_pool m_ConsoleLineParsingPool{ 1 };
 		std::vector<mh::shared_future<std::shared_ptr<IConsoleLine>>> m_ConsoleLineParsingTasks;
+		mh::task<> ParseConsoleOutputAsync(std::shared_ptr<const std::string> text);
+		ConsoleOutputStats m_ConsoleOutputStats;
 
 		struct ConsoleLineListenerBroadcaster final : IConsoleLineListener
 		{
 			ConsoleLineListenerBroadcaster(WorldState& world) : m_World(world) {}
 
-			void OnConsoleLineParsed(IWorldState& world, IConsoleLine& line) override
+			void OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines) override
 			{
-				for (IConsoleLineListener* l : m_World.m_ConsoleLineListeners)
-					l->OnConsoleLineParsed(world, line);
+				for (const auto& entry : m_World.m_ConsoleLineListeners)
+				{
+					if (auto filtered = lines.Filter(entry.m_Interests); !filtered.empty())
+						entry.m_Listener->OnConsoleLinesParsed(world, filtered);
+				}
 			}
 			void OnConsoleLineUnparsed(IWorldState& world, const std::string_view& text) override
 			{
-				for (IConsoleLineListener* l : m_World.m_ConsoleLineListeners)
-					l->OnConsoleLineUnparsed(world, text);
+				for (const auto& entry : m_World.m_ConsoleLineListeners)
+					entry.m_Listener->OnConsoleLineUnparsed(world, text);
 			}
 			void OnConsoleLogChunkParsed(IWorldState& world, bool consoleLinesParsed) override
 			{
-				for (IConsoleLineListener* l : m_World.m_ConsoleLineListeners)
-					l->OnConsoleLogChunkParsed(world, consoleLinesParsed);
+				for (const auto& entry : m_World.m_ConsoleLineListeners)
+					entry.m_Listener->OnConsoleLogChunkParsed(world, consoleLinesParsed);
 			}
 
 			WorldState& m_World;
@@ -214,6 +343,7 @@ namespace
 		TFTeam m_Team{};
 
 		uint8_t m_ClientIndex{};
+		PlayerTable::row_t m_TableRow{};
 		mutable mh::expected<SteamAPI::PlayerSummary> m_PlayerSummary = ErrorCode::LazyValueUninitialized;
 		mutable mh::expected<SteamAPI::PlayerBans> m_PlayerSteamBans = ErrorCode::LazyValueUninitialized;
 
@@ -222,10 +352,19 @@ namespace
 
 		void SetPing(uint16_t ping, time_point_t timestamp);
 
+		// Starts fetching anything we don't have yet. Per-player requests are only started
+		// while their host has budget left, and each one uses up one.
+		void PrefetchBatched() const;
+		void PrefetchPerPlayer(PerHostRequests& budget) const;
+		PerHostRequests GetPerPlayerFetchesInProgress() const;
+
+		ColdPlayerData GetColdData() const;
+		void RestoreColdData(ColdPlayerData&& data);
+		size_t GetApproxMemoryUsage() const;
+
 	protected:
-		std::map<std::type_index, std::any> m_UserData;
-		const std::any* FindDataStorage(const std::type_index& type) const override;
-		std::any& GetOrCreateDataStorage(const std::type_index& type) override;
+		PlayerDataStorage m_UserData;
+		const PlayerDataStorage& GetDataStorage() const override { return m_UserData; }
 
 		std::shared_ptr<Player> shared_from_this() { return std::static_pointer_cast<Player>(IPlayer::shared_from_this()); }
 		std::shared_ptr<const Player> shared_from_this() const { return std::static_pointer_cast<const Player>(IPlayer::shared_from_this()); }
@@ -250,18 +389,19 @@ namespace
 	};
 }
 
-std::shared_ptr<IWorldState> IWorldState::Create(const Settings& settings)
+std::shared_ptr<IWorldState> IWorldState::Create(const Settings& settings, WallClockFunc wallClock)
 {
-	return std::make_shared<WorldState>(settings);
+	return std::make_shared<WorldState>(settings, std::move(wallClock));
 }
 
-WorldState::WorldState(const Settings& settings) :
+WorldState::WorldState(const Settings& settings, WallClockFunc wallClock) :
 	m_Settings(settings),
+	m_WallClock(std::move(wallClock)),
 	m_PlayerSummaryUpdates(this),
 	m_PlayerBansUpdates(this),
 	m_ConsoleLineListenerBroadcaster(*this)
 {
-	AddConsoleLineListener(this);
+	AddConsoleLineListener(this, CONSOLE_LINE_INTERESTS);
 }
 
 WorldState::~WorldState()
@@ -271,18 +411,26 @@ WorldState::~WorldState()
 
 void WorldState::Update()
 {
-	m_PlayerSummaryUpdates.Update();
-	m_PlayerBansUpdates.Update();
+	const auto now = m_WallClock();
 
 	UpdateFriends();
+	EvictPlayers();
+
+	// Before the batched requests go out, so they include whoever was just queued and leave
+	// out whoever just left
+	UpdatePlayerDataPrefetch();
+	m_PlayerSummaryUpdates.Update(now);
+	m_PlayerBansUpdates.Update(now);
+
+	PublishSnapshot();
 }
 
 void WorldState::UpdateFriends()
 {
 	if (auto client = GetSettings().GetHTTPClient();
-		client && !GetSettings().GetSteamAPIKey().empty() && (tfbd_clock_t::now() - 5min) > m_LastFriendsUpdate)
+		client && !GetSettings().GetSteamAPIKey().empty() && (m_WallClock() - 5min) > m_LastFriendsUpdate)
 	{
-		m_LastFriendsUpdate = tfbd_clock_t::now();
+		m_LastFriendsUpdate = m_WallClock();
 		m_FriendsFuture = SteamAPI::GetFriendList(GetSettings().GetSteamAPIKey(), GetSettings().GetLocalSteamID(), *client);
 	}
 
@@ -297,6 +445,7 @@ void WorldState::UpdateFriends()
 		try
 		{
 			m_Friends = m_FriendsFuture.get();
+			m_SnapshotDirty = true;
 		}
 		catch (const http_error& e)
 		{
@@ -327,49 +476,123 @@ void WorldState::UpdateFriends()
 	}
 }
 
-void WorldState::AddConsoleLineListener(IConsoleLineListener* listener)
+void WorldState::AddConsoleLineListener(IConsoleLineListener* listener, const ConsoleLineTypeMask& interests)
 {
-	m_ConsoleLineListeners.insert(listener);
+	auto found = std::find_if(m_ConsoleLineListeners.begin(), m_ConsoleLineListeners.end(),
+		[&](const ConsoleLineListenerEntry& entry) { return entry.m_Listener == listener; });
+
+	if (found != m_ConsoleLineListeners.end())
+		found->m_Interests = interests;
+	else
+		m_ConsoleLineListeners.push_back({ listener, interests });
+
+	UpdateConsoleLineInterests();
 }
 
 void WorldState::RemoveConsoleLineListener(IConsoleLineListener* listener)
 {
-	m_ConsoleLineListeners.erase(listener);
+	std::erase_if(m_ConsoleLineListeners,
+		[&](const ConsoleLineListenerEntry& entry) { return entry.m_Listener == listener; });
+
+	UpdateConsoleLineInterests();
+}
+
+void WorldState::UpdateConsoleLineInterests()
+{
+	m_ConsoleLineInterests = {};
+	for (const auto& entry : m_ConsoleLineListeners)
+		m_ConsoleLineInterests |= entry.m_Interests;
 }
 
 void WorldState::AddConsoleOutputChunk(const std::string_view& chunk)
 {
-	size_t last = 0;
-	for (auto i = chunk.find('\n', 0); i != chunk.npos; i = chunk.find('\n', last))
-	{
-		auto line = chunk.substr(last, i - last);
-		AddConsoleOutputLine(std::string(line));
-		last = i + 1;
-	}
+	if (auto& recorder = IJournalRecorder::GetInstance(); recorder.IsRecording())
+		recorder.Record(JournalRecordType::GameCommandOutput, chunk);
+
+	// Anything after the last newline is incomplete, and has always been dropped
+	if (chunk.find('\n') == chunk.npos)
+		return;
+
+	ParseConsoleOutputAsync(std::make_shared<const std::string>(chunk));
 }
 
 mh::task<> WorldState::AddConsoleOutputLine(std::string line)
 {
+	line += '\n';
+	return ParseConsoleOutputAsync(std::make_shared<const std::string>(std::move(line)));
+}
+
+mh::task<> WorldState::ParseConsoleOutputAsync(std::shared_ptr<const std::string> text)
+{
+	using clock = std::chrono::steady_clock;
+	const auto receivedTime = clock::now();
+
 	auto worldState = shared_from_this();
+	const auto interests = m_ConsoleLineInterests;
+	const auto timestamp = GetCurrentTime();
+	const auto arena = std::make_shared<ConsoleLineArena>(std::move(text));
+
+	struct ParsedLine
+	{
+		std::string_view m_Text;
+		std::shared_ptr<IConsoleLine> m_Parsed;
+	};
+	std::vector<ParsedLine> lines;
 
-	// Switch to thread "pool" thread (there is only 1 thread in this particular pool)
+	// One round trip to the parsing thread for the whole chunk. A status response is
+	// dozens of lines, and it used to be one round trip per line.
 	co_await m_ConsoleLineParsingPool.co_add_task();
 
-	auto parsed = IConsoleLine::ParseConsoleLine(line, GetCurrentTime());
+	const auto parseStartTime = clock::now();
+	{
+		ConsoleLineArena::Scope arenaScope(arena);
+
+		const std::string_view chunk = arena->GetText();
+		for (size_t last = 0, i = chunk.find('\n'); i != chunk.npos; last = i + 1, i = chunk.find('\n', last))
+		{
+			const auto line = chunk.substr(last, i - last);
+			lines.push_back({ line, IConsoleLine::ParseConsoleLine(line, timestamp, interests) });
+		}
+	}
+	const auto parseTime = clock::now() - parseStartTime;
 
-	// switch to main thread
 	co_await GetDispatcher().co_dispatch();
 
-	if (parsed)
+	const auto latency = clock::now() - receivedTime;
+	auto& stats = m_ConsoleOutputStats;
+	stats.m_ChunkCount++;
+	stats.m_LineCount += lines.size();
+	stats.m_TotalParseTime += parseTime;
+	stats.m_TotalLatency += latency;
+	stats.m_MaxLatency = std::max<std::chrono::nanoseconds>(stats.m_MaxLatency, latency);
+	stats.m_LastLatency = latency;
+
+	// Unparsed lines are reported in between runs of parsed lines, so everything stays in order
+	ConsoleLineBatch batch;
+	const auto FlushParsedLines = [&]
 	{
-		for (auto listener : m_ConsoleLineListeners)
-			listener->OnConsoleLineParsed(*worldState, *parsed);
-	}
-	else
+		if (batch.empty())
+			return;
+
+		m_ConsoleLineListenerBroadcaster.OnConsoleLinesParsed(*worldState, batch.GetLines());
+		batch.Clear();
+	};
+
+	for (const ParsedLine& line : lines)
 	{
-		for (auto listener : m_ConsoleLineListeners)
-			listener->OnConsoleLineUnparsed(*worldState, std::move(line));
+		if (line.m_Parsed)
+		{
+			batch.Add(*line.m_Parsed);
+		}
+		else
+		{
+			FlushParsedLines();
+			m_ConsoleLineListenerBroadcaster.OnConsoleLineUnparsed(*worldState, line.m_Text);
+		}
 	}
+
+	FlushParsedLines();
+	m_SnapshotDirty = true;
 }
 
 void WorldState::UpdateTimestamp(const ConsoleLogParser& parser)
@@ -389,45 +612,33 @@ void WorldState::RemoveWorldEventListener(IWorldEventListener* listener)
 
 std::optional<SteamID> WorldState::FindSteamIDForName(const std::string_view& playerName) const
 {
-	std::optional<SteamID> retVal;
-	time_point_t lastUpdated{};
-
-	for (const auto& data : m_CurrentPlayerData)
-	{
-		if (data.second->GetStatus().m_Name == playerName && data.second->GetLastStatusUpdateTime() > lastUpdated)
-		{
-			retVal = data.second->GetSteamID();
-			lastUpdated = data.second->GetLastStatusUpdateTime();
-		}
-	}
+	return m_PlayerNames.Find(playerName);
+}
 
-	return retVal;
+const LobbyMember* WorldState::FindLobbyMember(const SteamID& id) const
+{
+	auto found = m_LobbyMemberSlots.find(id);
+	if (found == m_LobbyMemberSlots.end())
+		return nullptr;
+
+	const auto& vec = found->second.m_Pending ? m_PendingLobbyMembers : m_CurrentLobbyMembers;
+	assert(found->second.m_Index < vec.size());
+	assert(vec[found->second.m_Index].m_SteamID == id);
+	return &vec[found->second.m_Index];
 }
 
 std::optional<LobbyMemberTeam> WorldState::FindLobbyMemberTeam(const SteamID& id) const
 {
-	for (const auto& member : m_CurrentLobbyMembers)
-	{
-		if (member.m_SteamID == id)
-			return member.m_Team;
-	}
-
-	for (const auto& member : m_PendingLobbyMembers)
-	{
-		if (member.m_SteamID == id)
-			return member.m_Team;
-	}
+	if (auto member = FindLobbyMember(id))
+		return member->m_Team;
 
 	return std::nullopt;
 }
 
 std::optional<UserID_t> WorldState::FindUserID(const SteamID& id) const
 {
-	for (const auto& player : m_CurrentPlayerData)
-	{
-		if (player.second->GetSteamID() == id)
-			return player.second->GetUserID();
-	}
+	if (auto found = m_CurrentPlayerData.find(id); found != m_CurrentPlayerData.end())
+		return found->second->GetUserID();
 
 	return std::nullopt;
 }
@@ -443,8 +654,8 @@ auto WorldState::GetTeamShareResult(const std::optional<LobbyMemberTeam>& team0,
 	return GetTeamShareResult(team0, FindLobbyMemberTeam(id1));
 }
 
-auto WorldState::GetTeamShareResult(const std::optional<LobbyMemberTeam>& team0,
-	const std::optional<LobbyMemberTeam>& team1) -> TeamShareResult
+TeamShareResult IWorldState::GetTeamShareResult(const std::optional<LobbyMemberTeam>& team0,
+	const std::optional<LobbyMemberTeam>& team1)
 {
 	if (!team0)
 		return TeamShareResult::Neither;
@@ -504,8 +715,8 @@ mh::generator<const IPlayer&> WorldState::GetLobbyMembers() const
 		if (!member.IsValid())
 			continue;
 
-		if (std::any_of(m_CurrentLobbyMembers.begin(), m_CurrentLobbyMembers.end(),
-			[&](const LobbyMember& member2) { return member.m_SteamID == member2.m_SteamID; }))
+		if (auto slot = m_LobbyMemberSlots.find(member.m_SteamID);
+			slot != m_LobbyMemberSlots.end() && !slot->second.m_Pending)
 		{
 			// Don't return two different instances with the same steamid.
 			continue;
@@ -532,35 +743,150 @@ void WorldState::QueuePlayerBansUpdate(const SteamID& id)
 	return m_PlayerBansUpdates.Queue(id);
 }
 
-template<typename TMap>
-static auto GetRecentPlayersImpl(TMap&& map, size_t recentPlayerCount)
+void WorldState::UpdatePlayerName(const SteamID& id, const std::string_view& oldName, const std::string_view& newName,
+	time_point_t timestamp)
+{
+	m_PlayerNames.Update(id, oldName, newName, timestamp);
+}
+
+void WorldState::ClearPlayerData()
 {
-	using value_type = std::conditional_t<std::is_const_v<std::remove_reference_t<TMap>>, const IPlayer*, IPlayer*>;
-	std::vector<value_type> retVal;
+	// Not evictions, just a new lobby. Only keep what cost us web requests.
+	for (const auto& [id, player] : m_CurrentPlayerData)
+	{
+		if (auto cold = player->GetColdData(); cold.HasData())
+			m_ColdPlayerData.insert_or_assign(id, std::move(cold));
 
-	for (auto& [sid, player] : map)
-		retVal.push_back(player.get());
+		m_PlayerSummaryUpdates.Dequeue(id);
+		m_PlayerBansUpdates.Dequeue(id);
+	}
 
-	std::sort(retVal.begin(), retVal.end(),
-		[](const IPlayer* a, const IPlayer* b)
-		{
-			return b->GetLastStatusUpdateTime() < a->GetLastStatusUpdateTime();
-		});
+	m_MarkedPlayers.clear();
+	m_CurrentPlayerData.clear();
+	m_PlayerNames.Clear();
+	m_PlayerTable.Clear();
+
+	TrimColdPlayerData();
+}
+
+void WorldState::EvictPlayers()
+{
+	const size_t maxPlayers = GetSettings().m_MaxCachedPlayers;
+	if (m_CurrentPlayerData.size() <= maxPlayers)
+		return;
+
+	// Anyone on the scoreboard has had a status update in the last few seconds
+	const auto localSteamID = GetSettings().GetLocalSteamID();
+	const auto evictBefore = m_LastStatusUpdateTime - PLAYER_EVICTION_DELAY;
+	const auto& table = m_PlayerTable;
+	const size_t maxEvictCount = m_CurrentPlayerData.size() - maxPlayers;
+
+	// Evicting reorders the table, so we work off of copies of the ids
+	std::vector<SteamID> evictIDs;
+	for (auto row = table.m_OldestRow; row != PlayerTable::NO_ROW && evictIDs.size() < maxEvictCount; row = table.m_NewerRows[row])
+	{
+		if (table.m_LastStatusUpdateTimes[row] > evictBefore)
+			break;
+
+		if (table.m_LobbyTeams[row] || table.m_SteamIDs[row] == localSteamID)
+			continue;
+
+		evictIDs.push_back(table.m_SteamIDs[row]);
+	}
+
+	if (evictIDs.empty())
+		return;
+
+	const size_t evictCount = evictIDs.size();
+	for (const SteamID& id : evictIDs)
+		EvictPlayer(*m_CurrentPlayerData.at(id));
+
+	DebugLog("Evicted {} players, {} remaining", evictCount, m_CurrentPlayerData.size());
+	TrimColdPlayerData();
+}
+
+void WorldState::EvictPlayer(const Player& player)
+{
+	const SteamID id = player.GetSteamID();
+	if (auto cold = player.GetColdData(); cold.HasData())
+		m_ColdPlayerData.insert_or_assign(id, std::move(cold));
 
-	if (retVal.size() > recentPlayerCount)
-		retVal.resize(recentPlayerCount);
+	m_PlayerNames.Remove(id, player.GetStatus().m_Name);
+	m_PlayerSummaryUpdates.Dequeue(id);
+	m_PlayerBansUpdates.Dequeue(id);
+	m_MarkedPlayers.erase(id); // Marked again on their next status update if they come back
+	m_EvictionCount++;
+
+	const auto row = player.m_TableRow;
+	if (auto moved = static_cast<Player*>(m_PlayerTable.RemoveRow(row)))
+		moved->m_TableRow = row;
+
+	m_CurrentPlayerData.erase(id); // Destroys player
+}
+
+void WorldState::TrimColdPlayerData()
+{
+	if (m_ColdPlayerData.size() <= MAX_COLD_PLAYERS)
+		return;
+
+	// Trim down to 7/8 of the limit, so we aren't doing this for every eviction
+	std::vector<std::pair<time_point_t, SteamID>> byAge;
+	byAge.reserve(m_ColdPlayerData.size());
+	for (const auto& [id, data] : m_ColdPlayerData)
+		byAge.emplace_back(data.m_LastStatusUpdateTime, id);
+
+	const size_t removeCount = m_ColdPlayerData.size() - (MAX_COLD_PLAYERS - MAX_COLD_PLAYERS / 8);
+	std::nth_element(byAge.begin(), byAge.begin() + (removeCount - 1), byAge.end());
+
+	for (size_t i = 0; i < removeCount; i++)
+		m_ColdPlayerData.erase(byAge[i].second);
+}
+
+ColdPlayerData* WorldState::FindColdPlayerData(const SteamID& id)
+{
+	if (auto found = m_ColdPlayerData.find(id); found != m_ColdPlayerData.end())
+		return &found->second;
+
+	return nullptr;
+}
+
+PlayerStoreStats WorldState::GetPlayerStoreStats() const
+{
+	PlayerStoreStats stats;
+	stats.m_PlayerCount = m_CurrentPlayerData.size();
+	stats.m_MaxPlayerCount = GetSettings().m_MaxCachedPlayers;
+	stats.m_ColdPlayerCount = m_ColdPlayerData.size();
+	stats.m_EvictionCount = m_EvictionCount;
+	stats.m_ColdRestoreCount = m_ColdRestoreCount;
+
+	for (const auto& [id, player] : m_CurrentPlayerData)
+		stats.m_PlayerBytes += player->GetApproxMemoryUsage();
+	for (const auto& [id, data] : m_ColdPlayerData)
+		stats.m_ColdPlayerBytes += data.GetApproxMemoryUsage();
+
+	return stats;
+}
+
+template<typename TPlayer>
+static std::vector<TPlayer*> GetRecentPlayersImpl(const PlayerTable& table, size_t recentPlayerCount)
+{
+	std::vector<TPlayer*> retVal;
+	retVal.reserve(std::min(recentPlayerCount, table.size()));
+
+	for (auto row = table.m_NewestRow; row != PlayerTable::NO_ROW && retVal.size() < recentPlayerCount; row = table.m_OlderRows[row])
+		retVal.push_back(table.m_Players[row]);
 
 	return retVal;
 }
 
 std::vector<const IPlayer*> WorldState::GetRecentPlayers(size_t recentPlayerCount) const
 {
-	return GetRecentPlayersImpl(m_CurrentPlayerData, recentPlayerCount);
+	return GetRecentPlayersImpl<const IPlayer>(m_PlayerTable, recentPlayerCount);
 }
 
 std::vector<IPlayer*> WorldState::GetRecentPlayers(size_t recentPlayerCount)
 {
-	return GetRecentPlayersImpl(m_CurrentPlayerData, recentPlayerCount);
+	return GetRecentPlayersImpl<IPlayer>(m_PlayerTable, recentPlayerCount);
 }
 
 void WorldState::OnConfigExecLineParsed(const ConfigExecLine& execLine)
@@ -608,15 +934,66 @@ void WorldState::OnConfigExecLineParsed(const ConfigExecLine& execLine)
 	}
 }
 
-void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
+void WorldState::OnConsoleLinesParsed(IWorldState& world, const ConsoleLineSpan& lines)
+{
+	assert(&world == this);
+
+	for (IConsoleLine& line : lines)
+		OnConsoleLineParsed(line);
+}
+
+void WorldState::OnConsoleLogChunkParsed(IWorldState& world, bool consoleLinesParsed)
 {
 	assert(&world == this);
+	m_SnapshotDirty = true;
+}
+
+std::shared_ptr<const WorldStateSnapshot> WorldState::GetSnapshot() const
+{
+	return m_Snapshot.load();
+}
+
+void WorldState::PublishSnapshot()
+{
+	if (!m_SnapshotDirty)
+		return;
+
+	m_SnapshotDirty = false;
+
+	// Always a new one, readers may still be looking at the old one on another thread
+	auto snapshot = std::make_shared<WorldStateSnapshot>();
+	snapshot->m_Version = ++m_SnapshotVersion;
+	snapshot->m_CurrentTime = GetCurrentTime();
+	snapshot->m_LastStatusUpdateTime = m_LastStatusUpdateTime;
+	snapshot->m_IsLocalPlayerInitialized = m_IsLocalPlayerInitialized;
+	snapshot->m_CurrentLobbyMembers = m_CurrentLobbyMembers;
+	snapshot->m_PendingLobbyMembers = m_PendingLobbyMembers;
+
+	auto& players = snapshot->m_Players;
+	players.reserve(m_CurrentPlayerData.size());
+	for (const auto& [id, player] : m_CurrentPlayerData)
+	{
+		PlayerSnapshot& playerSnapshot = players.emplace_back();
+		playerSnapshot.m_Status = player->GetStatus();
+		playerSnapshot.m_Scores = player->m_Scores;
+		playerSnapshot.m_Team = player->m_Team;
+		playerSnapshot.m_LobbyTeam = FindLobbyMemberTeam(id);
+		playerSnapshot.m_LastStatusUpdateTime = player->GetLastStatusUpdateTime();
+		playerSnapshot.m_IsFriend = m_Friends.contains(id);
+	}
+
+	std::sort(players.begin(), players.end(),
+		[](const PlayerSnapshot& lhs, const PlayerSnapshot& rhs) { return lhs.GetSteamID() < rhs.GetSteamID(); });
+
+	m_Snapshot = std::move(snapshot);
+}
 
+void WorldState::OnConsoleLineParsed(IConsoleLine& parsed)
+{
 	const auto ClearLobbyState = [&]
 	{
-		m_CurrentLobbyMembers.clear();
-		m_PendingLobbyMembers.clear();
-		m_CurrentPlayerData.clear();
+		ClearLobbyMembers();
+		ClearPlayerData();
 	};
 
 	switch (parsed.GetType())
@@ -626,15 +1003,15 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 		auto& headerLine = static_cast<const LobbyHeaderLine&>(parsed);
 		m_CurrentLobbyMembers.resize(headerLine.GetMemberCount());
 		m_PendingLobbyMembers.resize(headerLine.GetPendingCount());
+		RebuildLobbyMemberSlots();
 		break;
 	}
 	case ConsoleLineType::LobbyStatusFailed:
 	{
 		if (!m_CurrentLobbyMembers.empty() || !m_PendingLobbyMembers.empty())
 		{
-			m_CurrentLobbyMembers.clear();
-			m_PendingLobbyMembers.clear();
-			m_CurrentPlayerData.clear();
+			ClearLobbyMembers();
+			ClearPlayerData();
 		}
 		break;
 	}
@@ -750,10 +1127,15 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 		const auto& member = memberLine.GetLobbyMember();
 		auto& vec = member.m_Pending ? m_PendingLobbyMembers : m_CurrentLobbyMembers;
 		if (member.m_Index < vec.size())
+		{
 			vec[member.m_Index] = member;
+			RebuildLobbyMemberSlots();
+		}
 
 		const TFTeam tfTeam = member.m_Team == LobbyMemberTeam::Defenders ? TFTeam::Red : TFTeam::Blue;
-		FindOrCreatePlayer(member.m_SteamID).m_Team = tfTeam;
+		auto& player = FindOrCreatePlayer(member.m_SteamID);
+		player.m_Team = tfTeam;
+		SyncPlayerTableRow(player);
 
 		break;
 	}
@@ -764,6 +1146,7 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 		{
 			auto& playerData = FindOrCreatePlayer(*found);
 			playerData.SetPing(pingLine.GetPing(), pingLine.GetTimestamp());
+			SyncPlayerTableRow(playerData);
 		}
 
 		break;
@@ -783,6 +1166,7 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 
 		assert(playerData.GetStatus().m_SteamID == newStatus.m_SteamID);
 		playerData.SetStatus(newStatus, statusLine.GetTimestamp());
+		SyncPlayerTableRow(playerData);
 		m_LastStatusUpdateTime = std::max(m_LastStatusUpdateTime, playerData.GetLastStatusUpdateTime());
 		InvokeEventListener(&IWorldEventListener::OnPlayerStatusUpdate, *this, playerData);
 
@@ -791,9 +1175,8 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 	case ConsoleLineType::PlayerStatusShort:
 	{
 		auto& statusLine = static_cast<const ServerStatusShortPlayerLine&>(parsed);
-		const auto& status = statusLine.GetPlayerStatus();
-		if (auto steamID = FindSteamIDForName(status.m_Name))
-			FindOrCreatePlayer(*steamID).m_ClientIndex = status.m_ClientIndex;
+		if (auto steamID = FindSteamIDForName(statusLine.GetPlayerName()))
+			FindOrCreatePlayer(*steamID).m_ClientIndex = statusLine.GetClientIndex();
 
 		break;
 	}
@@ -811,6 +1194,8 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 
 			if (victimSteamID == localSteamID)
 				attacker.m_Scores.m_LocalKills++;
+
+			SyncPlayerTableRow(attacker);
 		}
 
 		if (victimSteamID)
@@ -820,6 +1205,8 @@ void WorldState::OnConsoleLineParsed(IWorldState& world, IConsoleLine& parsed)
 
 			if (attackerSteamID == localSteamID)
 				victim.m_Scores.m_LocalDeaths++;
+
+			SyncPlayerTableRow(victim);
 		}
 
 		break;
@@ -893,21 +1280,203 @@ Player& WorldState::FindOrCreatePlayer(const SteamID& id)
 	else
 	{
 		data = m_CurrentPlayerData.emplace(id, std::make_shared<Player>(*this, id)).first->second.get();
+		data->m_TableRow = m_PlayerTable.AddRow(id, data);
+		m_PlayerTable.m_LobbyTeams[data->m_TableRow] = FindLobbyMemberTeam(id);
 
-		if (!GetSettings().m_LazyLoadAPIData)
+		if (auto cold = m_ColdPlayerData.find(id); cold != m_ColdPlayerData.end())
 		{
-			data->GetPlayerSummary();
-			data->GetPlayerBans();
-			data->GetTF2Playtime();
-			data->GetLogsInfo();
+			data->RestoreColdData(std::move(cold->second));
+			m_ColdPlayerData.erase(cold);
+			m_ColdRestoreCount++;
 		}
 	}
 
-
 	assert(data->GetSteamID() == id);
 	return *data;
 }
 
+void WorldState::RebuildLobbyMemberSlots()
+{
+	m_LobbyMemberSlots.clear();
+
+	const auto AddSlots = [&](const std::vector<LobbyMember>& members, bool pending)
+	{
+		for (size_t i = 0; i < members.size(); i++)
+		{
+			if (members[i].IsValid())
+				m_LobbyMemberSlots.try_emplace(members[i].m_SteamID, LobbyMemberSlot{ unsigned(i), pending });
+		}
+	};
+
+	// Current members first, so they win over the same player in the pending list
+	AddSlots(m_CurrentLobbyMembers, false);
+	AddSlots(m_PendingLobbyMembers, true);
+
+	SyncPlayerTableLobbyTeams();
+}
+
+void WorldState::ClearLobbyMembers()
+{
+	m_CurrentLobbyMembers.clear();
+	m_PendingLobbyMembers.clear();
+	m_LobbyMemberSlots.clear();
+
+	SyncPlayerTableLobbyTeams();
+}
+
+void WorldState::SetVisiblePlayers(const std::span<const SteamID>& ids)
+{
+	// Called every frame, but the scoreboard rarely changes
+	if (std::equal(ids.begin(), ids.end(), m_VisiblePlayerIDs.begin(), m_VisiblePlayerIDs.end()))
+		return;
+
+	m_VisiblePlayerIDs.assign(ids.begin(), ids.end());
+	m_VisiblePlayers.clear();
+	m_VisiblePlayers.insert(ids.begin(), ids.end());
+}
+
+void WorldState::SetPlayerMarked(const SteamID& id, bool marked)
+{
+	if (marked)
+		m_MarkedPlayers.insert(id);
+	else
+		m_MarkedPlayers.erase(id);
+}
+
+void WorldState::UpdatePlayerDataPrefetch()
+{
+	if (!GetSettings().GetHTTPClient())
+		return;
+
+	const auto now = m_WallClock();
+	if ((now - m_LastPrefetchUpdate) < PREFETCH_INTERVAL)
+		return;
+
+	m_LastPrefetchUpdate = now;
+
+	// Higher goes first
+	enum Priority : uint8_t
+	{
+		PRIORITY_RECENT,
+		PRIORITY_LOBBY,
+		PRIORITY_VISIBLE,
+		PRIORITY_MARKED,
+	};
+
+	// With lazy loading, only summaries and bans (which are batched) are fetched ahead of
+	// time, and only for players on the scoreboard. Everything else waits until the UI asks
+	// for it, unless the player is marked.
+	const bool lazyLoad = GetSettings().m_LazyLoadAPIData;
+	const auto recentStatusTime = m_LastStatusUpdateTime - 15s;
+
+	PerHostRequests inFlight;
+	m_PrefetchCandidates.clear();
+	for (size_t i = 0; i < m_PlayerTable.size(); i++)
+	{
+		auto& player = static_cast<Player&>(*m_PlayerTable.m_Players[i]);
+		const auto playerInFlight = player.GetPerPlayerFetchesInProgress();
+		inFlight.m_SteamAPI += playerInFlight.m_SteamAPI;
+		inFlight.m_LogsTF += playerInFlight.m_LogsTF;
+
+		const bool inLobby = m_PlayerTable.m_LobbyTeams[i];
+		if (!inLobby && m_PlayerTable.m_LastStatusUpdateTimes[i] < recentStatusTime)
+		{
+			// Not on the server anymore. Eviction would drop these too, but only once there
+			// are more than m_MaxCachedPlayers players, which a normal server never reaches.
+			CancelQueuedFetches(player);
+			continue;
+		}
+
+		const SteamID id = m_PlayerTable.m_SteamIDs[i];
+		Priority priority;
+		if (m_MarkedPlayers.contains(id))
+			priority = PRIORITY_MARKED;
+		else if (m_VisiblePlayers.contains(id))
+			priority = PRIORITY_VISIBLE;
+		else if (lazyLoad)
+			continue;
+		else if (inLobby)
+			priority = PRIORITY_LOBBY;
+		else
+			priority = PRIORITY_RECENT;
+
+		m_PrefetchCandidates.emplace_back(priority, &player);
+	}
+
+	std::stable_sort(m_PrefetchCandidates.begin(), m_PrefetchCandidates.end(),
+		[](const auto& a, const auto& b) { return a.first > b.first; });
+
+	for (const auto& [priority, player] : m_PrefetchCandidates)
+		player->PrefetchBatched();
+
+	PerHostRequests budget = GetPrefetchBudget(inFlight);
+	for (const auto& [priority, player] : m_PrefetchCandidates)
+	{
+		if (lazyLoad && priority < PRIORITY_MARKED)
+			break;
+
+		player->PrefetchPerPlayer(budget);
+	}
+}
+
+void WorldState::CancelQueuedFetches(const Player& player)
+{
+	// Reset so that they're fetched again if they come back
+	const SteamID id = player.GetSteamID();
+	if (m_PlayerSummaryUpdates.IsQueued(id))
+	{
+		m_PlayerSummaryUpdates.Dequeue(id);
+		player.m_PlayerSummary = ErrorCode::LazyValueUninitialized;
+	}
+	if (m_PlayerBansUpdates.IsQueued(id))
+	{
+		m_PlayerBansUpdates.Dequeue(id);
+		player.m_PlayerSteamBans = ErrorCode::LazyValueUninitialized;
+	}
+}
+
+PerHostRequests WorldState::GetPrefetchBudget(const PerHostRequests& inFlight) const
+{
+	// Anything already in flight is either running or waiting on the throttle
+	const auto GetBudget = [](const std::string_view& host, size_t used)
+	{
+		const size_t slots = size_t(PREFETCH_INTERVAL / GetMinRequestInterval(host));
+		return slots - std::min(slots, used);
+	};
+
+	// Summaries and bans share the Steam API host. Each queue sends at most one request of up
+	// to 100 players at a time, so a non-empty queue costs one slot no matter how big it is.
+	const size_t batchedRequests =
+		(m_PlayerSummaryUpdates.GetQueuedCount() > 0 ? 1 : 0) +
+		(m_PlayerBansUpdates.GetQueuedCount() > 0 ? 1 : 0);
+
+	PerHostRequests budget;
+	budget.m_SteamAPI = GetBudget("api.steampowered.com", inFlight.m_SteamAPI + batchedRequests);
+	budget.m_LogsTF = GetBudget("logs.tf", inFlight.m_LogsTF);
+	return budget;
+}
+
+void WorldState::SyncPlayerTableRow(const Player& player)
+{
+	const auto row = player.m_TableRow;
+	assert(m_PlayerTable.m_Players[row] == &player);
+
+	const auto& status = player.GetStatus();
+	m_PlayerTable.m_Teams[row] = player.m_Team;
+	m_PlayerTable.m_UserIDs[row] = status.m_UserID;
+	m_PlayerTable.m_Kills[row] = player.m_Scores.m_Kills;
+	m_PlayerTable.m_Deaths[row] = player.m_Scores.m_Deaths;
+	m_PlayerTable.m_Pings[row] = status.m_Ping;
+	m_PlayerTable.m_States[row] = status.m_State;
+	m_PlayerTable.SetLastStatusUpdateTime(row, player.GetLastStatusUpdateTime());
+}
+
+void WorldState::SyncPlayerTableLobbyTeams()
+{
+	for (size_t i = 0; i < m_PlayerTable.size(); i++)
+		m_PlayerTable.m_LobbyTeams[i] = FindLobbyMemberTeam(m_PlayerTable.m_SteamIDs[i]);
+}
+
 auto WorldState::GetTeamShareResult(const SteamID& id0, const SteamID& id1) const -> TeamShareResult
 {
 	return GetTeamShareResult(FindLobbyMemberTeam(id0), FindLobbyMemberTeam(id1));
@@ -927,19 +1496,7 @@ const WorldState& Player::GetWorld() const
 
 const LobbyMember* Player::GetLobbyMember() const
 {
-	const auto steamID = GetSteamID();
-	for (const auto& member : m_World->GetCurrentLobbyMembers())
-	{
-		if (member.m_SteamID == steamID)
-			return &member;
-	}
-	for (const auto& member : m_World->GetPendingLobbyMembers())
-	{
-		if (member.m_SteamID == steamID)
-			return &member;
-	}
-
-	return nullptr;
+	return m_World->FindLobbyMember(GetSteamID());
 }
 
 std::optional<UserID_t> Player::GetUserID() const
@@ -1061,6 +1618,45 @@ mh::expected<duration_t> Player::GetTF2Playtime() const
 		}, { ErrorCode::InfoPrivate, ErrorCode::GameNotOwned });
 }
 
+void Player::PrefetchBatched() const
+{
+	GetPlayerSummary();
+	GetPlayerBans();
+}
+
+void Player::PrefetchPerPlayer(PerHostRequests& budget) const
+{
+	const auto NeedsFetch = [](const auto& var)
+	{
+		return !var && (var.error() == ErrorCode::LazyValueUninitialized ||
+			var.error() == ErrorCode::InternetConnectivityDisabled);
+	};
+
+	if (budget.m_SteamAPI > 0 && NeedsFetch(m_TF2Playtime))
+	{
+		GetTF2Playtime();
+		budget.m_SteamAPI--;
+	}
+	if (budget.m_LogsTF > 0 && NeedsFetch(m_LogsInfo))
+	{
+		GetLogsInfo();
+		budget.m_LogsTF--;
+	}
+}
+
+PerHostRequests Player::GetPerPlayerFetchesInProgress() const
+{
+	const auto IsInProgress = [](const auto& var) -> size_t
+	{
+		return !var && var.error() == std::errc::operation_in_progress;
+	};
+
+	PerHostRequests inProgress;
+	inProgress.m_SteamAPI = IsInProgress(m_TF2Playtime);
+	inProgress.m_LogsTF = IsInProgress(m_LogsInfo);
+	return inProgress;
+}
+
 bool Player::IsFriend() const
 {
 	return m_World->GetFriends().contains(GetSteamID());
@@ -1090,6 +1686,8 @@ void Player::SetStatus(PlayerStatus status, time_point_t timestamp)
 	if (m_Status.m_State != PlayerStatusState::Active && status.m_State == PlayerStatusState::Active)
 		m_LastStatusActiveBegin = timestamp;
 
+	m_World->UpdatePlayerName(GetSteamID(), m_Status.m_Name, status.m_Name, timestamp);
+
 	m_Status = std::move(status);
 	m_LastStatusUpdateTime = m_LastPingUpdateTime = timestamp;
 }
@@ -1099,17 +1697,75 @@ void Player::SetPing(uint16_t ping, time_point_t timestamp)
 	m_LastPingUpdateTime = timestamp;
 }
 
-const std::any* Player::FindDataStorage(const std::type_index& type) const
+template<typename T>
+static mh::expected<T> GetSettledValue(const mh::expected<T>& value)
 {
-	if (auto found = m_UserData.find(type); found != m_UserData.end())
-		return &found->second;
+	// Requests that never finished just get made again if the player comes back
+	if (!value && (value.error() == ErrorCode::LazyValueUninitialized ||
+		value.error() == ErrorCode::InternetConnectivityDisabled ||
+		value.error() == std::errc::operation_in_progress))
+	{
+		return ErrorCode::LazyValueUninitialized;
+	}
 
-	return nullptr;
+	return value;
+}
+
+ColdPlayerData Player::GetColdData() const
+{
+	ColdPlayerData data;
+	data.m_PlayerSummary = GetSettledValue(m_PlayerSummary);
+	data.m_PlayerSteamBans = GetSettledValue(m_PlayerSteamBans);
+	data.m_TF2Playtime = GetSettledValue(m_TF2Playtime);
+	data.m_LogsInfo = GetSettledValue(m_LogsInfo);
+	data.m_LastStatusUpdateTime = GetLastStatusUpdateTime();
+	return data;
+}
+
+void Player::RestoreColdData(ColdPlayerData&& data)
+{
+	m_PlayerSummary = std::move(data.m_PlayerSummary);
+	m_PlayerSteamBans = std::move(data.m_PlayerSteamBans);
+	m_TF2Playtime = std::move(data.m_TF2Playtime);
+	m_LogsInfo = std::move(data.m_LogsInfo);
+}
+
+static size_t GetHeapUsage(const std::string& str)
+{
+	// Short strings live inside the std::string itself
+	return str.capacity() > std::string().capacity() ? (str.capacity() + 1) : 0;
+}
+
+static size_t GetHeapUsage(const mh::expected<SteamAPI::PlayerSummary>& summary)
+{
+	if (!summary)
+		return 0;
+
+	return GetHeapUsage(summary->m_RealName) + GetHeapUsage(summary->m_Nickname) +
+		GetHeapUsage(summary->m_AvatarHash) + GetHeapUsage(summary->m_ProfileURL);
+}
+
+size_t Player::GetApproxMemoryUsage() const
+{
+	// Player and its shared_ptr control block are allocated together, then there's the map node pointing to it
+	size_t bytes = sizeof(*this) + sizeof(std::shared_ptr<Player>) * 2 +
+		sizeof(std::pair<const SteamID, std::shared_ptr<Player>>) + sizeof(void*) * 2;
+
+	bytes += GetHeapUsage(m_Status.m_Name) + GetHeapUsage(m_Status.m_Address);
+	bytes += GetHeapUsage(m_PlayerSummary);
+	bytes += m_UserData.GetApproxMemoryUsage();
+	return bytes;
 }
 
-std::any& Player::GetOrCreateDataStorage(const std::type_index& type)
+bool ColdPlayerData::HasData() const
 {
-	return m_UserData[type];
+	const auto IsSet = [](const auto& value) { return value || value.error() != ErrorCode::LazyValueUninitialized; };
+	return IsSet(m_PlayerSummary) || IsSet(m_PlayerSteamBans) || IsSet(m_TF2Playtime) || IsSet(m_LogsInfo);
+}
+
+size_t ColdPlayerData::GetApproxMemoryUsage() const
+{
+	return sizeof(*this) + sizeof(SteamID) + sizeof(void*) * 2 + GetHeapUsage(m_PlayerSummary);
 }
 
 template<typename T>
@@ -1155,8 +1811,11 @@ void WorldState::PlayerSummaryUpdateAction::OnDataReady(WorldState*& state,
 	DebugLog("[SteamAPI] Received {} player summaries", response.size());
 	for (const SteamAPI::PlayerSummary& entry : response)
 	{
-		auto& player = state->FindOrCreatePlayer(entry.m_SteamID);
-		player.m_PlayerSummary = entry;
+		// Players may have been evicted while we were waiting
+		if (auto player = state->FindPlayer(entry.m_SteamID))
+			static_cast<Player*>(player)->m_PlayerSummary = entry;
+		else if (auto cold = state->FindColdPlayerData(entry.m_SteamID))
+			cold->m_PlayerSummary = entry;
 
 		collection.erase(entry.m_SteamID);
 
@@ -1193,7 +1852,11 @@ void WorldState::PlayerBansUpdateAction::OnDataReady(state_type& state,
 	DebugLog("[SteamAPI] Received {} player bans", response.size());
 	for (const SteamAPI::PlayerBans& bans : response)
 	{
-		state->FindOrCreatePlayer(bans.m_SteamID).m_PlayerSteamBans = bans;
+		if (auto player = state->FindPlayer(bans.m_SteamID))
+			static_cast<Player*>(player)->m_PlayerSteamBans = bans;
+		else if (auto cold = state->FindColdPlayerData(bans.m_SteamID))
+			cold->m_PlayerSteamBans = bans;
+
 		collection.erase(bans.m_SteamID);
 	}
 }
@@ -7,12 +7,15 @@
 #include <mh/coroutine/task.hpp>
 #include <mh/coroutine/generator.hpp>
 
+#include <functional>
 #include <optional>
+#include <span>
 
 namespace tf2_bot_detector
 {
 	class ChatConsoleLine;
 	class ConfigExecLine;
+	class ConsoleLineTypeMask;
 	class ConsoleLogParser;
 	class IConsoleLineListener;
 	class IPlayer;
@@ -20,6 +23,8 @@ namespace tf2_bot_detector
 	enum class LobbyMemberTeam : uint8_t;
 	class Settings;
 	enum class TFClassType;
+	struct PlayerTable;
+	struct WorldStateSnapshot;
 
 	enum class TeamShareResult
 	{
@@ -30,6 +35,30 @@ namespace tf2_bot_detector
 
 	class IWorldState;
 
+	// Rough memory usage of the players WorldState is keeping track of
+	struct PlayerStoreStats
+	{
+		size_t m_PlayerCount = 0;        // Players with full state
+		size_t m_PlayerBytes = 0;
+		size_t m_MaxPlayerCount = 0;     // Players beyond this count are evicted once they're gone
+		size_t m_ColdPlayerCount = 0;    // Evicted players, with only their API results kept
+		size_t m_ColdPlayerBytes = 0;
+		size_t m_EvictionCount = 0;
+		size_t m_ColdRestoreCount = 0;   // Evicted players that came back
+	};
+
+	// How long game command (RCON) output takes to get from AddConsoleOutputChunk() to
+	// console line listeners
+	struct ConsoleOutputStats
+	{
+		size_t m_ChunkCount = 0;
+		size_t m_LineCount = 0;
+		std::chrono::nanoseconds m_TotalParseTime{}; // Time spent on the parsing thread
+		std::chrono::nanoseconds m_TotalLatency{};
+		std::chrono::nanoseconds m_MaxLatency{};
+		std::chrono::nanoseconds m_LastLatency{};
+	};
+
 	class IWorldStateConLog
 	{
 	public:
@@ -40,6 +69,9 @@ namespace tf2_bot_detector
 
 		virtual IConsoleLineListener& GetConsoleLineListenerBroadcaster() = 0;
 
+		// Every type at least one console line listener is registered for. Nothing else needs parsing.
+		virtual ConsoleLineTypeMask GetConsoleLineInterests() const = 0;
+
 		virtual void UpdateTimestamp(const ConsoleLogParser& parser) = 0;
 	};
 
@@ -48,7 +80,10 @@ namespace tf2_bot_detector
 	public:
 		virtual ~IWorldState() = default;
 
-		static std::shared_ptr<IWorldState> Create(const Settings& settings);
+		// World time comes from the console log. The wall clock paces web requests (Steam API,
+		// logs.tf), so journal replays pass the time each record was written instead.
+		using WallClockFunc = std::function<time_point_t()>;
+		static std::shared_ptr<IWorldState> Create(const Settings& settings, WallClockFunc wallClock = &tfbd_clock_t::now);
 
 		virtual void Update() = 0;
 
@@ -57,7 +92,7 @@ namespace tf2_bot_detector
 
 		virtual void AddWorldEventListener(IWorldEventListener* listener) = 0;
 		virtual void RemoveWorldEventListener(IWorldEventListener* listener) = 0;
-		virtual void AddConsoleLineListener(IConsoleLineListener* listener) = 0;
+		virtual void AddConsoleLineListener(IConsoleLineListener* listener, const ConsoleLineTypeMask& interests) = 0;
 		virtual void RemoveConsoleLineListener(IConsoleLineListener* listener) = 0;
 
 		virtual void AddConsoleOutputChunk(const std::string_view& chunk) = 0;
@@ -82,6 +117,23 @@ namespace tf2_bot_detector
 		virtual mh::generator<const IPlayer&> GetPlayers() const = 0;
 		mh::generator<IPlayer&> GetPlayers();
 
+		// The same players as GetPlayers(), laid out for scanning
+		virtual const PlayerTable& GetPlayerTable() const = 0;
+
+		// Hints for deciding whose Steam API/logs.tf data to fetch first. Visible players are
+		// the ones on the scoreboard right now, marked players are the ones we're most likely
+		// to take action against. Lobby members are taken into account automatically.
+		virtual void SetVisiblePlayers(const std::span<const SteamID>& ids) = 0;
+		virtual void SetPlayerMarked(const SteamID& id, bool marked) = 0;
+
+		virtual PlayerStoreStats GetPlayerStoreStats() const = 0;
+		virtual ConsoleOutputStats GetConsoleOutputStats() const = 0;
+
+		// The most recently published snapshot. Unlike everything else here, this is safe
+		// to call from any thread. Update() publishes a new one whenever something in it has
+		// changed, so it reflects everything processed before the last Update().
+		virtual std::shared_ptr<const WorldStateSnapshot> GetSnapshot() const = 0;
+
 		// Have we joined a team and picked a class?
 		virtual bool IsLocalPlayerInitialized() const = 0;
 		virtual bool IsVoteInProgress() const = 0;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Clock.h"
+#include "IPlayer.h"
+#include "LobbyMember.h"
+#include "PlayerStatus.h"
+#include "SteamID.h"
+#include "TFConstants.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace tf2_bot_detector
+{
+	// A player as of a WorldStateSnapshot
+	struct PlayerSnapshot
+	{
+		PlayerStatus m_Status;
+		PlayerScores m_Scores;
+		TFTeam m_Team{};
+		std::optional<LobbyMemberTeam> m_LobbyTeam;
+		time_point_t m_LastStatusUpdateTime{};
+		bool m_IsFriend = false;
+
+		SteamID GetSteamID() const { return m_Status.m_SteamID; }
+	};
+
+	// An immutable copy of the world state, published by IWorldState::Update() on the main
+	// thread whenever something in it has changed. Unlike IWorldState and IPlayer, it can be
+	// read from any thread, without going through the dispatcher.
+	struct WorldStateSnapshot
+	{
+		uint64_t m_Version = 0; // Goes up by one with every published snapshot
+
+		time_point_t m_CurrentTime{};
+		time_point_t m_LastStatusUpdateTime{};
+		bool m_IsLocalPlayerInitialized = false;
+
+		std::vector<PlayerSnapshot> m_Players; // Sorted by SteamID
+		std::vector<LobbyMember> m_CurrentLobbyMembers;
+		std::vector<LobbyMember> m_PendingLobbyMembers;
+
+		const PlayerSnapshot* FindPlayer(const SteamID& id) const
+		{
+			auto found = std::lower_bound(m_Players.begin(), m_Players.end(), id,
+				[](const PlayerSnapshot& player, const SteamID& id) { return player.GetSteamID() < id; });
+
+			if (found != m_Players.end() && found->GetSteamID() == id)
+				return &*found;
+
+			return nullptr;
+		}
+	};
+}